@@ -0,0 +1,244 @@
+#include "agenda_pausas.h"
+
+#include "config_arquivo.h"
+#include "log.h"
+
+// Início e fim de cada evento viram transições ordenadas por minuto
+struct Transicao {
+  uint16_t minutoDoDia;
+  uint8_t evento;
+  bool inicio;
+};
+
+// Status a partir de um minuto do dia, até o próximo degrau
+struct DegrauStatus {
+  uint16_t minutoDoDia;
+  TipoEventoAgenda status;
+};
+
+// Tabela ativa e cursor do dia ficam na RTC (sono profundo)
+static HAL_RETIDO EventoAgenda eventos[MAX_EVENTOS_AGENDA];
+static HAL_RETIDO int totalEventos = 0;
+static HAL_RETIDO Transicao transicoes[2 * MAX_EVENTOS_AGENDA];
+static HAL_RETIDO int totalTransicoes = 0;
+static HAL_RETIDO DegrauStatus degraus[2 * MAX_EVENTOS_AGENDA + 1];
+static HAL_RETIDO int totalDegraus = 0;
+static HAL_RETIDO const char* nomePerfil = "padrao";
+
+static HAL_RETIDO unsigned long diaAtual = 0;
+static HAL_RETIDO int cursor = 0;                     // Próxima transição do dia
+static HAL_RETIDO unsigned long proximoDisparo = 0;   // Minuto absoluto dela
+static HAL_RETIDO TipoEventoAgenda statusPausa = SEM_PAUSA;
+static HAL_RETIDO int pausasHoje = 0;
+
+// Tabela própria lida do arquivo (substitui o perfil)
+static EventoAgenda eventosArquivo[MAX_EVENTOS_AGENDA];
+static int totalEventosArquivo = 0;
+static const char* perfilArquivo = nullptr;
+
+static const char* const nomesTipos[TOTAL_TIPOS_EVENTO] = {
+  "", "cafe", "almoco", "tarde", "alongamento", "inicio", "fim"
+};
+
+bool agendaEhPausa(TipoEventoAgenda tipo) {
+  return tipo >= PAUSA_CAFE && tipo <= PAUSA_ALONGAMENTO;
+}
+
+static bool transicaoAntes(const Transicao& a, const Transicao& b) {
+  if (a.minutoDoDia != b.minutoDoDia) return a.minutoDoDia < b.minutoDoDia;
+  return !a.inicio && b.inicio;   // No mesmo minuto, fins antes de inícios
+}
+
+static void montarTransicoes() {
+  totalTransicoes = 0;
+  for (int i = 0; i < totalEventos; i++) {
+    transicoes[totalTransicoes++] = { eventos[i].minutoDoDia, (uint8_t)i, true };
+    if (eventos[i].duracaoMin > 0) {
+      uint16_t fim = (eventos[i].minutoDoDia + eventos[i].duracaoMin) % MINUTOS_POR_DIA;
+      transicoes[totalTransicoes++] = { fim, (uint8_t)i, false };
+    }
+  }
+
+  // Inserção: no máximo 32 itens, uma vez por carga
+  for (int i = 1; i < totalTransicoes; i++) {
+    Transicao t = transicoes[i];
+    int j = i - 1;
+    while (j >= 0 && transicaoAntes(t, transicoes[j])) {
+      transicoes[j + 1] = transicoes[j];
+      j--;
+    }
+    transicoes[j + 1] = t;
+  }
+}
+
+// O dia inteiro passado pelas mesmas regras do agendaProcessar(), sem o
+// atraso máximo: o dia começa sem pausa
+static void montarDegraus() {
+  TipoEventoAgenda status = SEM_PAUSA;
+  totalDegraus = 0;
+  degraus[totalDegraus++] = { 0, status };
+  for (int i = 0; i < totalTransicoes; i++) {
+    const Transicao& t = transicoes[i];
+    const EventoAgenda& e = eventos[t.evento];
+    if (!t.inicio) {
+      if (status == e.tipo) status = SEM_PAUSA;
+    } else if (agendaEhPausa(e.tipo)) {
+      status = e.tipo;
+    }
+    // Transições no mesmo minuto: vale a última
+    if (degraus[totalDegraus - 1].minutoDoDia == t.minutoDoDia) {
+      degraus[totalDegraus - 1].status = status;
+    } else {
+      degraus[totalDegraus++] = { t.minutoDoDia, status };
+    }
+  }
+}
+
+static void atualizarProximoDisparo() {
+  proximoDisparo = cursor < totalTransicoes
+      ? diaAtual * MINUTOS_POR_DIA + transicoes[cursor].minutoDoDia
+      : (diaAtual + 1) * MINUTOS_POR_DIA;   // Virada do dia
+}
+
+static void posicionar(unsigned long minutoAtual) {
+  diaAtual = minutoAtual / MINUTOS_POR_DIA;
+  uint16_t minutoDoDia = minutoAtual % MINUTOS_POR_DIA;
+  cursor = 0;
+  while (cursor < totalTransicoes && transicoes[cursor].minutoDoDia < minutoDoDia) cursor++;
+  statusPausa = SEM_PAUSA;
+  pausasHoje = 0;
+  atualizarProximoDisparo();
+}
+
+static void carregarTabela(const EventoAgenda* tabela, int total, unsigned long minutoAtual) {
+  totalEventos = min(total, MAX_EVENTOS_AGENDA);
+  for (int i = 0; i < totalEventos; i++) eventos[i] = tabela[i];
+  montarTransicoes();
+  montarDegraus();
+  posicionar(minutoAtual);
+}
+
+bool agendaUsarPerfil(const char* nome, unsigned long minutoAtual) {
+  for (const PerfilPausas& p : PERFIS_PAUSAS) {
+    if (strcmp(p.nome, nome) == 0) {
+      nomePerfil = p.nome;
+      carregarTabela(p.eventos, p.total, minutoAtual);
+      return true;
+    }
+  }
+  return false;
+}
+
+// ---------- Arquivo de ajustes ----------
+static bool aplicarAjuste(char* chave, char* valor) {
+  if (!strcmp(chave, "perfil")) {
+    for (const PerfilPausas& p : PERFIS_PAUSAS) {
+      if (!strcmp(p.nome, valor)) {
+        perfilArquivo = p.nome;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  if (!strcmp(chave, "pausa")) {
+    // HH:MM duração tipo
+    if (totalEventosArquivo >= MAX_EVENTOS_AGENDA) return false;
+    char* fim;
+    long hora = strtol(valor, &fim, 10);
+    if (*fim != ':') return false;
+    long minuto = strtol(fim + 1, &fim, 10);
+    long duracao = strtol(fim, &fim, 10);
+    while (*fim == ' ' || *fim == '\t') fim++;
+    if (hora < 0 || hora > 23 || minuto < 0 || minuto > 59 || duracao < 0 || duracao >= MINUTOS_POR_DIA) {
+      return false;
+    }
+    for (int t = PAUSA_CAFE; t < TOTAL_TIPOS_EVENTO; t++) {
+      if (!strcmp(nomesTipos[t], fim)) {
+        eventosArquivo[totalEventosArquivo++] = { HM(hora, minuto), (uint16_t)duracao, (TipoEventoAgenda)t };
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// ---------- API ----------
+void agendaIniciar(unsigned long minutoAtual) {
+  totalEventosArquivo = 0;
+  perfilArquivo = nullptr;
+  configCarregar(PAUSAS_ARQUIVO, aplicarAjuste);
+
+  if (totalEventosArquivo > 0) {
+    nomePerfil = "arquivo";
+    carregarTabela(eventosArquivo, totalEventosArquivo, minutoAtual);
+  } else {
+    agendaUsarPerfil(perfilArquivo != nullptr ? perfilArquivo : "padrao", minutoAtual);
+  }
+  LOG_INFO("PAUSA", "🗓️ Agenda de pausas: perfil ", nomePerfil, " (", totalEventos, " eventos)");
+}
+
+const EventoAgenda* agendaProcessar(unsigned long minutoAtual) {
+  while (minutoAtual >= proximoDisparo) {
+    if (cursor >= totalTransicoes) {
+      // Virada do dia: recomeça a tabela, zera o contador diário
+      diaAtual++;
+      cursor = 0;
+      pausasHoje = 0;
+      statusPausa = SEM_PAUSA;
+      atualizarProximoDisparo();
+      continue;
+    }
+
+    unsigned long disparo = proximoDisparo;
+    const Transicao& t = transicoes[cursor++];
+    atualizarProximoDisparo();
+    const EventoAgenda& e = eventos[t.evento];
+
+    if (!t.inicio) {
+      // Só encerra se outra pausa não começou por cima desta
+      if (statusPausa == e.tipo) statusPausa = SEM_PAUSA;
+      continue;
+    }
+
+    // Depois de um salto no relógio (ex.: volta de um deep sleep) não anuncia
+    // pausas que já acabaram
+    if (minutoAtual - disparo > max((unsigned long)e.duracaoMin, (unsigned long)AGENDA_ATRASO_MAXIMO_MIN)) {
+      continue;
+    }
+
+    if (agendaEhPausa(e.tipo)) {
+      statusPausa = e.tipo;
+      pausasHoje++;
+    }
+    return &e;
+  }
+  return nullptr;
+}
+
+TipoEventoAgenda agendaStatusPausa() {
+  return statusPausa;
+}
+
+TipoEventoAgenda agendaStatusNoMinuto(uint16_t minutoDoDia) {
+  // Último degrau com início <= minuto; o primeiro começa em 0
+  int inicio = 0, fim = totalDegraus - 1;
+  while (inicio < fim) {
+    int meio = (inicio + fim + 1) / 2;
+    if (degraus[meio].minutoDoDia <= minutoDoDia) inicio = meio;
+    else fim = meio - 1;
+  }
+  return totalDegraus > 0 ? degraus[inicio].status : SEM_PAUSA;
+}
+
+int agendaPausasHoje() {
+  return pausasHoje;
+}
+
+unsigned long agendaDiaAtual() {
+  return diaAtual;
+}
+
+const char* agendaNomePerfil() {
+  return nomePerfil;
+}
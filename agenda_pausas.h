@@ -0,0 +1,104 @@
+#pragma once
+
+#include "hal.h"
+
+// ==================== AGENDA DE PAUSAS ====================
+// Tabela ordenada de eventos do dia (pausas e avisos de expediente) com
+// um cursor para o próximo. A cada chamada só se compara o horário atual
+// com o próximo disparo; cada evento dispara uma vez por dia, e a virada
+// do dia acontece quando a tabela termina (meia-noite virtual).
+//
+// O horário é contado em minutos virtuais absolutos (dia * 1440 + minuto
+// do dia). O perfil vem de PAUSAS_ARQUIVO na flash, se existir:
+//
+//   perfil = intenso              # Um dos perfis embutidos
+//   pausa = 09:00 60 cafe         # Ou uma tabela própria: HH:MM duração tipo
+
+#define PAUSAS_ARQUIVO "/pausas.cfg"
+#define MAX_EVENTOS_AGENDA 16
+#define MINUTOS_POR_DIA 1440
+#define AGENDA_ATRASO_MAXIMO_MIN 30   // Evento vencido há mais que isso (e que a duração) é pulado
+
+enum TipoEventoAgenda : uint8_t {
+  SEM_PAUSA = 0,             // Códigos de status enviados ao ThingSpeak
+  PAUSA_CAFE = 1,
+  PAUSA_ALMOCO = 2,
+  PAUSA_TARDE = 3,
+  PAUSA_ALONGAMENTO = 4,
+  AVISO_INICIO_EXPEDIENTE,   // Avisos: não contam como pausa
+  AVISO_FIM_EXPEDIENTE,
+  TOTAL_TIPOS_EVENTO
+};
+
+struct EventoAgenda {
+  uint16_t minutoDoDia;      // 0-1439
+  uint16_t duracaoMin;       // Tempo em que o status fica na pausa
+  TipoEventoAgenda tipo;
+};
+
+struct PerfilPausas {
+  const char* nome;
+  const EventoAgenda* eventos;
+  uint8_t total;
+};
+
+#define HM(h, m) (uint16_t)((h) * 60 + (m))
+
+constexpr EventoAgenda EVENTOS_PADRAO[] = {
+  { HM(7, 0), 0, AVISO_INICIO_EXPEDIENTE },
+  { HM(9, 0), 60, PAUSA_CAFE },
+  { HM(10, 30), 30, PAUSA_ALONGAMENTO },
+  { HM(12, 0), 60, PAUSA_ALMOCO },
+  { HM(14, 30), 30, PAUSA_ALONGAMENTO },
+  { HM(15, 0), 60, PAUSA_TARDE },
+  { HM(17, 0), 0, AVISO_FIM_EXPEDIENTE },
+};
+
+// Alongamento a cada hora cheia de trabalho
+constexpr EventoAgenda EVENTOS_INTENSO[] = {
+  { HM(7, 0), 0, AVISO_INICIO_EXPEDIENTE },
+  { HM(7, 50), 10, PAUSA_ALONGAMENTO },
+  { HM(8, 50), 10, PAUSA_ALONGAMENTO },
+  { HM(9, 30), 15, PAUSA_CAFE },
+  { HM(10, 50), 10, PAUSA_ALONGAMENTO },
+  { HM(12, 0), 60, PAUSA_ALMOCO },
+  { HM(13, 50), 10, PAUSA_ALONGAMENTO },
+  { HM(14, 50), 10, PAUSA_ALONGAMENTO },
+  { HM(15, 30), 15, PAUSA_TARDE },
+  { HM(16, 50), 10, PAUSA_ALONGAMENTO },
+  { HM(17, 0), 0, AVISO_FIM_EXPEDIENTE },
+};
+
+constexpr EventoAgenda EVENTOS_MEIO_PERIODO[] = {
+  { HM(8, 0), 0, AVISO_INICIO_EXPEDIENTE },
+  { HM(10, 0), 15, PAUSA_CAFE },
+  { HM(11, 0), 5, PAUSA_ALONGAMENTO },
+  { HM(12, 0), 0, AVISO_FIM_EXPEDIENTE },
+};
+
+#define TOTAL_EVENTOS(tabela) (uint8_t)(sizeof(tabela) / sizeof(tabela[0]))
+
+constexpr PerfilPausas PERFIS_PAUSAS[] = {
+  { "padrao", EVENTOS_PADRAO, TOTAL_EVENTOS(EVENTOS_PADRAO) },
+  { "intenso", EVENTOS_INTENSO, TOTAL_EVENTOS(EVENTOS_INTENSO) },
+  { "meio_periodo", EVENTOS_MEIO_PERIODO, TOTAL_EVENTOS(EVENTOS_MEIO_PERIODO) },
+};
+
+// Inicia com o perfil padrão (ou o da flash); eventos antes de agora
+// ficam para o dia seguinte
+void agendaIniciar(unsigned long minutoAtual);
+bool agendaUsarPerfil(const char* nome, unsigned long minutoAtual);
+
+// O(1) quando nada venceu. Retorna o próximo evento que começou (chame
+// de novo até voltar nullptr) - cada um sai exatamente uma vez
+const EventoAgenda* agendaProcessar(unsigned long minutoAtual);
+
+TipoEventoAgenda agendaStatusPausa();   // SEM_PAUSA fora das pausas
+
+// Status que a agenda teria num minuto do dia qualquer, sem mexer no
+// cursor (zonas com a agenda defasada). O(log n)
+TipoEventoAgenda agendaStatusNoMinuto(uint16_t minutoDoDia);
+int agendaPausasHoje();
+unsigned long agendaDiaAtual();
+bool agendaEhPausa(TipoEventoAgenda tipo);
+const char* agendaNomePerfil();
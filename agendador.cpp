@@ -0,0 +1,153 @@
+#include "agendador.h"
+
+#include "log.h"
+
+// Na RTC: tarefas, próximos disparos e contadores atravessam o sono profundo
+static HAL_RETIDO Tarefa tarefas[MAX_TAREFAS];
+static HAL_RETIDO int totalTarefas = 0;
+
+// Comparação segura contra o overflow do halMicros() (~71 min); os períodos
+// são bem menores que metade disso, então a diferença com sinal basta.
+// Tudo em 32 bits: no host o unsigned long tem 64 e a conta não daria a volta
+static bool jaVenceu(uint32_t agora, uint32_t instante) {
+  return (int32_t)(agora - instante) >= 0;
+}
+
+static int registrarTarefa(const char* nome, FuncaoTarefa funcao, unsigned long periodoMs,
+                           unsigned long deadlineUs, unsigned long atrasoMs) {
+  if (totalTarefas >= MAX_TAREFAS || funcao == nullptr) {
+    return -1;
+  }
+
+  Tarefa& t = tarefas[totalTarefas];
+  t.nome = nome;
+  t.funcao = funcao;
+  t.periodoMs = periodoMs;
+  t.deadlineUs = deadlineUs;
+  t.proximaExecucaoUs = (uint32_t)(halMicros() + atrasoMs * 1000UL);
+  t.ativa = true;
+  t.execucoes = 0;
+  t.overruns = 0;
+  t.periodosPerdidos = 0;
+  t.duracaoMaxUs = 0;
+  t.jitterMaxUs = 0;
+  t.jitterSomaUs = 0;
+
+  return totalTarefas++;
+}
+
+int agendadorAdicionarPeriodica(const char* nome, FuncaoTarefa funcao,
+                                unsigned long periodoMs, unsigned long deadlineUs,
+                                unsigned long faseMs) {
+  if (periodoMs == 0) {
+    return -1;
+  }
+  return registrarTarefa(nome, funcao, periodoMs, deadlineUs, faseMs);
+}
+
+int agendadorAdicionarUnica(const char* nome, FuncaoTarefa funcao,
+                            unsigned long atrasoMs, unsigned long deadlineUs) {
+  return registrarTarefa(nome, funcao, 0, deadlineUs, atrasoMs);
+}
+
+void agendadorReagendar(int id, unsigned long atrasoMs) {
+  if (id < 0 || id >= totalTarefas) return;
+  tarefas[id].proximaExecucaoUs = (uint32_t)(halMicros() + atrasoMs * 1000UL);
+  tarefas[id].ativa = true;
+}
+
+void agendadorAlterarPeriodo(int id, unsigned long periodoMs) {
+  if (id < 0 || id >= totalTarefas || periodoMs == 0) return;
+  tarefas[id].periodoMs = periodoMs;
+}
+
+void agendadorSuspender(int id) {
+  if (id < 0 || id >= totalTarefas) return;
+  tarefas[id].ativa = false;
+}
+
+unsigned long agendadorExecutar() {
+  for (int i = 0; i < totalTarefas; i++) {
+    Tarefa& t = tarefas[i];
+    if (!t.ativa) continue;
+
+    uint32_t inicioUs = (uint32_t)halMicros();
+    if (!jaVenceu(inicioUs, t.proximaExecucaoUs)) continue;
+
+    // Jitter = atraso entre o instante programado e o início real
+    uint32_t jitterUs = inicioUs - t.proximaExecucaoUs;
+    if (jitterUs > t.jitterMaxUs) t.jitterMaxUs = jitterUs;
+    t.jitterSomaUs += jitterUs;
+
+    uint32_t programadaUs = t.proximaExecucaoUs;
+    t.funcao();
+    uint32_t fimUs = (uint32_t)halMicros();
+    uint32_t duracaoUs = fimUs - inicioUs;
+
+    t.execucoes++;
+    if (duracaoUs > t.duracaoMaxUs) t.duracaoMaxUs = duracaoUs;
+    if (t.deadlineUs > 0 && duracaoUs > t.deadlineUs) t.overruns++;
+
+    if (t.periodoMs == 0) {
+      // Continua ativa só se a própria tarefa se reagendou
+      if (t.proximaExecucaoUs == programadaUs) t.ativa = false;
+      continue;
+    }
+
+    // Taxa fixa: avança a partir do instante programado, não de "agora",
+    // para que o período real não acumule deriva.
+    uint32_t periodoUs = (uint32_t)(t.periodoMs * 1000UL);
+    t.proximaExecucaoUs += periodoUs;
+    if (jaVenceu(fimUs, t.proximaExecucaoUs)) {
+      uint32_t perdidos = (fimUs - t.proximaExecucaoUs) / periodoUs + 1;
+      t.periodosPerdidos += perdidos;
+      t.proximaExecucaoUs += perdidos * periodoUs;
+    }
+  }
+
+  // Tempo livre até a próxima tarefa
+  uint32_t agoraUs = (uint32_t)halMicros();
+  unsigned long esperaUs = 0xFFFFFFFFUL;
+  for (int i = 0; i < totalTarefas; i++) {
+    const Tarefa& t = tarefas[i];
+    if (!t.ativa) continue;
+    if (jaVenceu(agoraUs, t.proximaExecucaoUs)) return 0;
+    uint32_t falta = t.proximaExecucaoUs - agoraUs;
+    if (falta < esperaUs) esperaUs = falta;
+  }
+  // Arredonda para cima: acordar antes da hora só gira em falso (e, com o
+  // despertar do sono fora do ms cheio, faltaria < 1 ms para sempre)
+  return esperaUs == 0xFFFFFFFFUL ? esperaUs : (esperaUs + 999UL) / 1000UL;
+}
+
+const Tarefa* agendadorTarefa(int id) {
+  if (id < 0 || id >= totalTarefas) return nullptr;
+  return &tarefas[id];
+}
+
+int agendadorTotalTarefas() {
+  return totalTarefas;
+}
+
+void agendadorZerarEstatisticas() {
+  for (int i = 0; i < totalTarefas; i++) {
+    Tarefa& t = tarefas[i];
+    t.execucoes = 0;
+    t.overruns = 0;
+    t.periodosPerdidos = 0;
+    t.duracaoMaxUs = 0;
+    t.jitterMaxUs = 0;
+    t.jitterSomaUs = 0;
+  }
+}
+
+void agendadorImprimirEstatisticas() {
+  LOG_INFO("AGENDADOR", "⏱️  ESTATÍSTICAS DO AGENDADOR");
+  for (int i = 0; i < totalTarefas; i++) {
+    const Tarefa& t = tarefas[i];
+    unsigned long jitterMedio = t.execucoes > 0 ? (unsigned long)(t.jitterSomaUs / t.execucoes) : 0;
+    LOG_INFO("AGENDADOR", "   ", t.nome, ": exec=", t.execucoes, " overrun=", t.overruns,
+                  " perdidos=", t.periodosPerdidos, " durMax=", t.duracaoMaxUs, "us",
+                  " jitterMed=", jitterMedio, "us jitterMax=", t.jitterMaxUs, "us");
+  }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "hal.h"
+
+// ==================== AGENDADOR COOPERATIVO ====================
+// Tarefas periódicas ou únicas sobre millis()/micros(), sem delay().
+// Cada tarefa tem período, prazo (deadline) e contadores próprios.
+
+#define MAX_TAREFAS 12
+
+typedef void (*FuncaoTarefa)();
+
+struct Tarefa {
+  const char* nome;
+  FuncaoTarefa funcao;
+  unsigned long periodoMs;         // 0 = tarefa única (one-shot)
+  unsigned long deadlineUs;        // Tempo máximo de execução permitido
+  uint32_t proximaExecucaoUs;       // No relógio de 32 bits do halMicros()
+  bool ativa;
+
+  // Estatísticas
+  unsigned long execucoes;
+  unsigned long overruns;          // Execução passou do deadline
+  unsigned long periodosPerdidos;  // Atraso maior que um período inteiro
+  unsigned long duracaoMaxUs;
+  unsigned long jitterMaxUs;
+  unsigned long long jitterSomaUs;
+};
+
+int agendadorAdicionarPeriodica(const char* nome, FuncaoTarefa funcao,
+                                unsigned long periodoMs, unsigned long deadlineUs,
+                                unsigned long faseMs = 0);
+int agendadorAdicionarUnica(const char* nome, FuncaoTarefa funcao,
+                            unsigned long atrasoMs, unsigned long deadlineUs);
+// Também serve para uma tarefa única se reagendar de dentro da própria função
+void agendadorReagendar(int id, unsigned long atrasoMs);
+void agendadorAlterarPeriodo(int id, unsigned long periodoMs);
+void agendadorSuspender(int id);
+
+// Executa as tarefas vencidas e retorna quantos ms faltam para a próxima
+unsigned long agendadorExecutar();
+
+const Tarefa* agendadorTarefa(int id);
+int agendadorTotalTarefas();
+void agendadorZerarEstatisticas();
+void agendadorImprimirEstatisticas();
@@ -0,0 +1,263 @@
+#include "alertas_criticos.h"
+
+#include "destino_telemetria.h"
+#include "fila_spsc.h"
+#include "log.h"
+#include "zonas.h"
+
+enum EstadoPendente : uint8_t {
+  PENDENTE_AGUARDANDO,
+  PENDENTE_EM_VOO
+};
+
+// Estado de cada zona (núcleo 1)
+struct EstadoZonaAlerta {
+  uint8_t causas;       // Faixas ativas agora
+  uint8_t notificadas;  // As do último evento gerado
+  uint8_t fichas;
+  unsigned long recargaMs;
+};
+
+struct AlertaPendente {
+  EventoAlerta evento;
+  EstadoPendente estado;
+  unsigned long enviadoMs;
+};
+
+static HAL_RETIDO EstadoZonaAlerta zonas[MAX_ZONAS];
+static HAL_RETIDO uint16_t proximaSequencia;
+static CallbackAlerta aoNotificar = nullptr;
+
+static FilaSPSC<EventoAlerta, ALERTA_CAPACIDADE_FILA> fila;
+
+// Lista de pendentes em ordem de chegada (núcleo 0)
+static HAL_RETIDO AlertaPendente pendentes[ALERTA_MAX_PENDENTES];
+static HAL_RETIDO int totalPendentes;
+
+static HAL_RETIDO EstatisticasAlertas stats;
+
+void alertasIniciar(CallbackAlerta callback) {
+  aoNotificar = callback;
+  if (halDespertouDoSonoProfundo()) {
+    // O socket do destino não sobreviveu: o que estava em voo sai de novo
+    for (int i = 0; i < totalPendentes; i++) pendentes[i].estado = PENDENTE_AGUARDANDO;
+    return;
+  }
+  unsigned long agora = halMillis();
+  for (int z = 0; z < MAX_ZONAS; z++) {
+    zonas[z] = { 0, 0, ALERTA_RAJADA, agora };
+  }
+  proximaSequencia = 0;
+  totalPendentes = 0;
+  stats = EstatisticasAlertas();
+}
+
+// ==================== NÚCLEO 1: TRANSIÇÕES ====================
+static uint8_t avaliarCausas(uint8_t causas, int score, float temperatura) {
+  if (score < ALERTA_SCORE_CRITICO) {
+    causas |= ALERTA_SCORE_BAIXO;
+  } else if (score >= ALERTA_SCORE_CRITICO + ALERTA_HISTERESE_SCORE) {
+    causas &= ~ALERTA_SCORE_BAIXO;
+  }
+  // DHT em falha: a faixa de temperatura fica como estava
+  if (!isnan(temperatura)) {
+    if (temperatura > ALERTA_TEMPERATURA_CRITICA) {
+      causas |= ALERTA_TEMPERATURA_ALTA;
+    } else if (temperatura <= ALERTA_TEMPERATURA_CRITICA - ALERTA_HISTERESE_TEMPERATURA) {
+      causas &= ~ALERTA_TEMPERATURA_ALTA;
+    }
+  }
+  return causas;
+}
+
+static void recarregarFichas(EstadoZonaAlerta& z, unsigned long agora) {
+  unsigned long novas = (agora - z.recargaMs) / ALERTA_INTERVALO_FICHA_MS;
+  if (novas == 0) return;
+  z.recargaMs += novas * ALERTA_INTERVALO_FICHA_MS;
+  z.fichas = (uint8_t)min((unsigned long)ALERTA_RAJADA, z.fichas + novas);
+}
+
+void alertasAvaliar(uint32_t amostraUs) {
+  const ArmazemZonas& armazem = zonasArmazem();
+  unsigned long agora = halMillis();
+
+  for (int i = 0; i < armazem.total; i++) {
+    EstadoZonaAlerta& z = zonas[i];
+    uint8_t causas = avaliarCausas(z.causas, armazem.score[i], armazem.temperatura[i]);
+    bool mudou = causas != z.causas;
+    if (mudou) {
+      z.causas = causas;
+      stats.transicoes++;
+    }
+    if (z.causas == z.notificadas) continue;
+
+    recarregarFichas(z, agora);
+    if (z.fichas == 0) {
+      if (mudou) stats.suprimidas++;
+      continue;
+    }
+    if (z.fichas == ALERTA_RAJADA) z.recargaMs = agora;   // Balde cheio: a recarga conta daqui
+    z.fichas--;
+
+    EventoAlerta evento = { amostraUs, proximaSequencia++, (uint8_t)i, z.causas, z.notificadas,
+                            armazem.score[i], armazem.temperatura[i] };
+    z.notificadas = z.causas;
+    stats.notificacoes++;
+
+    BufferTexto<64> descricao;
+    alertasDescrever(evento, descricao);
+    if (alertaEhEntrada(evento)) {
+      LOG_AVISO("ALERTA", "🚨 ", zonasConfig(i).nome, ": ", descricao.c_str());
+    } else {
+      LOG_INFO("ALERTA", "✅ ", zonasConfig(i).nome, ": ", descricao.c_str());
+    }
+
+    if (aoNotificar != nullptr) aoNotificar(evento);
+    if (!fila.inserir(evento)) stats.descartesFila++;
+  }
+}
+
+// ==================== NÚCLEO 0: ENVIO ====================
+static void removerPendente(int indice) {
+  for (int i = indice; i + 1 < totalPendentes; i++) pendentes[i] = pendentes[i + 1];
+  totalPendentes--;
+}
+
+void alertasReceber() {
+  const DestinoTelemetria& destino = telemetriaDestino();
+  EventoAlerta evento;
+  while (fila.retirar(evento)) {
+    // Destino sem alertas ou zona sem canal: só a reação local
+    if (destino.alertar == nullptr || !destino.aceitaZona(evento.zona)) continue;
+
+    // Um mais novo da mesma zona substitui o que ainda não saiu: o servidor
+    // recebe a transição líquida. Se ela se desfez, nenhum dos dois sai
+    int anterior = -1;
+    for (int i = 0; i < totalPendentes; i++) {
+      if (pendentes[i].evento.zona == evento.zona && pendentes[i].estado == PENDENTE_AGUARDANDO) {
+        anterior = i;
+        break;
+      }
+    }
+    if (anterior >= 0) {
+      evento.causasAnteriores = pendentes[anterior].evento.causasAnteriores;
+      removerPendente(anterior);
+      stats.coalescidos++;
+      if (evento.causas == evento.causasAnteriores) continue;
+    }
+
+    if (totalPendentes == ALERTA_MAX_PENDENTES) {
+      // Lista cheia (servidor fora por muito tempo): perde o mais antigo
+      removerPendente(0);
+      stats.descartados++;
+    }
+    pendentes[totalPendentes++] = { evento, PENDENTE_AGUARDANDO, 0 };
+  }
+}
+
+int alertasEnviar() {
+  const DestinoTelemetria& destino = telemetriaDestino();
+  if (destino.alertar == nullptr) return totalPendentes;
+  unsigned long agora = halMillis();
+
+  int i = 0;
+  while (i < totalPendentes) {
+    AlertaPendente& p = pendentes[i];
+    if (p.estado == PENDENTE_EM_VOO) {
+      if (agora - p.enviadoMs < ALERTA_TIMEOUT_CONFIRMACAO_MS) {
+        i++;
+        continue;
+      }
+      p.estado = PENDENTE_AGUARDANDO;
+      stats.reenvios++;
+    }
+
+    // Agora não (sem conexão, janela cheia, espera depois de uma recusa):
+    // os outros esperam também, para sair em ordem
+    uint16_t sequencia = p.evento.sequencia;
+    if (!destino.alertar(p.evento)) break;
+    stats.enviados++;
+
+    // O destino pode ter confirmado na hora (HTTP) e tirado da lista
+    if (i < totalPendentes && pendentes[i].evento.sequencia == sequencia) {
+      pendentes[i].estado = PENDENTE_EM_VOO;
+      pendentes[i].enviadoMs = agora;
+      i++;
+    }
+  }
+  return totalPendentes;
+}
+
+int alertasPendentes() {
+  return totalPendentes;
+}
+
+bool alertasEmTransito() {
+  return fila.profundidade() > 0;
+}
+
+void alertasConfirmar(uint16_t sequencia) {
+  for (int i = 0; i < totalPendentes; i++) {
+    if (pendentes[i].evento.sequencia != sequencia) continue;
+
+    unsigned long latenciaMs = (uint32_t)((uint32_t)halMicros() - pendentes[i].evento.amostraUs) / 1000UL;
+    int balde = 0;
+    while (balde < ALERTA_BALDES_LATENCIA - 1 && latenciaMs >= alertasLimiteBaldeMs(balde)) balde++;
+    stats.latenciaBaldes[balde]++;
+    stats.latenciaSomaMs += latenciaMs;
+    stats.latenciaMaxMs = max(stats.latenciaMaxMs, latenciaMs);
+    stats.confirmados++;
+    removerPendente(i);
+    return;
+  }
+}
+
+// ==================== DESCRIÇÃO E ESTATÍSTICAS ====================
+bool alertaEhEntrada(const EventoAlerta& evento) {
+  return (evento.causas & ~evento.causasAnteriores) != 0;
+}
+
+void alertasDescrever(const EventoAlerta& evento, EscritorTexto& texto) {
+  texto << (evento.causas != 0 ? "CRITICO" : "NORMAL") << " score=" << (int)evento.score;
+  if (!isnan(evento.temperatura)) texto << " temp=" << Decimal(evento.temperatura, 1);
+  if (evento.causas != 0) {
+    texto << " [";
+    if (evento.causas & ALERTA_SCORE_BAIXO) texto << "score";
+    if (evento.causas == (ALERTA_SCORE_BAIXO | ALERTA_TEMPERATURA_ALTA)) texto << ",";
+    if (evento.causas & ALERTA_TEMPERATURA_ALTA) texto << "temperatura";
+    texto << "]";
+  }
+  texto << " seq=" << (unsigned int)evento.sequencia;
+}
+
+const EstatisticasAlertas& alertasEstatisticas() {
+  return stats;
+}
+
+unsigned long alertasLimiteBaldeMs(int balde) {
+  if (balde >= ALERTA_BALDES_LATENCIA - 1) return 0;
+  return (unsigned long)ALERTA_LATENCIA_BALDE0_MS << balde;
+}
+
+unsigned long alertasPercentilLatenciaMs(float fracao) {
+  if (stats.confirmados == 0) return 0;
+  unsigned long alvo = (unsigned long)ceilf(fracao * stats.confirmados);
+  unsigned long acumulado = 0;
+  for (int b = 0; b < ALERTA_BALDES_LATENCIA - 1; b++) {
+    acumulado += stats.latenciaBaldes[b];
+    if (acumulado >= alvo) return alertasLimiteBaldeMs(b);
+  }
+  return stats.latenciaMaxMs;   // Balde aberto: o máximo é o limite conhecido
+}
+
+void alertasImprimirEstatisticas() {
+  if (stats.transicoes == 0) return;
+  LOG_INFO("ALERTA", "🚨 Alertas: transicoes=", stats.transicoes, " notificacoes=", stats.notificacoes,
+           " suprimidas=", stats.suprimidas, " confirmados=", stats.confirmados,
+           " pendentes=", totalPendentes, " reenvios=", stats.reenvios,
+           " coalescidos=", stats.coalescidos, " descartados=", stats.descartados + stats.descartesFila);
+  if (stats.confirmados == 0) return;
+  LOG_INFO("ALERTA", "   ⏱️  latencia media=", stats.latenciaSomaMs / stats.confirmados,
+           " ms p50<=", alertasPercentilLatenciaMs(0.5f), " ms p99<=", alertasPercentilLatenciaMs(0.99f),
+           " ms max=", stats.latenciaMaxMs, " ms");
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "hal.h"
+
+#include "formatador.h"
+#include "regras_ambiente.h"
+
+// ==================== ALERTAS CRÍTICOS ====================
+// Caminho rápido, por fora da janela de médias de 15 s: a cada amostra
+// (núcleo 1) cada zona é comparada com as faixas críticas - score abaixo
+// de ALERTA_SCORE_CRITICO, temperatura acima de ALERTA_TEMPERATURA_CRITICA -
+// com histerese na saída. Só a transição (entrou ou saiu de uma faixa)
+// vira evento: a reação local (buzzer/LEDs) acontece na mesma amostra e o
+// evento cruza para a tarefa de rede por uma fila SPSC própria, que o
+// envia na frente dos lotes pelo destino ativo da telemetria.
+//
+// Limite de taxa por zona (balde de fichas): ALERTA_RAJADA eventos
+// seguidos e depois um a cada ALERTA_INTERVALO_FICHA_MS. Sem ficha, a
+// transição fica segurada e, quando a ficha volta, sai o estado atual da
+// zona (se ainda for diferente do último notificado): um sensor oscilando
+// não inunda o enlace, e o servidor sempre termina no estado certo.
+//
+// A latência de ponta a ponta vai da amostra que gerou o evento até a
+// confirmação do servidor (HTTP 2xx ou PUBACK), num histograma.
+
+#ifndef ALERTA_SCORE_CRITICO
+#define ALERTA_SCORE_CRITICO SCORE_MINIMO_REGULAR   // Entra com score abaixo disso...
+#endif
+#define ALERTA_HISTERESE_SCORE 10                   // ...e sai com score >= limite + isso
+#ifndef ALERTA_TEMPERATURA_CRITICA
+#define ALERTA_TEMPERATURA_CRITICA 28.0f            // °C - entra acima disso...
+#endif
+#define ALERTA_HISTERESE_TEMPERATURA 0.5f           // ...e sai em limite - isso ou menos
+#define ALERTA_RAJADA 3                             // Fichas do balde de cada zona
+#define ALERTA_INTERVALO_FICHA_MS 60000             // Uma ficha de volta por minuto
+#define ALERTA_CAPACIDADE_FILA 8                    // Eventos em trânsito entre os núcleos
+#define ALERTA_MAX_PENDENTES 8                      // À espera do servidor (retidos no sono)
+#define ALERTA_ESPERA_NOVA_TENTATIVA_MS 2000        // Destinos: depois de um alerta recusado
+#define ALERTA_TIMEOUT_CONFIRMACAO_MS 10000         // Em voo sem confirmação: envia de novo
+
+// Histograma da latência: o balde i vai até ALERTA_LATENCIA_BALDE0_MS << i;
+// o último é aberto
+#define ALERTA_BALDES_LATENCIA 10
+#define ALERTA_LATENCIA_BALDE0_MS 50
+
+// Faixas críticas (máscara)
+enum CausaAlerta : uint8_t {
+  ALERTA_SCORE_BAIXO = 1 << 0,
+  ALERTA_TEMPERATURA_ALTA = 1 << 1
+};
+
+struct EventoAlerta {
+  uint32_t amostraUs;         // halMicros() da amostra que gerou o evento
+  uint16_t sequencia;         // Cresce a cada evento: o servidor ignora repetidos
+  uint8_t zona;
+  uint8_t causas;             // Faixas ativas depois da transição (0 = voltou ao normal)
+  uint8_t causasAnteriores;   // As do último evento da zona
+  uint8_t score;
+  float temperatura;
+};
+
+struct EstatisticasAlertas {
+  // Núcleo 1
+  unsigned long transicoes;      // Entradas e saídas das faixas, antes do limite de taxa
+  unsigned long notificacoes;    // Eventos gerados
+  unsigned long suprimidas;      // Transições seguradas sem ficha
+  unsigned long descartesFila;   // Fila entre os núcleos cheia
+  // Núcleo 0
+  unsigned long enviados;        // Aceitos pelo destino (inclui os reenvios)
+  unsigned long confirmados;
+  unsigned long reenvios;        // Em voo sem confirmação até o timeout
+  unsigned long coalescidos;     // Trocados por um mais novo da mesma zona antes de sair
+  unsigned long descartados;     // Sem lugar na lista de pendentes
+  unsigned long latenciaBaldes[ALERTA_BALDES_LATENCIA];
+  unsigned long latenciaSomaMs;
+  unsigned long latenciaMaxMs;
+};
+
+// Reação local, chamada no núcleo 1 na amostra da transição
+typedef void (*CallbackAlerta)(const EventoAlerta& evento);
+
+// No setup(), depois de zonasIniciar(). O estado das zonas e os
+// pendentes só zeram no boot frio
+void alertasIniciar(CallbackAlerta aoNotificar);
+
+// Núcleo 1, uma vez por amostra, depois de zonasAvaliar()
+void alertasAvaliar(uint32_t amostraUs);
+
+// Núcleo 0 (tarefa de rede): recebe o que o núcleo 1 publicou, em todo
+// passo; envia com o WiFi conectado, antes dos lotes. Retorna quantos
+// ainda esperam o servidor
+void alertasReceber();
+int alertasEnviar();
+
+// Pendentes ou em voo (núcleo 0) e eventos ainda na fila entre os núcleos
+// (qualquer núcleo): enquanto houver, o rádio fica ligado e não se dorme
+int alertasPendentes();
+bool alertasEmTransito();
+
+// Pelo destino, quando o servidor confirma o evento
+void alertasConfirmar(uint16_t sequencia);
+
+bool alertaEhEntrada(const EventoAlerta& evento);   // Alguma faixa nova ativa
+
+// "CRITICO score=45 temp=29.1 [score,temperatura] seq=7" (ASCII, sem aspas)
+void alertasDescrever(const EventoAlerta& evento, EscritorTexto& texto);
+
+const EstatisticasAlertas& alertasEstatisticas();
+unsigned long alertasLimiteBaldeMs(int balde);               // 0 = aberto (o último)
+unsigned long alertasPercentilLatenciaMs(float fracao);      // Limite do balde que contém o percentil
+void alertasImprimirEstatisticas();
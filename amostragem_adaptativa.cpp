@@ -0,0 +1,160 @@
+#include "amostragem_adaptativa.h"
+
+#include "config_arquivo.h"
+#include "log.h"
+
+// Valores de referência para comparar com as bandas mortas
+struct Ancora {
+  bool definida;
+  float temperatura;
+  float umidade;
+  float luminosidade;
+  MascaraViolacoes violacoes;
+};
+
+// Na RTC: âncoras e período atual continuam valendo depois do sono profundo
+static HAL_RETIDO ConfigAdaptativo config;
+static HAL_RETIDO EstatisticasAdaptativo estatisticas;
+static HAL_RETIDO unsigned long periodoBaseMs = 0;
+static HAL_RETIDO int amostrasCalmas = 0;
+static HAL_RETIDO Ancora ancoraAmostragem;
+static HAL_RETIDO Ancora ancoraEnvio;            // Último valor enviado
+static HAL_RETIDO unsigned long ultimoEnvioMs = 0;
+
+// NAN de qualquer lado não conta como movimento
+static bool foraDaBanda(float valor, float referencia, float banda) {
+  return fabsf(valor - referencia) > banda;
+}
+
+static bool mudou(const Ancora& a, float temperatura, float umidade, float luminosidade,
+                  MascaraViolacoes violacoes) {
+  return !a.definida || violacoes != a.violacoes ||
+         foraDaBanda(temperatura, a.temperatura, config.bandaTemperatura) ||
+         foraDaBanda(umidade, a.umidade, config.bandaUmidade) ||
+         foraDaBanda(luminosidade, a.luminosidade, config.bandaLuminosidade);
+}
+
+static void ancorar(Ancora& a, float temperatura, float umidade, float luminosidade,
+                    MascaraViolacoes violacoes) {
+  a.definida = true;
+  // Leitura inválida mantém a referência anterior da grandeza
+  if (!isnan(temperatura)) a.temperatura = temperatura;
+  if (!isnan(umidade)) a.umidade = umidade;
+  a.luminosidade = luminosidade;
+  a.violacoes = violacoes;
+}
+
+// ---------- Arquivo de ajustes ----------
+static bool aplicarAjuste(char* chave, char* valor) {
+  char* fim;
+  if (!strcmp(chave, "habilitado")) {
+    long v = strtol(valor, &fim, 10);
+    if (fim == valor || (v != 0 && v != 1)) return false;
+    config.habilitado = v == 1;
+    return true;
+  }
+
+  if (!strncmp(chave, "banda.", 6)) {
+    float banda = strtof(valor, &fim);
+    if (fim == valor || banda < 0) return false;
+    const char* grandeza = chave + 6;
+    if (!strcmp(grandeza, "temperatura")) config.bandaTemperatura = banda;
+    else if (!strcmp(grandeza, "umidade")) config.bandaUmidade = banda;
+    else if (!strcmp(grandeza, "luminosidade")) config.bandaLuminosidade = banda;
+    else return false;
+    return true;
+  }
+
+  unsigned long* destino = !strcmp(chave, "periodo_max_ms") ? &config.periodoMaxMs
+                         : !strcmp(chave, "heartbeat_ms") ? &config.heartbeatMs
+                         : nullptr;
+  if (destino == nullptr) return false;
+  unsigned long ms = strtoul(valor, &fim, 10);
+  if (fim == valor || ms == 0) return false;
+  *destino = ms;
+  return true;
+}
+
+// ---------- API ----------
+void adaptativoIniciar(unsigned long periodoBase) {
+  config = { true, 0.5f, 3.0f, 150.0f, ADAPTATIVO_PERIODO_MAX_MS, ADAPTATIVO_HEARTBEAT_MS };
+  int ajustes = configCarregar(ADAPTATIVO_ARQUIVO, aplicarAjuste);
+  if (ajustes >= 0) {
+    LOG_INFO("ADAPT", "⚙️ ", ajustes, " ajustes carregados de ", ADAPTATIVO_ARQUIVO);
+  }
+
+  periodoBaseMs = periodoBase;
+  config.periodoMaxMs = max(config.periodoMaxMs, periodoBaseMs);
+  estatisticas = {};
+  estatisticas.periodoAtualMs = periodoBaseMs;
+  amostrasCalmas = 0;
+  ancoraAmostragem = {};
+  ancoraEnvio = {};
+}
+
+void adaptativoHabilitar(bool habilitado) {
+  config.habilitado = habilitado;
+  if (!habilitado) estatisticas.periodoAtualMs = periodoBaseMs;
+}
+
+unsigned long adaptativoAvaliarAmostra(float temperatura, float umidade, int luminosidade,
+                                       MascaraViolacoes violacoes) {
+  if (!config.habilitado) return periodoBaseMs;
+
+  // Esta leitura substituiu (período / base) leituras do modo fixo
+  estatisticas.amostrasEconomizadas += estatisticas.periodoAtualMs / periodoBaseMs - 1;
+
+  if (mudou(ancoraAmostragem, temperatura, umidade, luminosidade, violacoes)) {
+    ancorar(ancoraAmostragem, temperatura, umidade, luminosidade, violacoes);
+    amostrasCalmas = 0;
+    if (estatisticas.periodoAtualMs != periodoBaseMs) {
+      estatisticas.periodoAtualMs = periodoBaseMs;
+      estatisticas.aceleracoes++;
+      LOG_DEBUG("ADAPT", "⚡ Ambiente mudou - amostragem volta a ", periodoBaseMs, " ms");
+    }
+    return estatisticas.periodoAtualMs;
+  }
+
+  if (++amostrasCalmas >= ADAPTATIVO_AMOSTRAS_CALMAS && estatisticas.periodoAtualMs < config.periodoMaxMs) {
+    amostrasCalmas = 0;
+    estatisticas.periodoAtualMs = min(estatisticas.periodoAtualMs * 2, config.periodoMaxMs);
+    LOG_DEBUG("ADAPT", "🐢 Ambiente estável - amostragem a cada ", estatisticas.periodoAtualMs, " ms");
+  }
+  return estatisticas.periodoAtualMs;
+}
+
+bool adaptativoDeveEnviar(float temperatura, float umidade, int luminosidade,
+                          MascaraViolacoes violacoes, unsigned long agoraMs) {
+  if (!config.habilitado) return true;
+
+  bool mudanca = mudou(ancoraEnvio, temperatura, umidade, luminosidade, violacoes);
+  bool heartbeat = agoraMs - ultimoEnvioMs >= config.heartbeatMs;
+  if (!mudanca && !heartbeat) {
+    estatisticas.enviosEconomizados++;
+    return false;
+  }
+
+  if (mudanca) estatisticas.enviosPorMudanca++;
+  else estatisticas.enviosHeartbeat++;
+  ancorar(ancoraEnvio, temperatura, umidade, luminosidade, violacoes);
+  ultimoEnvioMs = agoraMs;
+  return true;
+}
+
+const ConfigAdaptativo& adaptativoConfig() {
+  return config;
+}
+
+const EstatisticasAdaptativo& adaptativoEstatisticas() {
+  return estatisticas;
+}
+
+void adaptativoImprimirEstatisticas() {
+  LOG_INFO("ADAPT", "🐢 Adaptativo: ", config.habilitado ? "ligado" : "desligado",
+           " periodo=", estatisticas.periodoAtualMs, "ms",
+           " amostrasEconomizadas=", estatisticas.amostrasEconomizadas,
+           " enviosEconomizados=", estatisticas.enviosEconomizados,
+           " porMudanca=", estatisticas.enviosPorMudanca,
+           " heartbeat=", estatisticas.enviosHeartbeat,
+           " aceleracoes=", estatisticas.aceleracoes);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "hal.h"
+
+#include "regras_ambiente.h"
+
+// ==================== AMOSTRAGEM ADAPTATIVA ====================
+// Com o ambiente parado, o período do sensoriamento dobra a cada
+// ADAPTATIVO_AMOSTRAS_CALMAS leituras dentro das bandas mortas, até
+// periodoMaxMs, e os envios do ThingSpeak são suprimidos até passar o
+// heartbeat. Uma leitura fora da banda (em relação à âncora) ou uma
+// mudança na máscara de violações volta na hora ao período base e
+// libera o envio seguinte. Ajustável em ADAPTATIVO_ARQUIVO:
+//
+//   habilitado = 1
+//   banda.temperatura = 0.5       # °C
+//   banda.umidade = 3             # %
+//   banda.luminosidade = 150      # leitura do ADC
+//   periodo_max_ms = 20000
+//   heartbeat_ms = 300000
+
+#define ADAPTATIVO_ARQUIVO "/adaptativo.cfg"
+#define ADAPTATIVO_AMOSTRAS_CALMAS 4
+#define ADAPTATIVO_PERIODO_MAX_MS 20000
+#define ADAPTATIVO_HEARTBEAT_MS 300000    // Envio mínimo: 1 a cada 5 min
+
+struct ConfigAdaptativo {
+  bool habilitado;
+  float bandaTemperatura;
+  float bandaUmidade;
+  float bandaLuminosidade;
+  unsigned long periodoMaxMs;
+  unsigned long heartbeatMs;
+};
+
+struct EstatisticasAdaptativo {
+  unsigned long periodoAtualMs;
+  unsigned long amostrasEconomizadas;   // Em relação ao período base
+  unsigned long enviosEconomizados;
+  unsigned long enviosPorMudanca;
+  unsigned long enviosHeartbeat;
+  unsigned long aceleracoes;            // Voltas ao período base
+};
+
+void adaptativoIniciar(unsigned long periodoBaseMs);   // Padrões + ADAPTATIVO_ARQUIVO
+void adaptativoHabilitar(bool habilitado);
+
+// A cada leitura; retorna o período para a próxima (NAN = grandeza sem leitura)
+unsigned long adaptativoAvaliarAmostra(float temperatura, float umidade, int luminosidade,
+                                       MascaraViolacoes violacoes);
+
+// No fechamento de cada janela de envio, com as médias dela
+bool adaptativoDeveEnviar(float temperatura, float umidade, int luminosidade,
+                          MascaraViolacoes violacoes, unsigned long agoraMs);
+
+const ConfigAdaptativo& adaptativoConfig();
+const EstatisticasAdaptativo& adaptativoEstatisticas();
+void adaptativoImprimirEstatisticas();
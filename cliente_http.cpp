@@ -0,0 +1,212 @@
+#include "cliente_http.h"
+
+#include "formatador.h"
+
+// Resposta HTTP simplificada: status, Content-Length, chunked e Connection
+static bool comecaComSemCaixa(const char* texto, const char* prefixo) {
+  for (; *prefixo; texto++, prefixo++) {
+    if (tolower((unsigned char)*texto) != tolower((unsigned char)*prefixo)) return false;
+  }
+  return true;
+}
+
+static bool contemSemCaixa(const char* texto, const char* trecho) {
+  for (; *texto; texto++) {
+    if (comecaComSemCaixa(texto, trecho)) return true;
+  }
+  return false;
+}
+
+void ClienteHttpPersistente::configurar(const char* hostDestino, uint16_t portaDestino) {
+  fechar();
+  host = hostDestino;
+  porta = portaDestino;
+  enderecoResolvido = false;
+}
+
+void ClienteHttpPersistente::fechar() {
+  cliente.fechar();
+}
+
+bool ClienteHttpPersistente::garantirConexao() {
+  tempos.conexaoReaproveitada = cliente.conectado();
+  if (tempos.conexaoReaproveitada) {
+    tempos.conexaoUs = 0;
+    stats.reaproveitadas++;
+    return true;
+  }
+
+  unsigned long inicio = halMicros();
+  cliente.fechar();
+
+  if (!enderecoResolvido) {
+    stats.consultasDns++;
+    if (!halResolverHost(host, enderecoCache)) {
+      return false;
+    }
+    enderecoResolvido = true;
+  }
+
+  if (!cliente.conectar(enderecoCache, porta)) {
+    // O IP em cache pode ter mudado: resolve de novo na próxima vez
+    enderecoResolvido = false;
+    return false;
+  }
+
+  stats.conexoesAbertas++;
+  tempos.conexaoUs = halMicros() - inicio;
+  return true;
+}
+
+bool ClienteHttpPersistente::enviarRequisicao(const char* caminho, const char* tipoConteudo,
+                                              const uint8_t* corpo, size_t tamanho) {
+  BufferTexto<HTTP_TAMANHO_LINHA * 2> cabecalho;
+  cabecalho << "POST " << caminho << " HTTP/1.1\r\n"
+            << "Host: " << host << "\r\n"
+            << "Connection: keep-alive\r\n"
+            << "Content-Type: " << tipoConteudo << "\r\n"
+            << "Content-Length: " << (unsigned long)tamanho << "\r\n\r\n";
+  if (cabecalho.foiTruncado()) return false;
+
+  unsigned long inicio = halMicros();
+  bool ok = cliente.escrever((const uint8_t*)cabecalho.c_str(), cabecalho.tamanho()) == cabecalho.tamanho();
+  if (ok && tamanho > 0) {
+    ok = cliente.escrever(corpo, tamanho) == tamanho;
+  }
+  tempos.envioUs = halMicros() - inicio;
+  return ok;
+}
+
+int ClienteHttpPersistente::lerByte(unsigned long limite) {
+  while (!cliente.disponivel()) {
+    if (!cliente.conectado() || (long)(halMillis() - limite) >= 0) {
+      return -1;
+    }
+    halDelay(1);
+  }
+  return cliente.ler();
+}
+
+bool ClienteHttpPersistente::lerLinha(char* destino, size_t capacidade, unsigned long limite) {
+  size_t n = 0;
+  for (;;) {
+    int c = lerByte(limite);
+    if (c < 0) return false;
+    if (c == '\n') break;
+    if (c != '\r' && n + 1 < capacidade) destino[n++] = (char)c;
+  }
+  destino[n] = '\0';
+  return true;
+}
+
+int ClienteHttpPersistente::lerResposta() {
+  unsigned long inicioEspera = halMicros();
+  unsigned long limite = halMillis() + HTTP_TIMEOUT_MS;
+  char linha[HTTP_TAMANHO_LINHA];
+
+  // Espera pelo primeiro byte separada do resto da leitura. Fechada sem
+  // nenhum byte = socket ocioso que o servidor já tinha derrubado; timeout
+  // = o servidor pode estar processando o corpo
+  while (!cliente.disponivel()) {
+    if (!cliente.conectado()) return HTTP_SEM_RESPOSTA;
+    if ((long)(halMillis() - limite) >= 0) return HTTP_RESPOSTA_INCOMPLETA;
+    halDelay(1);
+  }
+  tempos.esperaUs = halMicros() - inicioEspera;
+  unsigned long inicioLeitura = halMicros();
+
+  if (!lerLinha(linha, sizeof(linha), limite)) return HTTP_RESPOSTA_INCOMPLETA;
+  // "HTTP/1.1 202 Accepted"
+  const char* espaco = strchr(linha, ' ');
+  if (espaco == nullptr) return HTTP_RESPOSTA_INCOMPLETA;
+  int status = atoi(espaco + 1);
+
+  long contentLength = -1;
+  bool chunked = false;
+  manterConexao = true;
+  for (;;) {
+    if (!lerLinha(linha, sizeof(linha), limite)) return HTTP_RESPOSTA_INCOMPLETA;
+    if (linha[0] == '\0') break;
+    if (comecaComSemCaixa(linha, "Content-Length:")) {
+      contentLength = atol(linha + 15);
+    } else if (comecaComSemCaixa(linha, "Transfer-Encoding:") && contemSemCaixa(linha, "chunked")) {
+      chunked = true;
+    } else if (comecaComSemCaixa(linha, "Connection:") && contemSemCaixa(linha, "close")) {
+      manterConexao = false;
+    }
+  }
+
+  // Corpo: guarda o começo, consome o resto para liberar o socket
+  size_t guardado = 0;
+  long restante = contentLength;
+  for (;;) {
+    if (chunked) {
+      if (!lerLinha(linha, sizeof(linha), limite)) return HTTP_RESPOSTA_INCOMPLETA;
+      restante = strtol(linha, nullptr, 16);
+      if (restante == 0) {
+        lerLinha(linha, sizeof(linha), limite);   // CRLF final
+        break;
+      }
+    } else if (restante < 0) {
+      // Sem tamanho: o corpo termina quando o servidor fecha
+      manterConexao = false;
+      restante = 0x7FFFFFFF;
+    }
+
+    while (restante > 0) {
+      int c = lerByte(limite);
+      if (c < 0) {
+        if (contentLength < 0 && !chunked) break;
+        return HTTP_RESPOSTA_INCOMPLETA;
+      }
+      if (guardado + 1 < sizeof(corpoResposta)) corpoResposta[guardado++] = (char)c;
+      restante--;
+    }
+
+    if (!chunked) break;
+    lerLinha(linha, sizeof(linha), limite);   // CRLF após o bloco
+  }
+  corpoResposta[guardado] = '\0';
+
+  tempos.leituraUs = halMicros() - inicioLeitura;
+  return status;
+}
+
+int ClienteHttpPersistente::post(const char* caminho, const char* tipoConteudo,
+                                 const uint8_t* corpo, size_t tamanho) {
+  stats.requisicoes++;
+  corpoResposta[0] = '\0';
+  tempos = TemposRequisicaoHttp();
+
+  // Segunda volta só acontece se um socket reaproveitado estava morto:
+  // a escrita falhou ou o servidor fechou sem responder nada
+  for (int tentativa = 0; tentativa < 2; tentativa++) {
+    if (!garantirConexao()) {
+      stats.falhas++;
+      return -1;
+    }
+
+    if (enviarRequisicao(caminho, tipoConteudo, corpo, tamanho)) {
+      int status = lerResposta();
+      if (status > 0) {
+        if (!manterConexao) cliente.fechar();
+        return status;
+      }
+      if (status != HTTP_SEM_RESPOSTA) {
+        // O servidor pode ter aceitado o lote: não repete aqui. O chamador
+        // mantém o lote na fila e o reenvia na próxima rodada, então nesse
+        // caso as entradas chegam duplicadas (pelo menos uma vez)
+        cliente.fechar();
+        stats.falhas++;
+        return -1;
+      }
+    }
+
+    cliente.fechar();
+    if (!tempos.conexaoReaproveitada) break;
+    stats.reenviosSocketMorto++;
+  }
+
+  stats.falhas++;
+  return -1;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "hal.h"
+
+// ==================== CLIENTE HTTP PERSISTENTE ====================
+// HTTP/1.1 com keep-alive sobre um único socket TCP: o DNS é resolvido uma
+// vez, o socket é reaproveitado entre envios e, se o servidor tiver fechado
+// a conexão ociosa, ela é reaberta e a requisição repetida sem o chamador
+// perceber. Só se repete quando o servidor não pode ter processado o POST
+// (a escrita falhou ou ele fechou sem mandar nenhum byte): o bulk_update
+// não é idempotente, e uma resposta perdida ou cortada depois do envio é
+// falha, não reenvio imediato. A entrega continua sendo pelo menos uma
+// vez: o lote falho fica na fila e vai de novo na próxima rodada, então
+// se o servidor já o tinha aceitado as entradas chegam duplicadas. Cada
+// requisição mede conexão, envio e espera separadamente.
+
+#define HTTP_TIMEOUT_MS 5000
+#define HTTP_TAMANHO_RESPOSTA 256     // Corpo guardado (o resto é descartado)
+#define HTTP_TAMANHO_LINHA 128
+
+// Falhas de lerResposta(): só a primeira permite repetir a requisição
+#define HTTP_SEM_RESPOSTA -2          // Fechada antes do primeiro byte da linha de status
+#define HTTP_RESPOSTA_INCOMPLETA -1   // Timeout ou resposta cortada/inválida (o POST pode ter sido aceito)
+
+struct TemposRequisicaoHttp {
+  unsigned long conexaoUs;   // DNS + TCP (0 quando o socket foi reaproveitado)
+  unsigned long envioUs;     // Escrita da requisição
+  unsigned long esperaUs;    // Até o primeiro byte da resposta
+  unsigned long leituraUs;   // Cabeçalhos + corpo
+  bool conexaoReaproveitada;
+};
+
+struct EstatisticasHttp {
+  unsigned long requisicoes;
+  unsigned long conexoesAbertas;
+  unsigned long reaproveitadas;
+  unsigned long reenviosSocketMorto;
+  unsigned long consultasDns;
+  unsigned long falhas;
+};
+
+class ClienteHttpPersistente {
+ public:
+  void configurar(const char* host, uint16_t porta);
+
+  // Retorna o status HTTP, ou um valor negativo em falha de rede
+  int post(const char* caminho, const char* tipoConteudo,
+           const uint8_t* corpo, size_t tamanho);
+
+  void fechar();
+
+  const char* resposta() const { return corpoResposta; }
+  const TemposRequisicaoHttp& ultimosTempos() const { return tempos; }
+  const EstatisticasHttp& estatisticas() const { return stats; }
+
+ private:
+  bool garantirConexao();
+  bool enviarRequisicao(const char* caminho, const char* tipoConteudo,
+                        const uint8_t* corpo, size_t tamanho);
+  int lerResposta();   // Status, ou HTTP_SEM_RESPOSTA / HTTP_RESPOSTA_INCOMPLETA
+  int lerByte(unsigned long limite);
+  bool lerLinha(char* destino, size_t capacidade, unsigned long limite);
+
+  HalClienteTcp cliente;
+  const char* host = "";
+  uint16_t porta = 80;
+  uint8_t enderecoCache[4] = {};
+  bool enderecoResolvido = false;
+  bool manterConexao = true;
+
+  char corpoResposta[HTTP_TAMANHO_RESPOSTA] = "";
+  TemposRequisicaoHttp tempos = {};
+  EstatisticasHttp stats = {};
+};
@@ -0,0 +1,289 @@
+#include "cliente_mqtt.h"
+
+#define MQTT_CONNECT 0x10
+#define MQTT_CONNACK 0x20
+#define MQTT_PUBLISH_QOS1 0x32
+#define MQTT_FLAG_DUP 0x08
+#define MQTT_PUBACK 0x40
+#define MQTT_PINGREQ 0xC0
+#define MQTT_PINGRESP 0xD0
+#define MQTT_DISCONNECT 0xE0
+#define MQTT_TAMANHO_ID_MAXIMO 64
+
+// "Remaining length": 7 bits por byte, bit alto = continua
+static size_t escreverComprimento(uint8_t* destino, size_t valor) {
+  size_t n = 0;
+  do {
+    uint8_t b = valor & 0x7F;
+    valor >>= 7;
+    destino[n++] = valor > 0 ? (uint8_t)(b | 0x80) : b;
+  } while (valor > 0 && n < 4);
+  return n;
+}
+
+// false = ainda faltam bytes do comprimento
+static bool lerComprimento(const uint8_t* dados, size_t disponivel, size_t& valor, size_t& bytes) {
+  valor = 0;
+  for (bytes = 0; bytes < disponivel && bytes < 4; bytes++) {
+    valor |= (size_t)(dados[bytes] & 0x7F) << (7 * bytes);
+    if (!(dados[bytes] & 0x80)) {
+      bytes++;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ClienteMqtt::configurar(const char* hostDestino, uint16_t portaDestino, const char* id,
+                             CallbackConfirmacaoMqtt callback) {
+  fechar();
+  host = hostDestino;
+  porta = portaDestino;
+  idCliente = id;
+  aoConfirmar = callback;
+  enderecoResolvido = false;
+}
+
+bool ClienteMqtt::escrever(const uint8_t* dados, size_t tamanho) {
+  size_t enviados = cliente.escrever(dados, tamanho);
+  stats.bytesEnviados += enviados;
+  ultimoEnvioMs = halMillis();
+  return enviados == tamanho;
+}
+
+int ClienteMqtt::lerByte(unsigned long limite) {
+  while (!cliente.disponivel()) {
+    if (!cliente.conectado() || (long)(halMillis() - limite) >= 0) {
+      return -1;
+    }
+    halDelay(1);
+  }
+  int c = cliente.ler();
+  if (c >= 0) stats.bytesRecebidos++;
+  return c;
+}
+
+void ClienteMqtt::perderConexao() {
+  cliente.fechar();
+  sessaoAberta = false;
+  aguardandoPing = false;
+  tamanhoEntrada = 0;
+  descartar = 0;
+  for (MensagemEmVoo& m : janela) m.ocupada = false;
+}
+
+bool ClienteMqtt::conectar() {
+  if (sessaoAberta && cliente.conectado()) return true;
+  if (sessaoAberta) {
+    stats.falhas++;
+    perderConexao();
+  }
+
+  if (!enderecoResolvido) {
+    if (!halResolverHost(host, enderecoCache)) {
+      stats.falhas++;
+      return false;
+    }
+    enderecoResolvido = true;
+  }
+  if (!cliente.conectar(enderecoCache, porta)) {
+    // O IP em cache pode ter mudado: resolve de novo na próxima vez
+    enderecoResolvido = false;
+    stats.falhas++;
+    return false;
+  }
+
+  // CONNECT: protocolo "MQTT" nível 4, sessão limpa, keep-alive, id do cliente
+  size_t tamanhoId = min(strlen(idCliente), (size_t)MQTT_TAMANHO_ID_MAXIMO);
+  uint8_t pacote[14 + MQTT_TAMANHO_ID_MAXIMO] = {
+    MQTT_CONNECT, (uint8_t)(12 + tamanhoId),
+    0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, 0x02,
+    (uint8_t)(MQTT_KEEPALIVE_S >> 8), (uint8_t)(MQTT_KEEPALIVE_S & 0xFF),
+    (uint8_t)(tamanhoId >> 8), (uint8_t)(tamanhoId & 0xFF)
+  };
+  memcpy(pacote + 14, idCliente, tamanhoId);
+
+  // CONNACK: 0x20 0x02 <flags> <código de retorno>
+  unsigned long limite = halMillis() + MQTT_TIMEOUT_MS;
+  uint8_t connack[4] = {};
+  bool ok = escrever(pacote, 14 + tamanhoId);
+  for (int i = 0; ok && i < 4; i++) {
+    int c = lerByte(limite);
+    ok = c >= 0;
+    connack[i] = (uint8_t)c;
+  }
+  if (!ok || connack[0] != MQTT_CONNACK || connack[3] != 0) {
+    stats.falhas++;
+    perderConexao();
+    return false;
+  }
+
+  sessaoAberta = true;
+  stats.conexoes++;
+  return true;
+}
+
+bool ClienteMqtt::conectado() {
+  return sessaoAberta && cliente.conectado();
+}
+
+int ClienteMqtt::emVoo() {
+  int total = 0;
+  for (const MensagemEmVoo& m : janela) total += m.ocupada;
+  return total;
+}
+
+int ClienteMqtt::janelaLivre() {
+  return sessaoAberta ? MQTT_JANELA - emVoo() : 0;
+}
+
+bool ClienteMqtt::publicar(const char* topico, const uint8_t* carga, size_t tamanho, uint32_t contexto) {
+  if (!sessaoAberta) return false;
+  MensagemEmVoo* m = nullptr;
+  for (MensagemEmVoo& livre : janela) {
+    if (!livre.ocupada) {
+      m = &livre;
+      break;
+    }
+  }
+  if (m == nullptr) return false;
+
+  // PUBLISH: cabeçalho, tópico, id do pacote e a carga
+  size_t tamanhoTopico = strlen(topico);
+  size_t restante = 2 + tamanhoTopico + 2 + tamanho;
+  uint8_t comprimento[4];
+  size_t bytesComprimento = escreverComprimento(comprimento, restante);
+  if (1 + bytesComprimento + restante > MQTT_TAMANHO_PACOTE) return false;
+
+  uint16_t id = proximoId++;
+  if (proximoId == 0) proximoId = 1;
+
+  uint8_t* p = m->pacote;
+  *p++ = MQTT_PUBLISH_QOS1;
+  memcpy(p, comprimento, bytesComprimento);
+  p += bytesComprimento;
+  *p++ = (uint8_t)(tamanhoTopico >> 8);
+  *p++ = (uint8_t)(tamanhoTopico & 0xFF);
+  memcpy(p, topico, tamanhoTopico);
+  p += tamanhoTopico;
+  *p++ = (uint8_t)(id >> 8);
+  *p++ = (uint8_t)(id & 0xFF);
+  memcpy(p, carga, tamanho);
+  p += tamanho;
+
+  m->ocupada = true;
+  m->idPacote = id;
+  m->contexto = contexto;
+  m->enviadaMs = halMillis();
+  m->tentativas = 0;
+  m->tamanho = p - m->pacote;
+  if (!escrever(m->pacote, m->tamanho)) {
+    stats.falhas++;
+    perderConexao();
+    return false;
+  }
+  stats.publicacoes++;
+  return true;
+}
+
+void ClienteMqtt::tratarPacote(uint8_t tipo, const uint8_t* corpo, size_t tamanho) {
+  if ((tipo & 0xF0) == MQTT_PUBACK && tamanho >= 2) {
+    uint16_t id = (uint16_t)(corpo[0] << 8 | corpo[1]);
+    for (MensagemEmVoo& m : janela) {
+      if (!m.ocupada || m.idPacote != id) continue;
+      m.ocupada = false;
+      stats.confirmadas++;
+      if (aoConfirmar) aoConfirmar(m.contexto);
+      break;
+    }
+  } else if ((tipo & 0xF0) == MQTT_PINGRESP) {
+    aguardandoPing = false;
+  }
+}
+
+void ClienteMqtt::processar(bool urgente) {
+  if (!sessaoAberta) return;
+  if (!cliente.conectado()) {
+    stats.falhas++;
+    perderConexao();
+    return;
+  }
+
+  // Resposta vencida: antes de reenviar, dá uma chance ao que está para
+  // chegar (no host o broker não anda com o relógio virtual e o
+  // disponivel() espera um pouco de tempo real)
+  unsigned long agora = halMillis();
+  bool vencido = aguardandoPing && agora - pingEnviadoMs >= MQTT_TIMEOUT_MS;
+  for (const MensagemEmVoo& m : janela) {
+    vencido |= m.ocupada && agora - m.enviadaMs >= MQTT_TIMEOUT_MS;
+  }
+  if (vencido || urgente) cliente.disponivel();
+
+  uint8_t bloco[32];
+  size_t lidos;
+  while ((lidos = cliente.lerDisponivel(bloco, sizeof(bloco))) > 0) {
+    stats.bytesRecebidos += lidos;
+    for (size_t i = 0; i < lidos; i++) {
+      if (descartar > 0) {
+        descartar--;
+        continue;
+      }
+      entrada[tamanhoEntrada++] = bloco[i];
+
+      size_t restante, bytesComprimento;
+      if (tamanhoEntrada < 2 || !lerComprimento(entrada + 1, tamanhoEntrada - 1, restante, bytesComprimento)) {
+        if (tamanhoEntrada == sizeof(entrada)) tamanhoEntrada = 0;   // Comprimento inválido
+        continue;
+      }
+      size_t total = 1 + bytesComprimento + restante;
+      if (total > sizeof(entrada)) {
+        descartar = total - tamanhoEntrada;
+        tamanhoEntrada = 0;
+      } else if (tamanhoEntrada == total) {
+        tratarPacote(entrada[0], entrada + 1 + bytesComprimento, restante);
+        tamanhoEntrada = 0;
+      }
+    }
+  }
+
+  // QoS 1: sem PUBACK no prazo, o mesmo pacote com DUP
+  for (MensagemEmVoo& m : janela) {
+    if (!m.ocupada || agora - m.enviadaMs < MQTT_TIMEOUT_MS) continue;
+    if (m.tentativas >= MQTT_MAX_REENVIOS) {
+      stats.falhas++;
+      perderConexao();
+      return;
+    }
+    m.pacote[0] |= MQTT_FLAG_DUP;
+    m.enviadaMs = agora;
+    m.tentativas++;
+    stats.reenvios++;
+    if (!escrever(m.pacote, m.tamanho)) {
+      stats.falhas++;
+      perderConexao();
+      return;
+    }
+  }
+
+  if (aguardandoPing && agora - pingEnviadoMs >= MQTT_TIMEOUT_MS) {
+    stats.falhas++;
+    perderConexao();
+  } else if (!aguardandoPing && agora - ultimoEnvioMs >= MQTT_KEEPALIVE_S * 1000UL / 2) {
+    static const uint8_t ping[2] = { MQTT_PINGREQ, 0x00 };
+    aguardandoPing = true;
+    pingEnviadoMs = agora;
+    stats.pings++;
+    if (!escrever(ping, sizeof(ping))) {
+      stats.falhas++;
+      perderConexao();
+    }
+  }
+}
+
+void ClienteMqtt::fechar() {
+  if (sessaoAberta && cliente.conectado()) {
+    static const uint8_t desconectar[2] = { MQTT_DISCONNECT, 0x00 };
+    escrever(desconectar, sizeof(desconectar));
+  }
+  perderConexao();
+}
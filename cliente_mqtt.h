@@ -0,0 +1,94 @@
+#pragma once
+
+#include "hal.h"
+
+// ==================== CLIENTE MQTT ====================
+// MQTT 3.1.1 mínimo sobre um único socket TCP persistente: CONNECT com
+// sessão limpa, PUBLISH QoS 1 com até MQTT_JANELA mensagens em voo,
+// reenvio com DUP quando o PUBACK não chega em MQTT_TIMEOUT_MS e PINGREQ
+// no keep-alive. Só a conexão bloqueia (até o CONNACK); publicar e
+// processar() não esperam o broker. Cada PUBACK chama o callback com o
+// contexto dado na publicação. Se a conexão cair, o que estava em voo é
+// esquecido: quem publica ainda tem os dados e publica de novo.
+
+#define MQTT_PORTA 1883
+#define MQTT_KEEPALIVE_S 60
+#define MQTT_TIMEOUT_MS 5000          // CONNACK, PUBACK e PINGRESP
+#define MQTT_JANELA 4                 // Publicações QoS 1 sem PUBACK
+#define MQTT_TAMANHO_PACOTE 256       // Maior PUBLISH (guardado para o reenvio)
+#define MQTT_MAX_REENVIOS 3           // Depois disso a conexão é refeita
+
+struct EstatisticasMqtt {
+  unsigned long conexoes;
+  unsigned long publicacoes;
+  unsigned long confirmadas;
+  unsigned long reenvios;            // PUBLISH repetido com DUP
+  unsigned long pings;
+  unsigned long falhas;              // Conexão recusada, perdida ou sem resposta
+  unsigned long long bytesEnviados;
+  unsigned long long bytesRecebidos;
+};
+
+typedef void (*CallbackConfirmacaoMqtt)(uint32_t contexto);
+
+class ClienteMqtt {
+ public:
+  void configurar(const char* host, uint16_t porta, const char* idCliente,
+                  CallbackConfirmacaoMqtt aoConfirmar);
+
+  bool conectar();     // Reaproveita a conexão aberta; senão TCP + CONNECT + CONNACK
+  bool conectado();
+  int janelaLivre();   // Publicações que ainda cabem em voo
+  int emVoo();
+
+  // QoS 1. false = sem conexão, janela cheia ou pacote maior que MQTT_TAMANHO_PACOTE
+  bool publicar(const char* topico, const uint8_t* carga, size_t tamanho, uint32_t contexto);
+
+  // PUBACKs recebidos, reenvios e keep-alive. Não bloqueia. "urgente" =
+  // há uma resposta esperada com pressa (alerta): olha o socket como
+  // quando um prazo vence
+  void processar(bool urgente = false);
+
+  void fechar();       // DISCONNECT e fecha o socket
+
+  const EstatisticasMqtt& estatisticas() const { return stats; }
+
+ private:
+  struct MensagemEmVoo {
+    bool ocupada;
+    uint16_t idPacote;
+    uint32_t contexto;
+    unsigned long enviadaMs;
+    uint8_t tentativas;
+    size_t tamanho;
+    uint8_t pacote[MQTT_TAMANHO_PACOTE];
+  };
+
+  bool escrever(const uint8_t* dados, size_t tamanho);
+  int lerByte(unsigned long limite);
+  void tratarPacote(uint8_t tipo, const uint8_t* corpo, size_t tamanho);
+  void perderConexao();
+
+  HalClienteTcp cliente;
+  const char* host = "";
+  uint16_t porta = MQTT_PORTA;
+  const char* idCliente = "";
+  CallbackConfirmacaoMqtt aoConfirmar = nullptr;
+  uint8_t enderecoCache[4] = {};
+  bool enderecoResolvido = false;
+  bool sessaoAberta = false;
+
+  MensagemEmVoo janela[MQTT_JANELA] = {};
+  uint16_t proximoId = 1;
+  unsigned long ultimoEnvioMs = 0;
+  unsigned long pingEnviadoMs = 0;
+  bool aguardandoPing = false;
+
+  // Pacotes recebidos: só os de controle (CONNACK, PUBACK, PINGRESP) são
+  // guardados; PUBLISH do broker (sem assinatura, não deveria vir) é pulado
+  uint8_t entrada[16] = {};
+  size_t tamanhoEntrada = 0;
+  size_t descartar = 0;
+
+  EstatisticasMqtt stats = {};
+};
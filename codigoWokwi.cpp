@@ -1,9 +1,30 @@
-#include <WiFi.h>
-#include <HTTPClient.h>
-#include <DHT.h>
+#include "hal.h"
+#include "agendador.h"
+#include "alertas_criticos.h"
+#include "amostragem_adaptativa.h"
+#include "conexao_wifi.h"
+#include "fila_telemetria.h"
+#include "fila_spsc.h"
+#include "formatador.h"
+#include "historico.h"
+#include "log.h"
+#include "metricas_heap.h"
+#include "modo_energia.h"
+#include "cliente_http.h"
+#include "destino_telemetria.h"
+#include "perfil_estagios.h"
+#include "regras_ambiente.h"
+#include "saude.h"
+#include "sensor_dht.h"
+#include "sensor_luz.h"
+#include "agenda_pausas.h"
+#include "estatisticas_janela.h"
+#include "servidor_metricas.h"
+#include "telemetria_mqtt.h"
+#include "trilha_sensores.h"
+#include "zonas.h"
 
 #define DHT_PIN 4
-#define DHT_TYPE DHT22
 
 // ======================= DEFINIÇÃO DOS PINOS ==============================
 #define LED_VERMELHO 12             // Temperatura alta
@@ -18,133 +39,321 @@
 #define WIFI_PASSWORD ""
 #define THINGSPEAK_API_KEY "8SMHZFKBKRSXQRAF"
 #define THINGSPEAK_URL "http://api.thingspeak.com/update"
+#define THINGSPEAK_CHANNEL_ID "3170636"
+// O build nativo (host/) redireciona o host para o stub HTTP local
+#ifndef THINGSPEAK_HOST
+#define THINGSPEAK_HOST "api.thingspeak.com"
+#endif
+#ifndef THINGSPEAK_PORTA
+#define THINGSPEAK_PORTA 80
+#endif
+#define LOTE_MAXIMO_THINGSPEAK 100        // Entradas por requisição bulk (limite da API: 960)
+#define TAMANHO_CORPO_BULK 10240          // ~90 bytes por entrada + cabeçalho JSON
 
 // Campos do ThingSpeak
 #define FIELD_TEMPERATURA 1
 #define FIELD_UMIDADE 2
 #define FIELD_LUMINOSIDADE 3
 #define FIELD_SCORE_SAUDE 4
+// Saúde do kit (saude.h), só na entrada mais nova de cada lote da zona 0
+#define FIELD_TICK_MAX_US 5
+#define FIELD_ENVIO_MAX_MS 6
+#define FIELD_HEAP_MINIMO 7
+#define FIELD_RSSI 8
 
-bool wifiConectado = false;
-unsigned long ultimoEnvioThingSpeak = 0;
 #define INTERVALO_ENVIO_THINGSPEAK 15000  // 15 segundos
-
-// ==================== SISTEMA DE ACUMULAÇÃO PARA MÉDIAS ====================
-float tempAcumulada = 0;
-float umidadeAcumulada = 0;
-int ldrAcumulado = 0;
-int scoreAcumulado = 0;
-int leituras = 0;
+#define THINGSPEAK_CAMINHO_ALERTA "/update.json"   // Um alerta = uma atualização só com "status"
+
+// ==================== DESTINO DA TELEMETRIA ====================
+// "thingspeak" (HTTP bulk, um canal por zona) ou "mqtt" (broker próprio,
+// tópico por zona, carga binária). O build nativo escolhe com --destino
+#ifndef DESTINO_TELEMETRIA
+#define DESTINO_TELEMETRIA "thingspeak"
+#endif
+#define MQTT_HOST "broker.local"
+#define MQTT_ID_DISPOSITIVO "kit01"
+
+// ==================== ZONAS ====================
+// A zona 0 é a mesa do kit (LEDs e buzzer). As outras têm DHT22 e LDR
+// próprios (LDR só nos pinos do ADC1) e um canal próprio no ThingSpeak,
+// com os mesmos campos 1-4; sem canal, a zona é avaliada mas não enviada.
+// ZONAS_ATIVAS escolhe quantas linhas da tabela são lidas.
+#ifndef ZONAS_ATIVAS
+#define ZONAS_ATIVAS 1
+#endif
+#ifndef THINGSPEAK_CANAL_ZONA_1
+#define THINGSPEAK_CANAL_ZONA_1 nullptr
+#define THINGSPEAK_CHAVE_ZONA_1 nullptr
+#endif
+#ifndef THINGSPEAK_CANAL_ZONA_2
+#define THINGSPEAK_CANAL_ZONA_2 nullptr
+#define THINGSPEAK_CHAVE_ZONA_2 nullptr
+#endif
+#ifndef THINGSPEAK_CANAL_ZONA_3
+#define THINGSPEAK_CANAL_ZONA_3 nullptr
+#define THINGSPEAK_CHAVE_ZONA_3 nullptr
+#endif
+
+const ConfigZona ZONAS[] = {
+  // nome, DHT, LDR, canal, chave de escrita, defasagem das pausas (min)
+  { "mesa", DHT_PIN, LDR_AMBIENTE, THINGSPEAK_CHANNEL_ID, THINGSPEAK_API_KEY, 0 },
+  { "sala_b", 5, 32, THINGSPEAK_CANAL_ZONA_1, THINGSPEAK_CHAVE_ZONA_1, 15 },
+  { "sala_c", 18, 34, THINGSPEAK_CANAL_ZONA_2, THINGSPEAK_CHAVE_ZONA_2, 30 },
+  { "sala_d", 19, 35, THINGSPEAK_CANAL_ZONA_3, THINGSPEAK_CHAVE_ZONA_3, 45 },
+};
+#define TOTAL_ZONAS_TABELA (int)(sizeof(ZONAS) / sizeof(ZONAS[0]))
+static_assert(ZONAS_ATIVAS >= 1 && ZONAS_ATIVAS <= TOTAL_ZONAS_TABELA, "ZONAS_ATIVAS dentro da tabela");
+
+// ==================== PERÍODOS DAS TAREFAS ====================
+#define PERIODO_SENSORIAMENTO 2500        // Leitura dos sensores (ms)
+#define PERIODO_ATUACAO 2500              // LEDs de alerta (ms)
+#define PERIODO_PAUSAS 1000               // Verificação das pausas (ms)
+#define PERIODO_RELATORIO 60000           // Estatísticas do agendador (ms)
+#define PERIODO_LOG 10                    // Escoamento do log para a UART (ms)
+#define DEADLINE_SENSORIAMENTO 50000      // us
+#define DEADLINE_ATUACAO 2000             // us
+#define DEADLINE_PAUSAS 5000              // us
+#define DEADLINE_LOG 500                  // us
+#define DEADLINE_DHT 500                  // us - start ou decodificação, sem esperar o sensor
+#define DEADLINE_ENVIO 2000               // us - o HTTP roda na tarefa de rede
+#define ESPERA_MAXIMA_LOOP 100            // ms de ociosidade por volta do loop()
+
+// ==================== DHT22 ====================
+// O ciclo do DHT (uma transação por zona, em sequência) começa
+// DHT_FOLGA_MS antes do fim previsto, antes de cada leitura dos sensores,
+// que só consulta os caches
+#define DHT_FOLGA_MS 4
+#define IDADE_MAXIMA_DHT 5000             // ms - cache mais velho que isso vira NAN
+static_assert(DHT_DURACAO_TRANSACAO_MS < ENERGIA_SONO_LEVE_MINIMO_MS,
+              "não se dorme no meio da captura das bordas");
+static_assert(PERIODO_SENSORIAMENTO >= DHT_INTERVALO_MINIMO_MS,
+              "uma transação por período de amostragem");
+
+// ==================== TRILHA DOS SENSORES ====================
+// 1 = grava as leituras do DHT e do LDR na flash, para reproduzir a
+// execução no build nativo (trilha_sensores.h). O build nativo grava e
+// reproduz com --gravar / --reproduzir
+#ifndef TRILHA_GRAVAR
+#define TRILHA_GRAVAR 0
+#endif
+#define TRILHA_ARQUIVO "/trilha.bin"
+
+// ==================== TAREFA DE REDE (NÚCLEO 0) ====================
+// WiFi, fila store-and-forward e HTTP rodam no núcleo 0; o loop() do
+// Arduino (sensoriamento e atuação) fica no núcleo 1. As amostras passam
+// de um para o outro por uma fila SPSC sem lock.
+#define NUCLEO_REDE 0
+#define PRIORIDADE_TAREFA_REDE 1
+#define PILHA_TAREFA_REDE 8192            // bytes
+#define PERIODO_TAREFA_REDE 100           // ms
+#define CAPACIDADE_FILA_REDE 8            // Amostras em trânsito entre os núcleos
+
+FilaSPSC<AmostraAgregada, CAPACIDADE_FILA_REDE> filaRede;
+
+// Endpoint local de métricas: tarefa própria no núcleo 0, para um HTTP
+// lento do ThingSpeak não atrasar as raspagens (só no modo acordado)
+#define PRIORIDADE_TAREFA_METRICAS 1
+#define PILHA_TAREFA_METRICAS 4096        // bytes
+
+// Conexão keep-alive com o ThingSpeak, usada só pela tarefa de rede
+ClienteHttpPersistente clienteThingSpeak;
+
+// Nos modos de sono a tarefa de rede avisa quando o núcleo 1 pode dormir:
+// rádio desligado e nada em trânsito
+volatile bool redeOciosa = true;
+// Depois de uma falha de associação. Prazo em 32 bits, comparado em
+// int32_t como no agendador, e armado só quando há espera
+HAL_RETIDO bool sessaoRadioAdiada = false;
+HAL_RETIDO uint32_t proximaSessaoRadioMs = 0;
+
+// Período muda com a amostragem adaptativa
+HAL_RETIDO int idTarefaSensores = -1;
+HAL_RETIDO int idTarefaDht = -1;
+
+// ==================== ÚLTIMA AMOSTRA ====================
+// Compartilhada entre a tarefa de sensoriamento e as de atuação. As
+// variáveis HAL_RETIDO do sketch sobrevivem ao sono profundo
+HAL_RETIDO float temperaturaAtual = NAN;
+HAL_RETIDO float umidadeAtual = NAN;
+HAL_RETIDO int ldrAtual = 0;
+
+// ==================== ESTATÍSTICAS PARA MÉDIAS ====================
+// Cada envio fecha um balde de 15 s das estatísticas em janelas
+static_assert(INTERVALO_ENVIO_THINGSPEAK == ESTATISTICAS_PERIODO_BALDE_MS,
+              "o envio fecha os baldes das estatísticas");
 
 // ==================== SISTEMA DE HORÁRIO VIRTUAL ====================
 #define SEGUNDOS_POR_HORA_VIRTUAL 5  // 5s real = 1h virtual
 #define HORA_INICIAL 7               // Começa às 7:00
-unsigned long inicioSimulacao = 0;
-
-// ==================== CONTROLE DE PAUSAS ====================
-bool pausaCafeTomada = false;
-bool pausaAlmocoTomada = false;
-bool pausaTardeTomada = false;
-bool pausaAlongamentoTomada = false;
+HAL_RETIDO unsigned long inicioSimulacao = 0;
 
 // ==================== CONTADORES PARA THINGSPEAK ====================
-int totalPausasRealizadas = 0;
-int statusPausaAtual = 0; // 0=Sem pausa, 1=Café, 2=Almoço, 3=Tarde, 4=Alongamento
-int alertasAtivos = 0;
-
-// Definições para status de pausa
-#define SEM_PAUSA 0
-#define PAUSA_CAFE 1
-#define PAUSA_ALMOCO 2
-#define PAUSA_TARDE 3
-#define PAUSA_ALONGAMENTO 4
+HAL_RETIDO int alertasAtivos = 0;
+// Status e total de pausas do dia vêm da agenda (agenda_pausas.h)
 
 // ==================== CONTROLE DE ALERTAS VISUAIS ====================
-unsigned long ultimoAlertaVisual = 0;
+HAL_RETIDO unsigned long ultimoAlertaVisual = 0;
 #define INTERVALO_ALERTA_VISUAL 30000  // 30 segundos entre alertas
 
-DHT dht(DHT_PIN, DHT_TYPE);
+// ==================== PROTÓTIPOS ====================
+void agendarLeituraDht(unsigned long periodoMs);
+void tarefaAtuacao();
+void tarefaPausas();
 
 // ==================== FUNÇÕES THINGSPEAK ====================
-void conectarWiFi() {
-  Serial.println("📡 INICIANDO CONEXÃO WiFi PERSSISTENTE");
-  Serial.println("======================================");
-  
-  int tentativas = 0;
-  unsigned long inicioGeral = millis();
-  
-  while (true) {
-    tentativas++;
-    Serial.println("\n🔄 TENTATIVA " + String(tentativas));
-    
-    // Reset da conexão
-    WiFi.disconnect();
-    delay(1000);
-    WiFi.mode(WIFI_STA);
-    
-    Serial.print("   Conectando");
-    unsigned long startTime = millis();
-    
-    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-    
-    bool conectado = false;
-    while (millis() - startTime < 15000) { // 15s por tentativa
-      if (WiFi.status() == WL_CONNECTED) {
-        conectado = true;
-        break;
-      }
-      delay(500);
-      Serial.print(".");
+// Envia um lote das amostras mais antigas da fila pelo endpoint bulk_update
+// (JSON, várias entradas por requisição). Retorna quantas foram aceitas.
+int drenarFilaThingSpeak() {
+  int pendentes = filaTamanho();
+  if (pendentes == 0) {
+    return 0;
+  }
+
+  if (!wifiEstaConectado()) {
+    LOG_INFO("ENVIO", "❌ WiFi não disponível - ", pendentes, " amostras aguardando na fila");
+    return 0;
+  }
+
+  // Um canal por lote: o da zona da amostra mais antiga
+  AmostraAgregada maisAntiga;
+  filaEspiar(0, maisAntiga);
+  uint8_t zona = maisAntiga.zona;
+  if (zona >= zonasTotal() || zonasConfig(zona).canalThingSpeak == nullptr) {
+    // Sobra de uma configuração anterior (fila restaurada da flash)
+    LOG_AVISO("ENVIO", "⚠️ Zona ", (int)zona, " sem canal - amostras descartadas");
+    filaConfirmarEnvioDaZona(zona, pendentes);
+    return 0;
+  }
+  const ConfigZona& destino = zonasConfig(zona);
+
+  // Buffer estático: o corpo do lote não passa pelo heap
+  static BufferTexto<TAMANHO_CORPO_BULK> corpo;
+  corpo.limpar();
+
+  // delta_t = segundos desde a entrada anterior do lote
+  corpo << "{\"write_api_key\":\"" << destino.chaveEscrita << "\",\"updates\":[";
+  unsigned long timestampAnterior = 0;
+  int quantidade = 0;
+  for (int i = 0; i < pendentes && quantidade < LOTE_MAXIMO_THINGSPEAK; i++) {
+    AmostraAgregada a;
+    filaEspiar(i, a);
+    if (a.zona != zona) continue;
+
+    // Diferença com sinal: timestamps restaurados de um reboot podem ter
+    // dado a volta no relógio
+    unsigned long deltaT = 0;
+    long diferenca = (long)(a.timestampMs - timestampAnterior);
+    if (quantidade > 0 && diferenca > 0) {
+      deltaT = (unsigned long)diferenca / 1000;
     }
-    
-    if (conectado) {
-      unsigned long tempoTotal = (millis() - inicioGeral) / 1000;
-      wifiConectado = true;
-      Serial.println("\n🎉 ✅ CONEXÃO ESTABELECIDA!");
-      Serial.println("   📶 IP: " + WiFi.localIP().toString());
-      Serial.println("   📡 RSSI: " + String(WiFi.RSSI()) + " dBm");
-      Serial.println("   ⏱️  Tempo total: " + String(tempoTotal) + " segundos");
-      Serial.println("   🔄 Tentativas: " + String(tentativas));
-      Serial.println("======================================\n");
-      break;
-    } else {
-      Serial.println("\n❌ Falha na tentativa " + String(tentativas));
-      
-      // Progresso a cada 5 tentativas
-      if (tentativas % 5 == 0) {
-        Serial.println("💡 Dica: Verifique se o Wokwi está respondendo");
-      }
-      
-      Serial.println("🔄 Nova tentativa em 5 segundos...");
-      delay(5000); // Espera 5 segundos entre tentativas
+    timestampAnterior = a.timestampMs;
+
+    if (quantidade++ > 0) corpo << "},";
+    corpo << "{\"delta_t\":" << deltaT;
+    corpo << ",\"field" << FIELD_TEMPERATURA << "\":" << Decimal(a.temperatura, 1);
+    corpo << ",\"field" << FIELD_UMIDADE << "\":" << Decimal(a.umidade, 1);
+    corpo << ",\"field" << FIELD_LUMINOSIDADE << "\":" << a.luminosidade;
+    corpo << ",\"field" << FIELD_SCORE_SAUDE << "\":" << a.score;
+  }
+  if (zona == 0) {
+    ResumoSaude saude = saudeResumo();
+    corpo << ",\"field" << FIELD_TICK_MAX_US << "\":" << (unsigned long)saude.tickMaxUs;
+    corpo << ",\"field" << FIELD_ENVIO_MAX_MS << "\":" << (unsigned long)saude.envioMaxMs;
+    corpo << ",\"field" << FIELD_HEAP_MINIMO << "\":" << (unsigned long)saude.heapMinimo;
+    if (saude.rssi != 0) corpo << ",\"field" << FIELD_RSSI << "\":" << saude.rssi;
+  }
+  corpo << "}]}";
+
+  if (corpo.foiTruncado()) {
+    LOG_ERRO("ENVIO", "🚨 Lote maior que TAMANHO_CORPO_BULK - envio cancelado");
+    return 0;
+  }
+
+  LOG_INFO("ENVIO", "🌐 Enviando lote de ", quantidade, " amostras (", destino.nome,
+           ") para ThingSpeak...");
+
+  BufferTexto<64> caminho;
+  caminho << "/channels/" << destino.canalThingSpeak << "/bulk_update.json";
+
+  unsigned long inicio = halMillis();
+  int httpCode = clienteThingSpeak.post(caminho.c_str(), "application/json",
+                                        (const uint8_t*)corpo.c_str(), corpo.tamanho());
+  unsigned long duracao = halMillis() - inicio;
+
+  const TemposRequisicaoHttp& tempos = clienteThingSpeak.ultimosTempos();
+  LOG_DEBUG("ENVIO", "   ⏱️  conexão=", tempos.conexaoUs, "us envio=", tempos.envioUs,
+                "us espera=", tempos.esperaUs, "us leitura=", tempos.leituraUs, "us",
+                tempos.conexaoReaproveitada ? " (keep-alive)" : " (nova conexão)");
+
+  // O bulk_update responde 202 Accepted
+  if (httpCode == 200 || httpCode == 202) {
+    filaConfirmarEnvioDaZona(zona, quantidade);
+    if (zona == 0) saudeNovoIntervalo();
+    LOG_INFO("ENVIO", "✅ Lote enviado! ", quantidade, " amostras em ", duracao, " ms");
+    if (filaTamanho() > 0) {
+      LOG_INFO("ENVIO", "   📦 Restam ", filaTamanho(), " na fila");
     }
+    return quantidade;
+  }
+
+  if (httpCode > 0) {
+    LOG_ERRO("ENVIO", "❌ Erro HTTP: ", httpCode);
+  } else {
+    LOG_ERRO("ENVIO", "❌ Falha na conexão");
   }
+  return 0;
 }
 
-int contarAlertasAtivos(float temperatura, float umidade, int horaVirtual, bool escuro) {
-  int count = 0;
-  
-  // Alertas de temperatura
-  if (temperatura > 28.0 || temperatura < 18.0) count++;
-  
-  // Alertas de umidade
-  if (umidade > 70.0 || umidade < 30.0) count++;
-  
-  // Alertas de iluminação
-  if (escuro && horaVirtual >= 8 && horaVirtual <= 17) count++;
-  if (!escuro && (horaVirtual >= 20 || horaVirtual < 6)) count++;
-  
-  return count;
+void fecharThingSpeak() {
+  clienteThingSpeak.fechar();
 }
 
-void enviarParaThingSpeak(float temperatura, float umidade, int luminosidade, int score) {
-  if (!wifiConectado || WiFi.status() != WL_CONNECTED) {
-    Serial.println("❌ WiFi não disponível para envio");
-    return;
+bool zonaTemCanalThingSpeak(int zona) {
+  return zonasConfig(zona).canalThingSpeak != nullptr;
+}
+
+// Alerta crítico como uma atualização só com o "status" do canal da zona:
+// os campos 1-4 continuam sendo só as médias
+bool alertarThingSpeak(const EventoAlerta& evento) {
+  // Espera armada só depois de uma recusa; prazo em 32 bits, como no
+  // agendador (no ESP32 o long também tem 32 e um prazo zerado ficaria
+  // "no futuro" depois de ~24,8 dias ligado)
+  static bool esperandoNovaTentativa = false;
+  static uint32_t proximaTentativaMs = 0;
+  if (esperandoNovaTentativa) {
+    if ((int32_t)((uint32_t)halMillis() - proximaTentativaMs) < 0) return false;
+    esperandoNovaTentativa = false;
   }
-  
-  HTTPClient http;
-  
+
+  BufferTexto<192> corpo;
+  corpo << "{\"api_key\":\"" << zonasConfig(evento.zona).chaveEscrita << "\",\"status\":\"";
+  alertasDescrever(evento, corpo);
+  corpo << "\"}";
+
+  int httpCode = clienteThingSpeak.post(THINGSPEAK_CAMINHO_ALERTA, "application/json",
+                                        (const uint8_t*)corpo.c_str(), corpo.tamanho());
+  // Atualização recusada pelo limite de taxa do canal: 200 com corpo "0"
+  if ((httpCode == 200 || httpCode == 202) && strcmp(clienteThingSpeak.resposta(), "0") != 0) {
+    LOG_INFO("ENVIO", "🚨 Alerta ", (unsigned int)evento.sequencia, " entregue ao ThingSpeak");
+    alertasConfirmar(evento.sequencia);
+    return true;
+  }
+  LOG_ERRO("ENVIO", "❌ Alerta ", (unsigned int)evento.sequencia, " recusado (HTTP ", httpCode, ")");
+  proximaTentativaMs = (uint32_t)(halMillis() + ALERTA_ESPERA_NOVA_TENTATIVA_MS);
+  esperandoNovaTentativa = true;
+  return false;
+}
+
+// ==================== DESTINOS DA TELEMETRIA ====================
+const DestinoTelemetria DESTINOS[] = {
+  // nome, drenar, processar, fechar, aceita a zona, intervalo entre rodadas, alertas
+  { "thingspeak", drenarFilaThingSpeak, nullptr, fecharThingSpeak, zonaTemCanalThingSpeak,
+    INTERVALO_ENVIO_THINGSPEAK, alertarThingSpeak },
+  { "mqtt", mqttDrenarFila, mqttProcessar, mqttFechar, mqttAceitaZona, 0, mqttAlertar },
+};
+#define TOTAL_DESTINOS (int)(sizeof(DESTINOS) / sizeof(DESTINOS[0]))
+
+void enviarParaThingSpeak(float temperatura, float umidade, int luminosidade, int score, uint8_t zona = 0) {
   // 👇 VALIDAÇÃO DOS VALORES
   if (luminosidade == 0) {
     luminosidade = 1; // Substituir 0 por 1 para evitar erro
@@ -152,441 +361,627 @@ void enviarParaThingSpeak(float temperatura, float umidade, int luminosidade, in
   
   // Verificar se há valores inválidos
   if (isnan(temperatura) || isnan(umidade)) {
-    Serial.println("🚨 VALORES INVÁLIDOS DETECTADOS!");
+    LOG_ERRO("ENVIO", "🚨 VALORES INVÁLIDOS DETECTADOS!");
     return;
   }
   
-  String url = "http://api.thingspeak.com/update";
-  url += "?api_key=" + String(THINGSPEAK_API_KEY);
-  url += "&field" + String(FIELD_TEMPERATURA) + "=" + String(temperatura, 1);
-  url += "&field" + String(FIELD_UMIDADE) + "=" + String(umidade, 1);
-  url += "&field" + String(FIELD_LUMINOSIDADE) + "=" + String(luminosidade);
-  url += "&field" + String(FIELD_SCORE_SAUDE) + "=" + String(score);
-  
-  Serial.println("🌐 Enviando dados para ThingSpeak...");
-  Serial.println("   📊 Dados enviados (MÉDIAS):");
-  Serial.println("   🌡️  Temperatura: " + String(temperatura, 1) + "°C");
-  Serial.println("   💧 Umidade: " + String(umidade, 1) + "%");
-  Serial.println("   💡 Luminosidade: " + String(luminosidade));
-  Serial.println("   🏆 Score: " + String(score));
-  
-  http.begin(url);
-  int httpCode = http.GET();
-  
-  if (httpCode > 0) {
-    if (httpCode == HTTP_CODE_OK) {
-      String resposta = http.getString();
-      Serial.println("✅ Dados enviados!");
-    } else {
-      Serial.println("❌ Erro HTTP: " + String(httpCode));
+  LOG_DEBUG("ENVIO", "   📊 Dados para envio (MÉDIAS):");
+  LOG_DEBUG("ENVIO", "   🌡️  Temperatura: ", Decimal(temperatura, 1), "°C");
+  LOG_DEBUG("ENVIO", "   💧 Umidade: ", Decimal(umidade, 1), "%");
+  LOG_DEBUG("ENVIO", "   💡 Luminosidade: ", luminosidade);
+  LOG_DEBUG("ENVIO", "   🏆 Score: ", score);
+
+  trilhaSaida("envio z=", (int)zona, " t=", Decimal(temperatura, 1), " u=", Decimal(umidade, 1),
+              " l=", luminosidade, " s=", score);
+
+  // Entrega para o núcleo de rede; o HTTP nunca bloqueia o sensoriamento
+  AmostraAgregada amostra = { halMillis(), temperatura, umidade, luminosidade, score, zona };
+  if (!filaRede.inserir(amostra)) {
+    LOG_AVISO("ENVIO", "⚠️ Fila entre núcleos cheia - amostra descartada");
+  }
+}
+
+// Modos de sono: o rádio liga quando há um lote (ou uma amostra velha) na
+// fila, ou um alerta crítico, e desliga assim que tudo sai. Sem AP,
+// desliga e tenta de novo depois do backoff do WiFi.
+void gerenciarRadio() {
+  unsigned long agora = halMillis();
+  EstadoWiFi estadoWiFi = wifiEstado();
+
+  if (estadoWiFi == WIFI_DESLIGADO) {
+    AmostraAgregada maisAntiga;
+    // Lote mínimo por zona: com várias zonas a fila enche mais rápido
+    bool envioDevido = alertasPendentes() > 0 ||
+                       filaTamanho() >= ENERGIA_AMOSTRAS_POR_CONEXAO * zonasTotal() ||
+                       (filaEspiar(0, maisAntiga) && agora - maisAntiga.timestampMs >= ENERGIA_ESPERA_MAXIMA_ENVIO_MS);
+    if (sessaoRadioAdiada && (int32_t)((uint32_t)agora - proximaSessaoRadioMs) >= 0) {
+      sessaoRadioAdiada = false;
     }
-  } else {
-    Serial.println("❌ Falha na conexão");
+    if (envioDevido && !sessaoRadioAdiada) {
+      wifiLigar();
+    }
+  } else if (estadoWiFi == WIFI_AGUARDANDO_BACKOFF) {
+    proximaSessaoRadioMs = (uint32_t)(agora + wifiEstatisticas().backoffAtualMs);
+    sessaoRadioAdiada = true;
+    wifiDesligar();
+  } else if (estadoWiFi == WIFI_CONECTADO && filaTamanho() == 0 && alertasPendentes() == 0) {
+    // O socket não sobrevive ao rádio desligado
+    telemetriaDestino().fechar();
+    wifiDesligar();
   }
-  
-  http.end();
 }
 
-// ==================== SISTEMA DE SCORING INTELIGENTE ====================
-int calcularScoreSaudeAmbiental(float temp, float umidade, int hora, bool escuro) {
-  int score = 100; // Score perfeito
-  
-  // Penalidades por condições ruins
-  if (temp > 28.0 || temp < 18.0) score -= 30;
-  if (umidade > 70.0 || umidade < 30.0) score -= 25;
-  
-  // Condições de iluminação inadequadas
-  if (escuro && hora >= 8 && hora <= 17) {
-    score -= 20; // Ambiente escuro durante expediente
+// Um passo da tarefa de rede, chamado a cada PERIODO_TAREFA_REDE no núcleo 0.
+// Única dona do WiFi, da fila store-and-forward e do destino da telemetria.
+void passoTarefaRede() {
+  static unsigned long ultimoEnvio = 0;
+  static bool primeiroEnvio = true;
+
+  wifiProcessar();
+
+  // Store-and-forward: a amostra entra na fila antes de qualquer tentativa
+  // de rede, então uma queda do WiFi não abre buraco no canal
+  bool chegouAmostra = false;
+  AmostraAgregada amostra;
+  while (filaRede.retirar(amostra)) {
+    historicoRegistrar(amostra);
+    filaEnfileirar(amostra);
+    chegouAmostra = true;
   }
-  if (!escuro && (hora >= 20 || hora < 6)) {
-    score -= 15; // Luz intensa durante a noite
+  trilhaEscoar();   // A flash é desta tarefa: a trilha do núcleo 1 grava aqui
+  alertasReceber();
+
+  // Confirmações e keep-alive do destino (MQTT)
+  const DestinoTelemetria& destino = telemetriaDestino();
+  if (destino.processar != nullptr && wifiEstaConectado()) {
+    destino.processar();
+  }
+
+  // Alertas críticos passam na frente dos lotes e do intervalo da API
+  if (alertasPendentes() > 0 && wifiEstaConectado()) {
+    alertasEnviar();
+  }
+
+  // Amostra nova envia na hora; backlog é drenado no ritmo da API. O
+  // limite do ThingSpeak é por canal: um lote de cada zona por vez
+  bool intervaloCumprido = primeiroEnvio || halMillis() - ultimoEnvio >= destino.intervaloLotesMs;
+  if (filaTamanho() > 0 && wifiEstaConectado() && (chegouAmostra || intervaloCumprido)) {
+    saudeAmostrarRede();
+    unsigned long inicioEnvio = halMillis();
+    PERFIL_INICIO(inicio);
+    for (int lote = 0; lote < zonasTotal() && filaTamanho() > 0; lote++) {
+      if (destino.drenar() == 0) break;
+    }
+    PERFIL_FIM(ESTAGIO_REDE, inicio);
+    saudeRegistrar(SAUDE_ENVIO, halMillis() - inicioEnvio);
+    ultimoEnvio = halMillis();
+    primeiroEnvio = false;
   }
 
-  return max(score, 0); // Não menor que 0
+  if (energiaModo() != ENERGIA_ACORDADO) {
+    gerenciarRadio();
+    if (wifiEstado() == WIFI_DESLIGADO) {
+      // A fila em RAM não sobrevive ao sono profundo
+      if (energiaModo() == ENERGIA_SONO_PROFUNDO) filaPersistirPendentes();
+      redeOciosa = filaRede.profundidade() == 0 && trilhaBlocosPendentes() == 0 && !alertasEmTransito();
+    } else {
+      redeOciosa = false;
+    }
+  }
 }
 
-void tomarDecisaoAmbiental(int score, float temp, float umidade, int hora, bool escuro) {
-  Serial.println("📊 SCORE AMBIENTAL: " + String(score) + "/100");
+// ==================== SISTEMA DE SCORING INTELIGENTE ====================
+// Score, alertas e recomendações saem da máscara de violações calculada
+// uma vez por amostra pela tabela de regras_ambiente.h (zonas.h avalia
+// todas as zonas de uma vez; aqui fica a da zona 0)
+HAL_RETIDO MascaraViolacoes violacoesAtuais = 0;
+
+void tomarDecisaoAmbiental(int score, MascaraViolacoes violacoes) {
+  LOG_DEBUG("DECISAO", "📊 SCORE AMBIENTAL: ", score, "/100");
   
-  if (score >= 85) {
-    Serial.println("✅ Ambiente IDEAL para produtividade!");
+  if (score >= SCORE_MINIMO_IDEAL) {
+    LOG_DEBUG("DECISAO", "✅ Ambiente IDEAL para produtividade!");
   } 
-  else if (score >= 60) {
-    Serial.println("⚠️ Ambiente REGULAR - pequenos ajustes necessários");
-    if (temp > 28.0) Serial.println("   🎯 Ação: Ventilar ambiente ou ajustar Ar Condicionado");
-    if (umidade > 70.0) Serial.println("   🌬️ Ação: Ventilar para reduzir umidade");
-    if (umidade < 30.0) Serial.println("   💧 Ação: Usar umidificador");
-
-    if (escuro && hora >= 8 && hora <= 17) Serial.println("   💡 Ação: Deixe o lugar mais iluminado, de preferência para luz natural do dia");
-    if (!escuro && (hora >= 20 || hora < 6)) Serial.println("   🌙 Ação: Reduzir iluminação para descanso");
+  else if (score >= SCORE_MINIMO_REGULAR) {
+    LOG_INFO("DECISAO", "⚠️ Ambiente REGULAR - pequenos ajustes necessários");
+    for (int i = 0; i < TOTAL_REGRAS; i++) {
+      if (violacoes & (1u << i)) LOG_INFO("DECISAO", "   ", regra(i).acaoRegular);
+    }
   }
   else {
-    Serial.println("🚨 Ambiente CRÍTICO - ajustes urgentes necessários!");
-    if (temp > 28.0) Serial.println("   🔥 Ação Imediata: Resfriar ambiente");
-    if (temp < 18.0) Serial.println("   ❄️ Ação Imediata: Aquecer ambiente");
-    if (umidade > 70.0) Serial.println("   💦 Ação Imediata: Reduzir umidade");
-    if (umidade < 30.0) Serial.println("   🏜️ Ação Imediata: Aumentar umidade");
-    if (escuro && hora >= 8 && hora <= 17) Serial.println("   💡 Ação Imediata: ILUMINAÇÃO INADEQUADA - Acender luzes!");
-    if (!escuro && (hora >= 20 || hora < 6)) Serial.println("   🌙 Ação Imediata: LUZ EXCESSIVA - Reduzir iluminação!");
+    LOG_AVISO("DECISAO", "🚨 Ambiente CRÍTICO - ajustes urgentes necessários!");
+    for (int i = 0; i < TOTAL_REGRAS; i++) {
+      if (violacoes & (1u << i)) LOG_AVISO("DECISAO", "   ", regra(i).acaoCritica);
+    }
   }
 }
 
 // ==================== FUNÇÕES DE TEMPO VIRTUAL ====================
+// Minutos virtuais absolutos: dia * 1440 + minuto do dia
+unsigned long getMinutosVirtuais() {
+  unsigned long msDesdeInicio = halMillis() - inicioSimulacao;
+  return HORA_INICIAL * 60UL + msDesdeInicio * 60 / (SEGUNDOS_POR_HORA_VIRTUAL * 1000UL);
+}
+
 int getHoraVirtual() {
-  unsigned long segundosDesdeInicio = (millis() - inicioSimulacao) / 1000;
-  return ((segundosDesdeInicio / SEGUNDOS_POR_HORA_VIRTUAL) + HORA_INICIAL) % 24;
+  return (getMinutosVirtuais() / 60) % 24;
 }
 
 int getMinutoVirtual() {
-  unsigned long segundosDesdeInicio = (millis() - inicioSimulacao) / 1000;
-  return (segundosDesdeInicio % 60);
+  return getMinutosVirtuais() % 60;
 }
 
-String getHorarioFormatado() {
+BufferTexto<8> getHorarioFormatado() {
   int hora = getHoraVirtual();
   int minuto = getMinutoVirtual();
-  return String(hora) + ":" + (minuto < 10 ? "0" : "") + String(minuto);
+  BufferTexto<8> horario;
+  horario << hora << ":" << (minuto < 10 ? "0" : "") << minuto;
+  return horario;
 }
 
 void tocarAlertaSuave() {
-  tone(BUZZER_PIN, 1000, 200);
+  halTocar(BUZZER_PIN, 1000, 200);
 }
 
-// ==================== FUNÇÕES LDR ============================
-
-bool ambienteEstaEscuro() {
-  int valorLDR = lerLDR(); // Usar a função com filtro
-  
-  // Threshold mais realista - ajuste conforme necessário
-  return (valorLDR < 100); // Considera escuro se valor for menor que 100
+// Mais agudo e mais longo que o das pausas, para não confundir
+void tocarAlertaCritico() {
+  halTocar(BUZZER_PIN, 2500, 600);
 }
 
-int lerLDR() {
-  // Fazer múltiplas leituras para evitar ruído do WiFi
-  int leitura1 = analogRead(LDR_AMBIENTE);
-  delay(5);
-  int leitura2 = analogRead(LDR_AMBIENTE);
-  delay(5);
-  int leitura3 = analogRead(LDR_AMBIENTE);
-  
-  // Calcular média
-  int media = (leitura1 + leitura2 + leitura3) / 3;
-  
-  // Se for 0 (provavelmente erro), retornar um valor mínimo
-  if (media == 0) {
-    return 1; // Retorna 1 em vez de 0
+// ==================== LEDS DE ALERTA ====================
+static const int pinoDaSaida[TOTAL_SAIDAS] = {
+  LED_VERMELHO,             // SAIDA_LED_TEMPERATURA
+  LED_AZUL,                 // SAIDA_LED_UMIDADE
+  LED_ALERTA_ESCURO_DIA,    // SAIDA_LED_ESCURO
+  LED_ALERTA_CLARO_NOITE    // SAIDA_LED_CLARO
+};
+
+void controlarLEDsAlerta(MascaraViolacoes violacoes) {
+  for (int s = 0; s < TOTAL_SAIDAS; s++) {
+    halEscreverDigital(pinoDaSaida[s], regrasSaidaAtiva(violacoes, (SaidaAlerta)s) ? HIGH : LOW);
   }
-  
-  return media;
-}
-
-void verificarIluminacaoBinaria(int horaVirtual) {
-  int valorLDR = lerLDR(); // Usar a função com filtro
-  
-  // Definir thresholds mais realistas
-  bool estaEscuro = (valorLDR < 100);   // Ajuste conforme seu LDR
-  bool estaClaro = (valorLDR > 2000);   // Ajuste conforme seu LDR
-  
-  if (estaClaro) {
-    
-    if (horaVirtual >= 20 || horaVirtual < 6) {
-      digitalWrite(LED_ALERTA_CLARO_NOITE, HIGH);
-    } else {
-      digitalWrite(LED_ALERTA_CLARO_NOITE, LOW);
+  for (int i = 0; i < TOTAL_REGRAS; i++) {
+    if ((violacoes & (1u << i)) && regra(i).mensagemLed != nullptr) {
+      LOG_INFO("LED", regra(i).mensagemLed);
     }
-  } 
-  
-  if (estaEscuro) {
-    
-    if (horaVirtual >= 8 && horaVirtual <= 17) {
-      digitalWrite(LED_ALERTA_ESCURO_DIA, HIGH);
-    } else {
-      digitalWrite(LED_ALERTA_ESCURO_DIA, LOW);
-    }
-  }
-  
-  // Garantir que LEDs são apagados quando não há alerta
-  if (!estaEscuro) {
-    digitalWrite(LED_ALERTA_ESCURO_DIA, LOW);
-  }
-  if (!estaClaro) {
-    digitalWrite(LED_ALERTA_CLARO_NOITE, LOW);
   }
 }
 
-// ==================== FUNÇÕES DE SENSORES ====================
-void lerSensoresAmbiente() {
-  float temperature = dht.readTemperature();
-  float humidity = dht.readHumidity();
-  
-  if (isnan(temperature) || isnan(humidity)) {
-    Serial.println("❌ Erro na leitura do DHT22!");
-    return;
+// ==================== ALERTAS CRÍTICOS ====================
+// Reação local na própria amostra da transição (núcleo 1): LEDs na hora,
+// sem esperar a tarefa de atuação, e buzzer na entrada da faixa crítica.
+// Só a zona 0 tem LEDs e buzzer
+void reagirAlertaCritico(const EventoAlerta& evento) {
+  if (trilhaRegistrandoSaidas()) {
+    BufferTexto<64> descricao;
+    alertasDescrever(evento, descricao);
+    trilhaSaida("alerta z=", (int)evento.zona, " ", descricao.c_str());
   }
-  
-  Serial.println("🌡️ Temperatura: " + String(temperature) + "°C");
-  Serial.println("💧 Umidade: " + String(humidity) + "%");
-  
-  controlarLEDsAmbiente(temperature, humidity);
+  if (evento.zona != 0) return;
+  controlarLEDsAlerta(violacoesAtuais);
+  if (alertaEhEntrada(evento)) tocarAlertaCritico();
 }
 
-void controlarLEDsAmbiente(float temperature, float humidity) {
-  // Controlar LED VERMELHO (Temperatura alta > 28°C OU baixa < 18°C)
-  if (temperature > 28.0 || temperature < 18.0) {
-    digitalWrite(LED_VERMELHO, HIGH);
-    if (temperature > 28.0) {
-      Serial.println("🔴 Temperatura ALTA - Verificar ambiente");
-    } else {
-      Serial.println("🔴 Temperatura BAIXA - Verificar ambiente");
-    }
-  } else {
-    digitalWrite(LED_VERMELHO, LOW);
+// ==================== FUNÇÕES DE PAUSAS PROGRAMADAS ====================
+// Texto de cada tipo de evento da agenda; o horário vem do evento
+struct AnuncioEvento {
+  const char* moldura;      // nullptr = sem moldura
+  const char* titulo;
+  const char* linhas[4];
+};
+
+static const AnuncioEvento anuncios[TOTAL_TIPOS_EVENTO] = {
+  { nullptr, "", {} },
+  { "☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕", "🕘 PAUSA DO CAFÉ - ",
+    { "💡 Tome um café e alongue os pulsos", "👋 Cumprimente os colegas",
+      "🌅 Aproveite para se hidratar" } },
+  { "🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️", "🕛 HORA DO ALMOÇO - ",
+    { "💡 Afaste-se completamente da tela", "🍎 Alimente-se de forma saudável",
+      "🚶‍♂️ Dê uma volta após comer", "😴 Descanse a mente do trabalho" } },
+  { "🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞", "🕒 PAUSA DA TARDE - ",
+    { "💡 Revitalize-se para o final do dia", "👀 Descanse os olhos",
+      "💧 Beba água para manter a hidratação", "🎵 Ouça uma música para relaxar" } },
+  { nullptr, "🧘‍♂️ MICRO-PAUSA: Alongue costas e pescoço - ",
+    { "💫 2 minutos para prevenir LER/DORT" } },
+  { nullptr, "🌅 BOM DIA! - Tenha um dia produtivo! ", {} },
+  { nullptr, "🏠 FIM DO EXPEDIENTE - Descanse e recarregue as energias! ", {} },
+};
+
+void anunciarEvento(const EventoAgenda& evento) {
+  const AnuncioEvento& a = anuncios[evento.tipo];
+  const char* tag = agendaEhPausa(evento.tipo) ? "PAUSA" : "DIA";
+
+  if (evento.tipo == PAUSA_ALONGAMENTO) {
+    halTocar(BUZZER_PIN, 600, 200);
+  } else if (agendaEhPausa(evento.tipo)) {
+    tocarAlertaSuave();
   }
-  
-  // Controlar LED AZUL (Umidade alta > 70% OU baixa < 30%)
-  if (humidity > 70.0 || humidity < 30.0) {
-    digitalWrite(LED_AZUL, HIGH);
-    if (humidity > 70.0) {
-      Serial.println("🔵 Umidade ALTA - Verificar ambiente");
-    } else {
-      Serial.println("🔵 Umidade BAIXA - Verificar ambiente");
-    }
-  } else {
-    digitalWrite(LED_AZUL, LOW);
+
+  BufferTexto<8> horario;
+  int minuto = evento.minutoDoDia % 60;
+  horario << evento.minutoDoDia / 60 << ":" << (minuto < 10 ? "0" : "") << minuto;
+  trilhaSaida("agenda ", (int)evento.tipo, " ", horario.c_str());
+
+  if (a.moldura) LOG_INFO(tag, a.moldura);
+  LOG_INFO(tag, a.titulo, horario.c_str());
+  for (const char* linha : a.linhas) {
+    if (linha) LOG_INFO(tag, linha);
   }
+  if (a.moldura) LOG_INFO(tag, a.moldura);
 }
 
-// ==================== FUNÇÕES DE PAUSAS PROGRAMADAS ====================
-void verificarPausaCafe(int horaVirtual) {
-  if (horaVirtual == 9 && !pausaCafeTomada) {
-    tocarAlertaSuave();
-    Serial.println("☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕");
-    Serial.println("🕘 PAUSA DO CAFÉ - 9:00");
-    Serial.println("💡 Tome um café e alongue os pulsos");
-    Serial.println("👋 Cumprimente os colegas");
-    Serial.println("🌅 Aproveite para se hidratar");
-    Serial.println("☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕☕");
-    
-    // ⭐ NOVO: Atualizar dados para ThingSpeak
-    totalPausasRealizadas++;
-    statusPausaAtual = PAUSA_CAFE;
-    
-    pausaCafeTomada = true;
-  } else if (horaVirtual != 9 && pausaCafeTomada) {
-    statusPausaAtual = SEM_PAUSA;
+// ==================== LOG DE SAÍDAS ====================
+// Uma linha por mudança do resultado de cada zona (trilha_sensores.h)
+void registrarSaidasZonas() {
+  static uint8_t ultimoScore[MAX_ZONAS];
+  static MascaraViolacoes ultimasViolacoes[MAX_ZONAS];
+  static TipoEventoAgenda ultimaPausa[MAX_ZONAS];
+  static bool registrada[MAX_ZONAS];
+  if (!trilhaRegistrandoSaidas()) return;
+
+  const ArmazemZonas& zonas = zonasArmazem();
+  for (int z = 0; z < zonas.total; z++) {
+    if (registrada[z] && zonas.score[z] == ultimoScore[z] && zonas.violacoes[z] == ultimasViolacoes[z] &&
+        zonas.statusPausa[z] == ultimaPausa[z]) {
+      continue;
+    }
+    registrada[z] = true;
+    ultimoScore[z] = zonas.score[z];
+    ultimasViolacoes[z] = zonas.violacoes[z];
+    ultimaPausa[z] = zonas.statusPausa[z];
+    trilhaSaida("zona ", z, " score=", (int)zonas.score[z], " violacoes=", (int)zonas.violacoes[z],
+                " pausa=", (int)zonas.statusPausa[z]);
   }
 }
 
-void verificarPausaAlmoco(int horaVirtual) {
-  if (horaVirtual == 12 && !pausaAlmocoTomada) {
-    tocarAlertaSuave();
-    Serial.println("🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️");
-    Serial.println("🕛 HORA DO ALMOÇO - 12:00");
-    Serial.println("💡 Afaste-se completamente da tela");
-    Serial.println("🍎 Alimente-se de forma saudável");
-    Serial.println("🚶‍♂️ Dê uma volta após comer");
-    Serial.println("😴 Descanse a mente do trabalho");
-    Serial.println("🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️ 🍽️");
+// ==================== FUNÇÃO PRINCIPAL DO SISTEMA ====================
+// Tarefa de sensoriamento: lê, pontua e acumula uma amostra
+void executarSistemaWellWork() {
+  uint32_t inicioSaude = saudeMarca();
+  energiaMarcarAmostra();
+  heapInicioTick();
+  perfilInicioTick();
+  PERFIL_INICIO(inicioTick);
+
+  // Obter horário atual
+  BufferTexto<8> horarioAtual = getHorarioFormatado();
+  int horaVirtual = getHoraVirtual();
+
+  // Um valor por LDR e por tick: mediana + IIR das conversões que o ADC
+  // acumulou em segundo plano desde o tick anterior (o ruído do WiFi sai
+  // na mediana)
+  uint32_t inicioLeitura = saudeMarca();
+  PERFIL_INICIO(inicioLdr);
+  luzAmostrar();
+  PERFIL_FIM(ESTAGIO_LDR, inicioLdr);
+
+  LOG_DEBUG("TICK", "🕐 HORÁRIO VIRTUAL: ", horarioAtual.c_str(), "h");
+  
+  // Ler sensores de ambiente (as transações já terminaram: só os caches)
+  PERFIL_INICIO(inicioDht);
+  zonasLerSensores(IDADE_MAXIMA_DHT);
+  PERFIL_FIM(ESTAGIO_DHT, inicioDht);
+  saudeRegistrarDesde(SAUDE_LEITURA, inicioLeitura);
+
+  // Uma avaliação da tabela por amostra, para todas as zonas. Com o DHT
+  // em falha os alertas de temperatura/umidade ficam como estavam
+  PERFIL_INICIO(inicioScore);
+  zonasAvaliar(horaVirtual, (uint16_t)(getMinutosVirtuais() % MINUTOS_POR_DIA));
+  PERFIL_FIM(ESTAGIO_SCORE, inicioScore);
+  registrarSaidasZonas();
+
+  // Daqui em diante, a zona 0 (a do kit)
+  const ArmazemZonas& zonas = zonasArmazem();
+  float temperatura = zonas.temperatura[0];
+  float umidade = zonas.umidade[0];
+  int valorLDR = (int)zonas.luminosidade[0];
+  MascaraViolacoes violacoes = zonas.violacoes[0];
+  int score = zonas.score[0];
+  bool dhtValido = !isnan(temperatura) && !isnan(umidade);
+  violacoesAtuais = violacoes;
+  alertasAtivos = zonas.alertas[0];
+
+  // Caminho rápido dos alertas críticos: a amostra crua, sem a média de
+  // 15 s que poderia esconder o pico
+  alertasAvaliar((uint32_t)halMicros());
+
+  temperaturaAtual = temperatura;
+  umidadeAtual = umidade;
+  ldrAtual = valorLDR;
+  
+  if (dhtValido) {
+    LOG_DEBUG("TICK", "🌡️ Temperatura: ", temperatura, "°C");
+    LOG_DEBUG("TICK", "💧 Umidade: ", umidade, "%");
+    LOG_DEBUG("TICK", "💡 LDR: ", valorLDR);
     
-    totalPausasRealizadas++;
-    statusPausaAtual = PAUSA_ALMOCO;
+    // ========== SISTEMA DE SCORING INTELIGENTE ==========
+    PERFIL_INICIO(inicioDecisao);
+    tomarDecisaoAmbiental(score, violacoes);
+    PERFIL_FIM(ESTAGIO_DECISAO, inicioDecisao);
     
-    pausaAlmocoTomada = true;
-  } else if (horaVirtual != 12 && pausaAlmocoTomada) {
-    statusPausaAtual = SEM_PAUSA;
+    // ⭐⭐ ACUMULAR VALORES NAS JANELAS ==========
+    estatisticasAdicionar(METRICA_TEMPERATURA, temperatura);
+    estatisticasAdicionar(METRICA_UMIDADE, umidade);
+    estatisticasAdicionar(METRICA_LUMINOSIDADE, valorLDR);
+    estatisticasAdicionar(METRICA_SCORE, score);
+  }
+  
+  // Separador
+  LOG_DEBUG("TICK", "--------------------------------------------");
+
+  // Ambiente parado: próxima leitura mais tarde; mudança: volta ao período base
+  unsigned long periodo = adaptativoAvaliarAmostra(temperatura, umidade, valorLDR, violacoes);
+  agendadorAlterarPeriodo(idTarefaSensores, periodo);
+  agendarLeituraDht(periodo);
+
+  // Nos modos de sono a atuação e as pausas vão junto com a leitura, em vez
+  // de acordar a CPU por conta própria
+  if (energiaModo() != ENERGIA_ACORDADO) {
+    tarefaAtuacao();
+    tarefaPausas();
   }
+
+  // Foto para o endpoint de métricas: o núcleo 0 monta as respostas
+  metricasCapturar();
+
+  PERFIL_FIM(ESTAGIO_TICK, inicioTick);
+  perfilFimTick();
+  heapFimTick();
+  saudeRegistrarDesde(SAUDE_TICK, inicioSaude);
 }
 
-void verificarPausaTarde(int horaVirtual) {
-  if (horaVirtual == 15 && !pausaTardeTomada) {
-    tocarAlertaSuave();
-    Serial.println("🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞");
-    Serial.println("🕒 PAUSA DA TARDE - 15:00");
-    Serial.println("💡 Revitalize-se para o final do dia");
-    Serial.println("👀 Descanse os olhos");
-    Serial.println("💧 Beba água para manter a hidratação");
-    Serial.println("🎵 Ouça uma música para relaxar");
-    Serial.println("🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞🌞");
-    
-    totalPausasRealizadas++;
-    statusPausaAtual = PAUSA_TARDE;
-    
-    pausaTardeTomada = true;
-  } else if (horaVirtual != 15 && pausaTardeTomada) {
-    statusPausaAtual = SEM_PAUSA;
-  }
+// ==================== TAREFAS DO AGENDADOR ====================
+// Start do DHT e, DHT_DURACAO_TRANSACAO_MS depois, a coleta do quadro
+void tarefaDht() {
+  unsigned long proximaMs = dhtProcessar();
+  if (proximaMs > 0) agendadorReagendar(idTarefaDht, proximaMs);
 }
 
-void verificarMicroPausaAlongamento(int horaVirtual, int minutoVirtual) {
-  if ((horaVirtual == 10 && minutoVirtual >= 30) || 
-      (horaVirtual == 14 && minutoVirtual >= 30)) {
-    if (!pausaAlongamentoTomada) {
-      tone(BUZZER_PIN, 600, 200);
-      Serial.println("🧘‍♂️ MICRO-PAUSA: Alongue costas e pescoço");
-      Serial.println("💫 2 minutos para prevenir LER/DORT");
-      
-      totalPausasRealizadas++;
-      statusPausaAtual = PAUSA_ALONGAMENTO;
-      
-      pausaAlongamentoTomada = true;
-    }
-  } else {
-    pausaAlongamentoTomada = false;
-    statusPausaAtual = SEM_PAUSA;
-  }
+// Antecedência do ciclo do DHT em relação à leitura dos sensores
+unsigned long antecedenciaDhtMs() {
+  return dhtDuracaoCicloMs() + DHT_FOLGA_MS;
 }
 
-// ==================== FUNÇÕES DE MENSAGENS CONTEXTUAIS ====================
-void verificarMensagensContextuais(int horaVirtual, int minutoVirtual) {
-  // Início do expediente - 7:00
-  if (horaVirtual == 7) {
-    Serial.println("🌅 BOM DIA! - Tenha um dia produtivo!");
-  }
-  
-  // Fim do expediente - 17:00
-  if (horaVirtual == 17) {
-    Serial.println("🏠 FIM DO EXPEDIENTE - Descanse e recarregue as energias!");
-  }
-  
-  // Virada do dia - 7:00 do próximo dia
-  verificarViradaDia(horaVirtual, minutoVirtual);
+// Chamada no fim de cada leitura: o próximo ciclo termina logo antes da
+// próxima leitura (taxa fixa: conta a partir do instante programado)
+void agendarLeituraDht(unsigned long periodoMs) {
+  const Tarefa* sensores = agendadorTarefa(idTarefaSensores);
+  if (sensores == nullptr) return;
+  uint32_t proximaLeituraUs = sensores->proximaExecucaoUs + (uint32_t)(periodoMs * 1000UL);
+  long faltaMs = (long)(int32_t)(proximaLeituraUs - (uint32_t)halMicros()) / 1000L - (long)antecedenciaDhtMs();
+  agendadorReagendar(idTarefaDht, faltaMs > 0 ? (unsigned long)faltaMs : 0);
 }
 
-void verificarViradaDia(int horaVirtual, int minutoVirtual) {
-  if (horaVirtual == 7 && minutoVirtual < 5) {
-    static bool novoDiaProcessado = false;
-    if (!novoDiaProcessado) {
-      reiniciarSistemaPausas();
-      novoDiaProcessado = true;
-    }
-  } else {
-    static bool novoDiaProcessado = false;
-    novoDiaProcessado = false;
+void tarefaAtuacao() {
+  PERFIL_INICIO(inicio);
+  controlarLEDsAlerta(violacoesAtuais);
+  PERFIL_FIM(ESTAGIO_ATUACAO, inicio);
+}
+
+void tarefaPausas() {
+  PERFIL_INICIO(inicio);
+  // Um compare contra o próximo evento; vários só depois de um salto
+  const EventoAgenda* evento;
+  while ((evento = agendaProcessar(getMinutosVirtuais())) != nullptr) {
+    anunciarEvento(*evento);
   }
+  PERFIL_FIM(ESTAGIO_PAUSAS, inicio);
 }
 
-void reiniciarSistemaPausas() {
-  pausaCafeTomada = false;
-  pausaAlmocoTomada = false;
-  pausaTardeTomada = false;
-  pausaAlongamentoTomada = false;
-  totalPausasRealizadas = 0;
-  statusPausaAtual = SEM_PAUSA;
+// Zonas 1..N: médias da janela de cada uma, para o canal (ou tópico)
+// dela. Sem a supressão do adaptativo, que acompanha só a zona 0
+void enviarOutrasZonas() {
+  for (int z = 1; z < zonasTotal(); z++) {
+    AmostraAgregada media;
+    if (!zonasFecharJanela(z, media) || !telemetriaDestino().aceitaZona(z)) continue;
+    LOG_INFO("MEDIA", "🏢 ", zonasConfig(z).nome, ": ", Decimal(media.temperatura, 1), "°C ",
+             Decimal(media.umidade, 1), "% LDR ", media.luminosidade, " score ", media.score);
+    enviarParaThingSpeak(media.temperatura, media.umidade, media.luminosidade, media.score, (uint8_t)z);
+  }
 }
 
-// ==================== FUNÇÃO PRINCIPAL DO SISTEMA ====================
-void executarSistemaWellWork() {
-  // Obter horário atual
-  String horarioAtual = getHorarioFormatado();
-  int horaVirtual = getHoraVirtual();
-  int minutoVirtual = getMinutoVirtual();
+// Agregação + envio: fecha a janela de médias e publica no ThingSpeak
+void tarefaEnvio() {
+  PERFIL_INICIO(inicio);
+  enviarOutrasZonas();
+  // Fecha o balde mesmo vazio: as janelas de 5 min e 1 h andam no tempo
+  estatisticasFecharBalde();
+  const ResumoJanela& temp = estatisticasResumo(METRICA_TEMPERATURA, JANELA_15S);
+  if (temp.amostras == 0) {
+    PERFIL_FIM(ESTAGIO_ENVIO, inicio);
+    return;
+  }
 
-  int valorLDR = lerLDR();
-  bool escuro = ambienteEstaEscuro();
+  // Médias da janela de 15 s
+  float tempMedia = temp.media;
+  float umidadeMedia = estatisticasResumo(METRICA_UMIDADE, JANELA_15S).media;
+  int ldrMedia = (int)(estatisticasResumo(METRICA_LUMINOSIDADE, JANELA_15S).media + 0.5f);
+  int scoreMedia = (int)(estatisticasResumo(METRICA_SCORE, JANELA_15S).media + 0.5f);
+  
+  LOG_INFO("MEDIA", "📊 Calculando médias de ", temp.amostras, " leituras:");
+  LOG_INFO("MEDIA", "   🌡️  Temp média: ", Decimal(tempMedia, 1), "°C (±", Decimal(temp.desvio, 1), ")");
+  LOG_INFO("MEDIA", "   💧 Umidade média: ", Decimal(umidadeMedia, 1), "%");
+  LOG_INFO("MEDIA", "   💡 LDR médio: ", ldrMedia);
+  LOG_INFO("MEDIA", "   🏆 Score médio: ", scoreMedia);
+
+  // Dentro das bandas mortas só sai o heartbeat
+  if (!adaptativoDeveEnviar(tempMedia, umidadeMedia, ldrMedia, violacoesAtuais, halMillis())) {
+    LOG_INFO("MEDIA", "   💤 Sem mudança - envio suprimido");
+    PERFIL_FIM(ESTAGIO_ENVIO, inicio);
+    return;
+  }
 
-  Serial.println("🕐 HORÁRIO VIRTUAL: " + horarioAtual + "h");
-  
-  // Ler sensores de ambiente
-  float temperatura = dht.readTemperature();
-  float umidade = dht.readHumidity();
-  
-  if (!isnan(temperatura) && !isnan(umidade)) {
-    Serial.println("🌡️ Temperatura: " + String(temperatura) + "°C");
-    Serial.println("💧 Umidade: " + String(umidade) + "%");
-    Serial.println("💡 LDR: " + String(valorLDR));
-    
-    // ========== SISTEMA DE SCORING INTELIGENTE ==========
-    int score = calcularScoreSaudeAmbiental(temperatura, umidade, horaVirtual, escuro);
-    tomarDecisaoAmbiental(score, temperatura, umidade, horaVirtual, escuro);
-    
-    controlarLEDsAmbiente(temperatura, umidade);
-    
-    // ⭐⭐ ACUMULAR VALORES PARA MÉDIA ==========
-    tempAcumulada += temperatura;
-    umidadeAcumulada += umidade;
-    ldrAcumulado += valorLDR;
-    scoreAcumulado += score;
-    leituras++;
-    
-    Serial.println("📈 Acumulando dados para média (" + String(leituras) + " leituras)");
-    
-    // ⭐⭐ NOVO: ENVIAR MÉDIAS PARA THINGSPEAK ==========
-    if (millis() - ultimoEnvioThingSpeak > INTERVALO_ENVIO_THINGSPEAK && leituras > 0) {
-      // Calcular médias
-      float tempMedia = tempAcumulada / leituras;
-      float umidadeMedia = umidadeAcumulada / leituras;
-      int ldrMedia = ldrAcumulado / leituras;
-      int scoreMedia = scoreAcumulado / leituras;
-      
-      Serial.println("📊 Calculando médias de " + String(leituras) + " leituras:");
-      Serial.println("   🌡️  Temp média: " + String(tempMedia, 1) + "°C");
-      Serial.println("   💧 Umidade média: " + String(umidadeMedia, 1) + "%");
-      Serial.println("   💡 LDR médio: " + String(ldrMedia));
-      Serial.println("   🏆 Score médio: " + String(scoreMedia));
-      
-      enviarParaThingSpeak(tempMedia, umidadeMedia, ldrMedia, scoreMedia);
-      
-      // Resetar acumuladores
-      tempAcumulada = 0;
-      umidadeAcumulada = 0;
-      ldrAcumulado = 0;
-      scoreAcumulado = 0;
-      leituras = 0;
-      ultimoEnvioThingSpeak = millis();
-    }
+  enviarParaThingSpeak(tempMedia, umidadeMedia, ldrMedia, scoreMedia);
+  PERFIL_FIM(ESTAGIO_ENVIO, inicio);
+}
+
+void tarefaLog() {
+  logDrenar();
+}
+
+void tarefaRelatorio() {
+  agendadorImprimirEstatisticas();
+  wifiImprimirEstatisticas();
+  adaptativoImprimirEstatisticas();
+  energiaImprimirEstatisticas();
+  dhtImprimirEstatisticas();
+  luzImprimirEstatisticas();
+  servidorMetricasImprimirEstatisticas();
+  mqttImprimirEstatisticas();
+  historicoImprimirEstatisticas();
+  alertasImprimirEstatisticas();
+  trilhaImprimirEstatisticas();
+  if (zonasTotal() > 1) zonasImprimir();
+
+  const EstatisticasFila& fila = filaEstatisticas();
+  LOG_INFO("FILA", "📦 Fila: tamanho=", filaTamanho(), " max=", fila.ocupacaoMaxima,
+                " enfileiradas=", fila.enfileiradas, " enviadas=", fila.enviadas,
+                " overflow=", fila.descartadasOverflow);
+  LOG_INFO("FILA", "🔀 Fila entre núcleos: profundidade=", (unsigned long)filaRede.profundidade(),
+                " max=", (unsigned long)filaRede.profundidadeMaxima(),
+                " descartes=", filaRede.descartes());
+  heapImprimirMetricas();
+  saudeImprimir();
+  perfilImprimir();
+
+  // Tendência e dispersão das janelas longas
+  for (int m = 0; m < TOTAL_METRICAS; m++) {
+    const ResumoJanela& cinco = estatisticasResumo((MetricaAmbiente)m, JANELA_5MIN);
+    const ResumoJanela& hora = estatisticasResumo((MetricaAmbiente)m, JANELA_1H);
+    if (cinco.amostras == 0) continue;
+    LOG_INFO("ESTAT", "📈 ", estatisticasNomeMetrica((MetricaAmbiente)m),
+             ": 5min=", Decimal(cinco.media, 1), "±", Decimal(cinco.desvio, 1),
+             " [", Decimal(cinco.minimo, 1), "..", Decimal(cinco.maximo, 1), "]",
+             " 1h=", Decimal(hora.media, 1), "±", Decimal(hora.desvio, 1),
+             " tendencia=", Decimal(estatisticasTendencia((MetricaAmbiente)m), 2));
   }
 
-  // Verificar iluminação binária
-  verificarIluminacaoBinaria(horaVirtual);
+  LOG_INFO("PAUSA", "🗓️ Agenda ", agendaNomePerfil(), ": dia ", agendaDiaAtual(),
+           " pausas hoje=", agendaPausasHoje(), " status=", (int)agendaStatusPausa());
 
-  // Verificar todas as pausas programadas
-  verificarPausaCafe(horaVirtual);
-  verificarPausaAlmoco(horaVirtual);
-  verificarPausaTarde(horaVirtual);
-  verificarMicroPausaAlongamento(horaVirtual, minutoVirtual);
-  
-  // Verificar mensagens contextuais
-  verificarMensagensContextuais(horaVirtual, minutoVirtual);
-  
-  // Separador
-  Serial.println("--------------------------------------------");
+  const EstatisticasHttp& http = clienteThingSpeak.estatisticas();
+  LOG_INFO("HTTP", "🔗 HTTP: requisicoes=", http.requisicoes, " conexoes=", http.conexoesAbertas,
+                " reaproveitadas=", http.reaproveitadas, " reenvios=", http.reenviosSocketMorto,
+                " dns=", http.consultasDns, " falhas=", http.falhas);
+
+  const EstatisticasLog& log = logEstatisticas();
+  LOG_INFO("LOG", "📝 Log: publicadas=", log.publicadas, " repetidas=", log.suprimidasRepeticao,
+           " descartadas=", log.descartadasBufferCheio, " bytes=", log.bytesEscritos,
+           " ocupacaoMax=", (unsigned long)log.ocupacaoMaxima);
 }
 
 // ==================== SETUP E LOOP ====================
 void setup() {
-  Serial.begin(115200);
-  dht.begin(); 
+  // Despertar do sono profundo: agenda, filas e estatísticas vêm da RTC
+  bool retomado = energiaIniciar();
+
+  // Buffer de TX antes do begin(): o log escreve só o que cabe nele
+  halSerialIniciar(115200, LOG_BUFFER_TX_UART);
+  logIniciar(LOG_FORMATO_TEXTO);
+
+  // Trilha na flash, se pedida e se o build nativo não escolheu outra
+  if (TRILHA_GRAVAR && trilhaModo() != TRILHA_REPRODUZINDO) trilhaGravarArquivo(TRILHA_ARQUIVO);
+
+  // Zonas e os sensores locais delas
+  zonasIniciar(ZONAS, TOTAL_ZONAS_TABELA, ZONAS_ATIVAS);
+  int pinosDht[DHT_MAX_SENSORES];
+  int pinosLdr[LUZ_MAX_CANAIS];
+  dhtIniciar(pinosDht, zonasPinosDht(pinosDht, DHT_MAX_SENSORES));
+  luzIniciar(pinosLdr, zonasPinosLdr(pinosLdr, LUZ_MAX_CANAIS));
   
   // Configurar os pinos
-  pinMode(LED_VERMELHO, OUTPUT);
-  pinMode(LED_AZUL, OUTPUT);
-  pinMode(LED_ALERTA_ESCURO_DIA, OUTPUT);
-  pinMode(LED_ALERTA_CLARO_NOITE, OUTPUT);
-  pinMode(BUZZER_PIN, OUTPUT);
+  halPinoSaida(LED_VERMELHO);
+  halPinoSaida(LED_AZUL);
+  halPinoSaida(LED_ALERTA_ESCURO_DIA);
+  halPinoSaida(LED_ALERTA_CLARO_NOITE);
+  halPinoSaida(BUZZER_PIN);
   
   // Iniciar com LEDs apagados e buzzer desligado
-  digitalWrite(LED_VERMELHO, LOW);
-  digitalWrite(LED_AZUL, LOW);
-  digitalWrite(LED_ALERTA_ESCURO_DIA, LOW);
-  digitalWrite(LED_ALERTA_CLARO_NOITE, LOW);
-  noTone(BUZZER_PIN);
-  
-  // Conectar WiFi
-  conectarWiFi();
+  halEscreverDigital(LED_VERMELHO, LOW);
+  halEscreverDigital(LED_AZUL, LOW);
+  halEscreverDigital(LED_ALERTA_ESCURO_DIA, LOW);
+  halEscreverDigital(LED_ALERTA_CLARO_NOITE, LOW);
+  halSilenciar(BUZZER_PIN);
+  
+  // Conectar WiFi em segundo plano - o sensoriamento não espera pela rede.
+  // Nos modos de sono o rádio só liga quando houver lote para enviar
+  wifiIniciar(WIFI_SSID, WIFI_PASSWORD, energiaModo() == ENERGIA_ACORDADO);
+
+  // Fila de telemetria (restaura o que ficou na flash antes do reboot)
+  filaIniciar(DESCARTAR_MAIS_ANTIGA);
+
+  // Histórico comprimido das médias da zona 0 (continua o da flash)
+  historicoIniciar();
+
+  // Faixas críticas de cada zona e alertas ainda sem confirmação
+  alertasIniciar(reagirAlertaCritico);
+
+  // Histogramas de latência e watchdog das tarefas (antes de criá-las)
+  saudeIniciar();
+
+  // Rede no núcleo 0; este loop() continua no núcleo 1
+  clienteThingSpeak.configurar(THINGSPEAK_HOST, THINGSPEAK_PORTA);
+  mqttConfigurar(MQTT_HOST, MQTT_PORTA, MQTT_ID_DISPOSITIVO);
+  telemetriaIniciar(DESTINOS, TOTAL_DESTINOS, DESTINO_TELEMETRIA);
+  halCriarTarefa(passoTarefaRede, "rede", PILHA_TAREFA_REDE,
+                 PRIORIDADE_TAREFA_REDE, NUCLEO_REDE, PERIODO_TAREFA_REDE);
+  if (energiaModo() == ENERGIA_ACORDADO &&
+      servidorMetricasIniciar(METRICAS_PORTA, &clienteThingSpeak.estatisticas())) {
+    halCriarTarefa(servidorMetricasProcessar, "metricas", PILHA_TAREFA_METRICAS,
+                   PRIORIDADE_TAREFA_METRICAS, NUCLEO_REDE, METRICAS_PERIODO_TAREFA_MS);
+  }
+
+  if (retomado) return;
+
+  // Limites do ambiente (padrão + ajustes da flash)
+  regrasIniciar();
+
+  // Média, dispersão e EMA das métricas em 15 s / 5 min / 1 h
+  estatisticasIniciar();
+
+  // Bandas mortas da amostragem e do envio (padrão + ajustes da flash)
+  adaptativoIniciar(PERIODO_SENSORIAMENTO);
   
   // Iniciar simulação de tempo
-  inicioSimulacao = millis();
+  inicioSimulacao = halMillis();
+  agendaIniciar(getMinutosVirtuais());
+
+  // Registrar tarefas (a fase espalha as execuções dentro do período)
+  int idTarefaLog = agendadorAdicionarPeriodica("log", tarefaLog, PERIODO_LOG, DEADLINE_LOG, 0);
+  idTarefaDht = agendadorAdicionarUnica("dht", tarefaDht, 0, DEADLINE_DHT);
+  idTarefaSensores = agendadorAdicionarPeriodica("sensores", executarSistemaWellWork, PERIODO_SENSORIAMENTO, DEADLINE_SENSORIAMENTO, antecedenciaDhtMs());
+  int idTarefaAtuacao = agendadorAdicionarPeriodica("atuacao", tarefaAtuacao, PERIODO_ATUACAO, DEADLINE_ATUACAO, 50);
+  int idTarefaPausas = agendadorAdicionarPeriodica("pausas", tarefaPausas, PERIODO_PAUSAS, DEADLINE_PAUSAS, 100);
+  agendadorAdicionarPeriodica("envio", tarefaEnvio, INTERVALO_ENVIO_THINGSPEAK, DEADLINE_ENVIO, INTERVALO_ENVIO_THINGSPEAK);
+  agendadorAdicionarPeriodica("relatorio", tarefaRelatorio, PERIODO_RELATORIO, 0, PERIODO_RELATORIO);
+
+  // Modos de sono: só a leitura acorda a CPU; o log escoa antes de dormir
+  if (energiaModo() != ENERGIA_ACORDADO) {
+    agendadorSuspender(idTarefaLog);
+    agendadorSuspender(idTarefaAtuacao);
+    agendadorSuspender(idTarefaPausas);
+  }
   
-  Serial.println("🚀 Sistema WellWork - Pausas Inteligentes + Monitoramento Completo");
-  Serial.println("📡 COM THINGSPEAK INTEGRATION (MÉDIAS)");
-  Serial.println("⏰ 5 segundos reais = 1 hora virtual");
-  Serial.println("🌅 Horário inicia às 7:00");
-  Serial.println("📊 Dados enviados como MÉDIAS a cada 15 segundos");
-  Serial.println("--------------------------------------------");
+  LOG_INFO("SISTEMA", "🚀 Sistema WellWork - Pausas Inteligentes + Monitoramento Completo");
+  LOG_INFO("SISTEMA", "📡 COM THINGSPEAK INTEGRATION (MÉDIAS)");
+  LOG_INFO("SISTEMA", "⏰ 5 segundos reais = 1 hora virtual");
+  LOG_INFO("SISTEMA", "🌅 Horário inicia às 7:00");
+  LOG_INFO("SISTEMA", "📊 Dados enviados como MÉDIAS a cada 15 segundos");
+  LOG_INFO("SISTEMA", "⏱️  Agendador cooperativo: amostragem a cada 2.5 segundos");
+  LOG_INFO("SISTEMA", "🔋 Modo de energia: ", energiaNomeModo(energiaModo()));
+  LOG_INFO("SISTEMA", "🏢 Zonas: ", zonasTotal());
+  LOG_INFO("SISTEMA", "--------------------------------------------");
 }
 
 void loop() {
-  executarSistemaWellWork();
-  delay(2500);
-}
\ No newline at end of file
+  halWatchdogAlimentar();
+  unsigned long espera = agendadorExecutar();
+
+  // Tempo livre: dorme se o modo e a rede deixarem; senão cede a CPU
+  // (halDelay() no ESP32 é vTaskDelay)
+  bool ociosa = redeOciosa && filaRede.profundidade() == 0 && trilhaBlocosPendentes() == 0 && !alertasEmTransito();
+  if (espera > 0 && !energiaDormir(espera, ociosa)) {
+    if (energiaModo() != ENERGIA_ACORDADO) logDrenar();
+    halDelay(min(espera, (unsigned long)ESPERA_MAXIMA_LOOP));
+  }
+}
@@ -0,0 +1,185 @@
+#include "conexao_wifi.h"
+
+#include "log.h"
+
+static const char* ssidWiFi = "";
+static const char* senhaWiFi = "";
+
+static EstadoWiFi estado = WIFI_DESLIGADO;
+// Contadores na RTC: continuam somando entre despertares do sono profundo
+static HAL_RETIDO EstatisticasWiFi estatisticas = {};
+static HAL_RETIDO bool jaConectouAntes = false;
+
+static unsigned long inicioTentativa = 0;
+static unsigned long inicioOffline = 0;
+static unsigned long proximaTentativa = 0;
+static bool desligadoPorEnergia = false;   // Rádio desligado de propósito: não é queda
+
+// Sinalizados pelo callback de eventos (roda na task do WiFi)
+static volatile bool eventoGotIp = false;
+static volatile bool eventoDesconectado = false;
+
+static void aoEventoWiFi(EventoHalWiFi evento) {
+  switch (evento) {
+    case HAL_WIFI_GOT_IP:
+      eventoGotIp = true;
+      break;
+    case HAL_WIFI_DESCONECTADO:
+      eventoDesconectado = true;
+      break;
+  }
+}
+
+static void iniciarTentativa(unsigned long agora) {
+  estatisticas.tentativas++;
+  eventoGotIp = false;
+  eventoDesconectado = false;
+
+  halWiFiConectar(ssidWiFi, senhaWiFi);
+
+  inicioTentativa = agora;
+  estado = WIFI_CONECTANDO;
+  LOG_INFO("WIFI", "🔄 WiFi: tentativa ", estatisticas.tentativas);
+}
+
+static void agendarBackoff(unsigned long agora) {
+  unsigned long base = estatisticas.backoffAtualMs;
+  long jitter = (long)(base * WIFI_JITTER_PERCENTUAL / 100);
+  long espera = (long)base + (jitter > 0 ? halAleatorio(-jitter, jitter + 1) : 0);
+
+  proximaTentativa = agora + (unsigned long)espera;
+  estado = WIFI_AGUARDANDO_BACKOFF;
+  LOG_INFO("WIFI", "⏳ WiFi: nova tentativa em ", espera, " ms");
+
+  // Dobra para a próxima falha
+  estatisticas.backoffAtualMs = min(base * 2, (unsigned long)WIFI_BACKOFF_MAXIMO);
+}
+
+static void marcarConectado(unsigned long agora) {
+  // Descarta o evento de desconexão gerado pela própria tentativa
+  eventoDesconectado = false;
+  estatisticas.ultimaConexaoMs = agora - inicioTentativa;
+  estatisticas.tempoOfflineTotalMs += agora - inicioOffline;
+  estatisticas.backoffAtualMs = WIFI_BACKOFF_INICIAL;
+
+  if (!jaConectouAntes) {
+    estatisticas.tempoParaConectarMs = agora;
+    jaConectouAntes = true;
+  } else if (!desligadoPorEnergia) {
+    estatisticas.reconexoes++;
+  }
+  desligadoPorEnergia = false;
+
+  estado = WIFI_CONECTADO;
+  LOG_INFO("WIFI", "🎉 ✅ CONEXÃO ESTABELECIDA!");
+  uint8_t ip[4];
+  halWiFiIp(ip);
+  LOG_INFO("WIFI", "   📶 IP: ", ip[0], ".", ip[1], ".", ip[2], ".", ip[3]);
+  LOG_INFO("WIFI", "   📡 RSSI: ", halWiFiRssi(), " dBm");
+  LOG_INFO("WIFI", "   ⏱️  Tempo de associação: ", estatisticas.ultimaConexaoMs, " ms");
+}
+
+void wifiIniciar(const char* ssid, const char* senha, bool conectarAgora) {
+  ssidWiFi = ssid;
+  senhaWiFi = senha;
+
+  if (!halDespertouDoSonoProfundo()) {
+    estatisticas = EstatisticasWiFi();
+    estatisticas.backoffAtualMs = WIFI_BACKOFF_INICIAL;
+    jaConectouAntes = false;
+  }
+  estado = WIFI_DESLIGADO;
+  inicioOffline = halMillis();
+  desligadoPorEnergia = !conectarAgora;
+
+  // A reconexão é nossa; o auto-reconnect do driver competiria com o backoff
+  halWiFiIniciar(aoEventoWiFi);
+
+  if (conectarAgora) {
+    LOG_INFO("WIFI", "📡 WiFi: conexão assíncrona iniciada");
+    iniciarTentativa(halMillis());
+  }
+}
+
+void wifiLigar() {
+  if (estado != WIFI_DESLIGADO) return;
+  unsigned long agora = halMillis();
+  // Só a associação conta como offline, não o tempo com o rádio desligado
+  if (desligadoPorEnergia) inicioOffline = agora;
+  iniciarTentativa(agora);
+}
+
+void wifiDesligar() {
+  if (estado == WIFI_DESLIGADO) return;
+  // Tentativa interrompida: o que passou dela conta como offline
+  if (estado != WIFI_CONECTADO) estatisticas.tempoOfflineTotalMs += halMillis() - inicioOffline;
+  desligadoPorEnergia = true;
+  // Antes do driver: o evento de desconexão que ele gera não é uma queda
+  estado = WIFI_DESLIGADO;
+  halWiFiDesligar();
+  LOG_DEBUG("WIFI", "📴 WiFi: rádio desligado");
+}
+
+void wifiProcessar() {
+  unsigned long agora = halMillis();
+
+  switch (estado) {
+    case WIFI_DESLIGADO:
+      break;
+
+    case WIFI_CONECTANDO:
+      if (eventoGotIp || halWiFiConectado()) {
+        eventoGotIp = false;
+        marcarConectado(agora);
+      } else if (agora - inicioTentativa >= WIFI_TIMEOUT_TENTATIVA) {
+        LOG_AVISO("WIFI", "❌ WiFi: tempo esgotado na tentativa ", estatisticas.tentativas);
+        agendarBackoff(agora);
+      }
+      break;
+
+    case WIFI_CONECTADO:
+      if (eventoDesconectado || !halWiFiConectado()) {
+        eventoDesconectado = false;
+        estatisticas.quedas++;
+        inicioOffline = agora;
+        LOG_AVISO("WIFI", "⚠️ WiFi: conexão perdida, reconectando em segundo plano");
+        iniciarTentativa(agora);
+      }
+      break;
+
+    case WIFI_AGUARDANDO_BACKOFF:
+      if ((long)(agora - proximaTentativa) >= 0) {
+        iniciarTentativa(agora);
+      }
+      break;
+  }
+}
+
+bool wifiEstaConectado() {
+  return estado == WIFI_CONECTADO && halWiFiConectado();
+}
+
+EstadoWiFi wifiEstado() {
+  return estado;
+}
+
+unsigned long wifiTempoOfflineMs() {
+  if (estado == WIFI_CONECTADO || desligadoPorEnergia) {
+    return estatisticas.tempoOfflineTotalMs;
+  }
+  return estatisticas.tempoOfflineTotalMs + (halMillis() - inicioOffline);
+}
+
+const EstatisticasWiFi& wifiEstatisticas() {
+  return estatisticas;
+}
+
+void wifiImprimirEstatisticas() {
+  LOG_INFO("WIFI", "📶 WiFi: estado=", (int)estado,
+                " tentativas=", estatisticas.tentativas,
+                " reconexoes=", estatisticas.reconexoes,
+                " quedas=", estatisticas.quedas,
+                " ateConectar=", estatisticas.tempoParaConectarMs, "ms",
+                " offline=", wifiTempoOfflineMs(), "ms",
+                " backoff=", estatisticas.backoffAtualMs, "ms");
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "hal.h"
+
+// ==================== CONEXÃO WiFi ASSÍNCRONA ====================
+// Máquina de estados não bloqueante: wifiProcessar() é chamada pelo
+// agendador e nunca espera pela rede. Quedas são tratadas em segundo
+// plano com backoff exponencial + jitter. Nos modos de sono o rádio só é
+// ligado (wifiLigar) quando há envio a fazer.
+
+#define WIFI_TIMEOUT_TENTATIVA 15000   // ms por tentativa de associação
+#define WIFI_BACKOFF_INICIAL 1000      // ms
+#define WIFI_BACKOFF_MAXIMO 60000      // ms
+#define WIFI_JITTER_PERCENTUAL 25      // ± % aplicado ao backoff
+
+enum EstadoWiFi {
+  WIFI_DESLIGADO,
+  WIFI_CONECTANDO,
+  WIFI_CONECTADO,
+  WIFI_AGUARDANDO_BACKOFF
+};
+
+struct EstatisticasWiFi {
+  unsigned long tempoParaConectarMs;   // Do boot até o primeiro IP
+  unsigned long ultimaConexaoMs;       // Duração da última associação
+  unsigned long tentativas;
+  unsigned long reconexoes;            // Conexões após uma queda
+  unsigned long quedas;
+  unsigned long tempoOfflineTotalMs;
+  unsigned long backoffAtualMs;
+};
+
+void wifiIniciar(const char* ssid, const char* senha, bool conectarAgora = true);
+void wifiLigar();      // Nova tentativa se estiver desligado
+void wifiDesligar();   // Desliga o rádio; não conta como queda
+void wifiProcessar();
+bool wifiEstaConectado();
+EstadoWiFi wifiEstado();
+unsigned long wifiTempoOfflineMs();   // Inclui o período offline em curso
+const EstatisticasWiFi& wifiEstatisticas();
+void wifiImprimirEstatisticas();
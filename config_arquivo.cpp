@@ -0,0 +1,43 @@
+#include "config_arquivo.h"
+
+#include "log.h"
+
+static char* aparar(char* texto) {
+  while (*texto == ' ' || *texto == '\t') texto++;
+  char* fim = texto + strlen(texto);
+  while (fim > texto && (fim[-1] == ' ' || fim[-1] == '\t' || fim[-1] == '\r')) *--fim = '\0';
+  return texto;
+}
+
+int configCarregar(const char* caminho, AplicarAjuste aplicar) {
+  if (!halArmazenamentoIniciar()) return -1;
+  int arquivo = halArquivoAbrir(caminho, false);
+  if (arquivo < 0) return -1;
+
+  char texto[CONFIG_TAMANHO_MAX_ARQUIVO + 1];
+  size_t lidos = halArquivoLer(arquivo, texto, CONFIG_TAMANHO_MAX_ARQUIVO);
+  halArquivoFechar(arquivo);
+  texto[lidos] = '\0';
+
+  int aplicados = 0;
+  int numeroLinha = 0;
+  char* proxima = texto;
+  while (proxima != nullptr && *proxima != '\0') {
+    char* linha = proxima;
+    proxima = strchr(linha, '\n');
+    if (proxima != nullptr) *proxima++ = '\0';
+    numeroLinha++;
+
+    linha = aparar(linha);
+    if (*linha == '\0' || *linha == '#') continue;
+
+    char* igual = strchr(linha, '=');
+    if (igual != nullptr) *igual = '\0';
+    if (igual != nullptr && aplicar(aparar(linha), aparar(igual + 1))) {
+      aplicados++;
+    } else {
+      LOG_AVISO("CONFIG", "⚠️ ", caminho, ":", numeroLinha, " ignorada");
+    }
+  }
+  return aplicados;
+}
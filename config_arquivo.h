@@ -0,0 +1,15 @@
+#pragma once
+
+#include "hal.h"
+
+// ==================== ARQUIVOS DE AJUSTE ====================
+// Lê um arquivo "chave = valor" da flash (linhas vazias e # são
+// ignoradas) e entrega cada par para aplicar(). Linhas que aplicar()
+// recusa geram um aviso com o número da linha.
+
+#define CONFIG_TAMANHO_MAX_ARQUIVO 1024
+
+typedef bool (*AplicarAjuste)(char* chave, char* valor);
+
+// Retorna quantos ajustes foram aplicados, ou -1 se o arquivo não existe
+int configCarregar(const char* caminho, AplicarAjuste aplicar);
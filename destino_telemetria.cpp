@@ -0,0 +1,43 @@
+#include "destino_telemetria.h"
+
+#include "log.h"
+
+static const DestinoTelemetria* tabela = nullptr;
+static int totalDestinos = 0;
+static const DestinoTelemetria* ativo = nullptr;
+static const char* nomePedido = nullptr;
+
+void telemetriaSelecionarDestino(const char* nome) {
+  nomePedido = nome;
+}
+
+static const DestinoTelemetria* procurar(const char* nome) {
+  for (int i = 0; i < totalDestinos; i++) {
+    if (!strcmp(tabela[i].nome, nome)) return &tabela[i];
+  }
+  return nullptr;
+}
+
+void telemetriaIniciar(const DestinoTelemetria* destinos, int total, const char* padrao) {
+  tabela = destinos;
+  totalDestinos = total;
+  const char* nome = nomePedido != nullptr ? nomePedido : padrao;
+  ativo = procurar(nome);
+  if (ativo == nullptr) {
+    LOG_AVISO("ENVIO", "⚠️ Destino de telemetria desconhecido: ", nome);
+    ativo = &destinos[0];
+  }
+  LOG_INFO("ENVIO", "📮 Destino da telemetria: ", ativo->nome);
+}
+
+bool telemetriaUsarDestino(const char* nome) {
+  const DestinoTelemetria* novo = procurar(nome);
+  if (novo == nullptr) return false;
+  if (ativo != nullptr && ativo != novo) ativo->fechar();
+  ativo = novo;
+  return true;
+}
+
+const DestinoTelemetria& telemetriaDestino() {
+  return *ativo;
+}
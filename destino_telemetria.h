@@ -0,0 +1,55 @@
+#pragma once
+
+#include "hal.h"
+
+#include "alertas_criticos.h"
+
+// ==================== DESTINO DA TELEMETRIA ====================
+// Para onde a tarefa de rede leva a fila store-and-forward. Cada destino
+// (ThingSpeak por HTTP, MQTT, ...) é uma tabela de funções; o sketch
+// declara os que conhece e um deles fica ativo. Todos rodam só no núcleo
+// de rede, com o WiFi conectado, e só tiram da fila o que o servidor
+// confirmou: uma queda no meio do caminho não perde amostra.
+
+struct DestinoTelemetria {
+  const char* nome;
+
+  // Leva um lote das amostras mais antigas da fila. Retorna quantas
+  // saíram (confirmadas ou em voo); 0 = nada a fazer agora
+  int (*drenar)();
+
+  // A cada passo da tarefa de rede: confirmações, reenvios, keep-alive.
+  // Pode ser nullptr
+  void (*processar)();
+
+  // Antes de desligar o rádio (o socket não sobrevive)
+  void (*fechar)();
+
+  // A zona tem para onde ir (ex.: canal no ThingSpeak). false = a zona
+  // é avaliada mas não é enviada
+  bool (*aceitaZona)(int zona);
+
+  // Entre rodadas de drenagem do backlog (limite de taxa da API); amostra
+  // nova sai na hora. 0 = sem limite
+  unsigned long intervaloLotesMs;
+
+  // Alerta crítico, na frente dos lotes e sem esperar o intervalo. true =
+  // aceito: já confirmado (alertasConfirmar() chamado) ou em voo; false =
+  // agora não, e é chamado de novo no próximo passo (a espera depois de
+  // uma recusa é do destino). nullptr = destino sem alertas (só a reação
+  // local)
+  bool (*alertar)(const EventoAlerta& evento);
+};
+
+// Antes do setup() (ex.: opção do build nativo): troca o destino pedido
+// pelo sketch. nullptr = o do sketch
+void telemetriaSelecionarDestino(const char* nome);
+
+// No setup(): ativa o destino "padrao" da tabela, ou o selecionado.
+// Nome desconhecido fica no primeiro da tabela
+void telemetriaIniciar(const DestinoTelemetria* destinos, int total, const char* padrao);
+
+// Troca o destino ativo (fecha o anterior). false = nome desconhecido
+bool telemetriaUsarDestino(const char* nome);
+
+const DestinoTelemetria& telemetriaDestino();
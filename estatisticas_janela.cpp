@@ -0,0 +1,145 @@
+#include "estatisticas_janela.h"
+
+// Welford por balde; baldes são somados pela fórmula de Chan, sem os
+// somatórios em float que perdiam precisão
+struct Acumulador {
+  uint32_t amostras;
+  float media;
+  float m2;            // Soma dos quadrados dos desvios
+  float minimo;
+  float maximo;
+};
+
+static const unsigned long duracaoJanelaMs[TOTAL_JANELAS] = {
+  ESTATISTICAS_PERIODO_BALDE_MS,
+  (unsigned long)ESTATISTICAS_PERIODO_BALDE_MS * BALDES_POR_BLOCO,
+  (unsigned long)ESTATISTICAS_PERIODO_BALDE_MS * BALDES_POR_BLOCO * BLOCOS_POR_HORA,
+};
+
+static const char* const nomesMetricas[TOTAL_METRICAS] = { "temperatura", "umidade", "luminosidade", "score" };
+static const char* const nomesJanelas[TOTAL_JANELAS] = { "15s", "5min", "1h" };
+
+// Na RTC (~3 KB): as janelas seguem abertas depois do sono profundo
+static HAL_RETIDO Acumulador baldeAtual[TOTAL_METRICAS];
+static HAL_RETIDO Acumulador anelBaldes[BALDES_POR_BLOCO][TOTAL_METRICAS];
+static HAL_RETIDO Acumulador anelBlocos[BLOCOS_POR_HORA][TOTAL_METRICAS];
+static HAL_RETIDO int posicaoBalde = 0;
+static HAL_RETIDO int posicaoBloco = 0;
+
+static HAL_RETIDO ResumoJanela resumos[TOTAL_JANELAS][TOTAL_METRICAS];
+static HAL_RETIDO float ema[TOTAL_JANELAS][TOTAL_METRICAS];
+static HAL_RETIDO bool emaIniciada[TOTAL_METRICAS];
+static HAL_RETIDO unsigned long ultimaAmostraMs[TOTAL_METRICAS];
+
+static void acumular(Acumulador& a, float x) {
+  a.amostras++;
+  float delta = x - a.media;
+  a.media += delta / a.amostras;
+  a.m2 += delta * (x - a.media);
+  if (a.amostras == 1 || x < a.minimo) a.minimo = x;
+  if (a.amostras == 1 || x > a.maximo) a.maximo = x;
+}
+
+static void combinar(Acumulador& a, const Acumulador& b) {
+  if (b.amostras == 0) return;
+  if (a.amostras == 0) {
+    a = b;
+    return;
+  }
+  uint32_t n = a.amostras + b.amostras;
+  float delta = b.media - a.media;
+  a.media += delta * b.amostras / n;
+  a.m2 += b.m2 + delta * delta * ((float)a.amostras * b.amostras / n);
+  a.minimo = min(a.minimo, b.minimo);
+  a.maximo = max(a.maximo, b.maximo);
+  a.amostras = n;
+}
+
+static void preencherResumo(ResumoJanela& r, const Acumulador& a) {
+  r.amostras = a.amostras;
+  r.media = a.amostras > 0 ? a.media : NAN;
+  r.variancia = a.amostras > 1 ? a.m2 / (a.amostras - 1) : 0.0f;
+  r.desvio = sqrtf(r.variancia);
+  r.minimo = a.amostras > 0 ? a.minimo : NAN;
+  r.maximo = a.amostras > 0 ? a.maximo : NAN;
+}
+
+// ---------- API ----------
+void estatisticasIniciar() {
+  memset(baldeAtual, 0, sizeof(baldeAtual));
+  memset(anelBaldes, 0, sizeof(anelBaldes));
+  memset(anelBlocos, 0, sizeof(anelBlocos));
+  posicaoBalde = 0;
+  posicaoBloco = 0;
+
+  for (int j = 0; j < TOTAL_JANELAS; j++) {
+    for (int m = 0; m < TOTAL_METRICAS; m++) {
+      preencherResumo(resumos[j][m], baldeAtual[m]);
+      resumos[j][m].ema = NAN;
+    }
+  }
+  for (int m = 0; m < TOTAL_METRICAS; m++) emaIniciada[m] = false;
+}
+
+void estatisticasAdicionar(MetricaAmbiente metrica, float valor) {
+  if (isnan(valor)) return;
+  acumular(baldeAtual[metrica], valor);
+
+  unsigned long agora = halMillis();
+  unsigned long intervalo = agora - ultimaAmostraMs[metrica];
+  ultimaAmostraMs[metrica] = agora;
+  if (!emaIniciada[metrica]) {
+    for (int j = 0; j < TOTAL_JANELAS; j++) ema[j][metrica] = valor;
+    emaIniciada[metrica] = true;
+    return;
+  }
+
+  // Peso pelo tempo desde a amostra anterior: vale com período variável
+  for (int j = 0; j < TOTAL_JANELAS; j++) {
+    float alfa = min(1.0f, (float)intervalo / duracaoJanelaMs[j]);
+    ema[j][metrica] += alfa * (valor - ema[j][metrica]);
+  }
+}
+
+void estatisticasFecharBalde() {
+  for (int m = 0; m < TOTAL_METRICAS; m++) anelBaldes[posicaoBalde][m] = baldeAtual[m];
+  posicaoBalde = (posicaoBalde + 1) % BALDES_POR_BLOCO;
+  bool blocoCompleto = posicaoBalde == 0;
+
+  for (int m = 0; m < TOTAL_METRICAS; m++) {
+    preencherResumo(resumos[JANELA_15S][m], baldeAtual[m]);
+
+    Acumulador bloco = {};
+    for (int b = 0; b < BALDES_POR_BLOCO; b++) combinar(bloco, anelBaldes[b][m]);
+    preencherResumo(resumos[JANELA_5MIN][m], bloco);
+
+    // A janela de 1 h anda de bloco em bloco de 5 min
+    if (blocoCompleto) anelBlocos[posicaoBloco][m] = bloco;
+    Acumulador hora = {};
+    for (int b = 0; b < BLOCOS_POR_HORA; b++) combinar(hora, anelBlocos[b][m]);
+    preencherResumo(resumos[JANELA_1H][m], hora);
+
+    for (int j = 0; j < TOTAL_JANELAS; j++) {
+      resumos[j][m].ema = emaIniciada[m] ? ema[j][m] : NAN;
+    }
+    baldeAtual[m] = {};
+  }
+  if (blocoCompleto) posicaoBloco = (posicaoBloco + 1) % BLOCOS_POR_HORA;
+}
+
+const ResumoJanela& estatisticasResumo(MetricaAmbiente metrica, JanelaEstatistica janela) {
+  return resumos[janela][metrica];
+}
+
+float estatisticasTendencia(MetricaAmbiente metrica) {
+  if (!emaIniciada[metrica]) return 0.0f;
+  return ema[JANELA_15S][metrica] - ema[JANELA_1H][metrica];
+}
+
+const char* estatisticasNomeMetrica(MetricaAmbiente metrica) {
+  return nomesMetricas[metrica];
+}
+
+const char* estatisticasNomeJanela(JanelaEstatistica janela) {
+  return nomesJanelas[janela];
+}
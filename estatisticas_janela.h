@@ -0,0 +1,62 @@
+#pragma once
+
+#include "hal.h"
+
+// ==================== ESTATÍSTICAS EM JANELAS ====================
+// Média, variância, mínimo, máximo e EMA de cada métrica em três janelas
+// ao mesmo tempo (15 s, 5 min e 1 h), com memória fixa. Cada amostra só
+// atualiza o balde corrente (Welford, O(1)); a tarefa de envio fecha o
+// balde a cada ESTATISTICAS_PERIODO_BALDE_MS e os baldes fechados vão
+// para dois anéis:
+//
+//   15 s  = o último balde fechado
+//   5 min = anel com os últimos BALDES_POR_BLOCO baldes (desliza de 15 em 15 s)
+//   1 h   = anel com os últimos BLOCOS_POR_HORA blocos de 5 min (desliza de 5 em 5 min)
+//
+// Os resumos são recalculados só no fechamento, então a consulta é O(1).
+
+#define ESTATISTICAS_PERIODO_BALDE_MS 15000
+#define BALDES_POR_BLOCO 20                   // 20 x 15 s = 5 min
+#define BLOCOS_POR_HORA 12                    // 12 x 5 min = 1 h
+
+enum MetricaAmbiente : uint8_t {
+  METRICA_TEMPERATURA,
+  METRICA_UMIDADE,
+  METRICA_LUMINOSIDADE,
+  METRICA_SCORE,
+  TOTAL_METRICAS
+};
+
+enum JanelaEstatistica : uint8_t {
+  JANELA_15S,
+  JANELA_5MIN,
+  JANELA_1H,
+  TOTAL_JANELAS
+};
+
+struct ResumoJanela {
+  uint32_t amostras;
+  float media;
+  float variancia;     // Amostral (n - 1)
+  float desvio;
+  float minimo;
+  float maximo;
+  float ema;           // Média móvel exponencial com constante de tempo = janela,
+                       // ponderada pelo intervalo entre amostras
+};
+
+void estatisticasIniciar();
+
+// Amostras NAN são ignoradas
+void estatisticasAdicionar(MetricaAmbiente metrica, float valor);
+
+// Fecha o balde corrente e recalcula os resumos das três janelas
+void estatisticasFecharBalde();
+
+const ResumoJanela& estatisticasResumo(MetricaAmbiente metrica, JanelaEstatistica janela);
+
+// EMA de 15 s menos a de 1 h: positivo = subindo
+float estatisticasTendencia(MetricaAmbiente metrica);
+
+const char* estatisticasNomeMetrica(MetricaAmbiente metrica);
+const char* estatisticasNomeJanela(JanelaEstatistica janela);
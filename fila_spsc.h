@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+
+// ==================== FILA SPSC SEM LOCK ====================
+// Um produtor e um consumidor, cada um em seu núcleo/thread. Capacidade
+// fixa (potência de 2); os índices crescem sem parar e são mascarados,
+// então cheio = (cauda - cabeca == N) sem posição desperdiçada.
+// Só depende de <atomic>: roda igual em FreeRTOS e em std::thread.
+
+template <typename T, size_t N>
+class FilaSPSC {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "Capacidade da FilaSPSC deve ser potência de 2");
+
+ public:
+  // Somente o produtor chama
+  bool inserir(const T& item) {
+    size_t cauda = indiceCauda.load(std::memory_order_relaxed);
+    size_t cabeca = indiceCabeca.load(std::memory_order_acquire);
+
+    if (cauda - cabeca == N) {
+      totalDescartes.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    itens[cauda & (N - 1)] = item;
+    indiceCauda.store(cauda + 1, std::memory_order_release);
+
+    size_t profundidade = cauda + 1 - cabeca;
+    if (profundidade > maximo.load(std::memory_order_relaxed)) {
+      maximo.store(profundidade, std::memory_order_relaxed);
+    }
+    totalInseridos.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Somente o consumidor chama
+  bool retirar(T& item) {
+    size_t cabeca = indiceCabeca.load(std::memory_order_relaxed);
+    size_t cauda = indiceCauda.load(std::memory_order_acquire);
+
+    if (cabeca == cauda) {
+      return false;
+    }
+
+    item = itens[cabeca & (N - 1)];
+    indiceCabeca.store(cabeca + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Leituras aproximadas, seguras de qualquer núcleo. A cabeça vem antes
+  // da cauda: lida depois, a cabeça poderia passar da cauda lida e a conta
+  // daria a volta no size_t. Entre as duas leituras o produtor ainda pode
+  // inserir sobre o que o consumidor já tirou, daí o limite em N
+  size_t profundidade() const {
+    size_t cabeca = indiceCabeca.load(std::memory_order_acquire);
+    size_t cauda = indiceCauda.load(std::memory_order_acquire);
+    size_t profundidade = cauda - cabeca;
+    return profundidade > N ? N : profundidade;
+  }
+  size_t profundidadeMaxima() const { return maximo.load(std::memory_order_relaxed); }
+  unsigned long descartes() const { return totalDescartes.load(std::memory_order_relaxed); }
+  unsigned long inseridos() const { return totalInseridos.load(std::memory_order_relaxed); }
+  static constexpr size_t capacidade() { return N; }
+
+ private:
+  T itens[N];
+
+  // Em linhas de cache separadas para o produtor e o consumidor não
+  // invalidarem a linha um do outro a cada operação
+  alignas(32) std::atomic<size_t> indiceCabeca{0};
+  alignas(32) std::atomic<size_t> indiceCauda{0};
+
+  std::atomic<size_t> maximo{0};
+  std::atomic<unsigned long> totalDescartes{0};
+  std::atomic<unsigned long> totalInseridos{0};
+};
@@ -0,0 +1,178 @@
+#include "fila_telemetria.h"
+
+#include "log.h"
+
+static AmostraAgregada fila[CAPACIDADE_FILA_TELEMETRIA];
+static int cabeca = 0;     // Índice da amostra mais antiga
+static int tamanho = 0;
+static PoliticaOverflow politicaAtual = DESCARTAR_MAIS_ANTIGA;
+static HAL_RETIDO EstatisticasFila estatisticas = {};   // Soma entre despertares
+static int alteracoesPendentes = 0;
+static bool arquivoNaFlash = false;   // Há uma cópia da fila gravada
+
+#if FILA_PERSISTIR_FLASH
+static bool flashDisponivel = false;
+
+struct CabecalhoFila {
+  uint32_t magico;
+  uint16_t versao;
+  uint16_t quantidade;
+  uint32_t relogioMs;   // halMillis() da gravação: referência das idades
+};
+
+#define FILA_MAGICO 0x57574651UL   // "WWFQ"
+#define FILA_VERSAO 3              // 2: + zona; 3: + relogioMs
+
+static void restaurarDaFlash() {
+  int arquivo = halArquivoAbrir(FILA_ARQUIVO, false);
+  if (arquivo < 0) return;
+
+  CabecalhoFila cab;
+  if (halArquivoLer(arquivo, &cab, sizeof(cab)) == sizeof(cab) &&
+      cab.magico == FILA_MAGICO && cab.versao == FILA_VERSAO) {
+    int quantidade = min((int)cab.quantidade, CAPACIDADE_FILA_TELEMETRIA);
+    for (int i = 0; i < quantidade; i++) {
+      AmostraAgregada a;
+      if (halArquivoLer(arquivo, &a, sizeof(a)) != sizeof(a)) break;
+      // Depois de um reboot o halMillis() recomeçou: a idade de cada
+      // amostra na gravação é rebatida no relógio novo, como se o kit não
+      // tivesse ficado desligado (sem RTC não há como medir o apagão). O
+      // timestamp pode dar a volta para trás do zero; quem o usa subtrai em
+      // aritmética modular. Do sono profundo o relógio continua e o
+      // timestamp vale
+      if (!halDespertouDoSonoProfundo()) {
+        uint32_t idade = cab.relogioMs - (uint32_t)a.timestampMs;
+        a.timestampMs = halMillis() - idade;
+      }
+      fila[(cabeca + tamanho) % CAPACIDADE_FILA_TELEMETRIA] = a;
+      tamanho++;
+    }
+    estatisticas.restauradasFlash = tamanho;
+  }
+  halArquivoFechar(arquivo);
+  arquivoNaFlash = true;
+
+  if (tamanho > 0) {
+    LOG_INFO("FILA", "💾 Fila restaurada da flash: ", tamanho, " amostras");
+  }
+}
+#endif
+
+void filaIniciar(PoliticaOverflow politica) {
+  politicaAtual = politica;
+  cabeca = 0;
+  tamanho = 0;
+  if (!halDespertouDoSonoProfundo()) estatisticas = EstatisticasFila();
+
+#if FILA_PERSISTIR_FLASH
+  flashDisponivel = halArmazenamentoIniciar();
+  if (flashDisponivel) {
+    restaurarDaFlash();
+  } else {
+    LOG_AVISO("FILA", "⚠️ LittleFS indisponível - fila somente em RAM");
+  }
+#endif
+}
+
+bool filaEnfileirar(const AmostraAgregada& amostra) {
+  if (tamanho == CAPACIDADE_FILA_TELEMETRIA) {
+    estatisticas.descartadasOverflow++;
+    if (politicaAtual == DESCARTAR_MAIS_NOVA) {
+      return false;
+    }
+    cabeca = (cabeca + 1) % CAPACIDADE_FILA_TELEMETRIA;
+    tamanho--;
+  }
+
+  fila[(cabeca + tamanho) % CAPACIDADE_FILA_TELEMETRIA] = amostra;
+  tamanho++;
+  estatisticas.enfileiradas++;
+  if (tamanho > estatisticas.ocupacaoMaxima) {
+    estatisticas.ocupacaoMaxima = tamanho;
+  }
+
+  // Online a fila esvazia a cada envio; só vale gravar quando acumula
+  if (++alteracoesPendentes >= FILA_INTERVALO_PERSISTENCIA && tamanho > 1) {
+    filaPersistir();
+  }
+  return true;
+}
+
+int filaTamanho() {
+  return tamanho;
+}
+
+bool filaEspiar(int indice, AmostraAgregada& amostra) {
+  if (indice < 0 || indice >= tamanho) return false;
+  amostra = fila[(cabeca + indice) % CAPACIDADE_FILA_TELEMETRIA];
+  return true;
+}
+
+void filaConfirmarEnvio(int quantidade) {
+  quantidade = min(quantidade, tamanho);
+  if (quantidade <= 0) return;
+
+  cabeca = (cabeca + quantidade) % CAPACIDADE_FILA_TELEMETRIA;
+  tamanho -= quantidade;
+  estatisticas.enviadas += quantidade;
+
+  // A cópia na flash precisa refletir o envio, senão um reboot reenviaria
+  if (arquivoNaFlash) {
+    filaPersistir();
+  }
+}
+
+void filaConfirmarEnvioDaZona(uint8_t zona, int quantidade) {
+  // Compacta no lugar: as amostras das outras zonas andam para a cabeça
+  int removidas = 0;
+  int destino = 0;
+  for (int i = 0; i < tamanho; i++) {
+    const AmostraAgregada& a = fila[(cabeca + i) % CAPACIDADE_FILA_TELEMETRIA];
+    if (removidas < quantidade && a.zona == zona) {
+      removidas++;
+      continue;
+    }
+    if (destino != i) fila[(cabeca + destino) % CAPACIDADE_FILA_TELEMETRIA] = a;
+    destino++;
+  }
+  if (removidas == 0) return;
+
+  tamanho = destino;
+  estatisticas.enviadas += removidas;
+  if (arquivoNaFlash) {
+    filaPersistir();
+  }
+}
+
+void filaPersistirPendentes() {
+  if (alteracoesPendentes > 0) filaPersistir();
+}
+
+void filaPersistir() {
+  alteracoesPendentes = 0;
+#if FILA_PERSISTIR_FLASH
+  if (!flashDisponivel) return;
+
+  if (tamanho == 0) {
+    halArquivoRemover(FILA_ARQUIVO);
+    arquivoNaFlash = false;
+    return;
+  }
+
+  int arquivo = halArquivoAbrir(FILA_ARQUIVO, true);
+  if (arquivo < 0) return;
+
+  CabecalhoFila cab = { FILA_MAGICO, FILA_VERSAO, (uint16_t)tamanho, (uint32_t)halMillis() };
+  halArquivoEscrever(arquivo, &cab, sizeof(cab));
+  for (int i = 0; i < tamanho; i++) {
+    const AmostraAgregada& a = fila[(cabeca + i) % CAPACIDADE_FILA_TELEMETRIA];
+    halArquivoEscrever(arquivo, &a, sizeof(a));
+  }
+  halArquivoFechar(arquivo);
+  arquivoNaFlash = true;
+#endif
+}
+
+const EstatisticasFila& filaEstatisticas() {
+  return estatisticas;
+}
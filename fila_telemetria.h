@@ -0,0 +1,45 @@
+#pragma once
+
+#include "hal.h"
+
+// ==================== FILA DE TELEMETRIA (STORE-AND-FORWARD) ====================
+// Buffer circular de capacidade fixa com as médias de cada janela de envio.
+// Enche enquanto o WiFi está fora e é drenada em lotes na reconexão. Com
+// várias zonas a fila é uma só; cada lote leva as amostras de uma zona.
+
+#define CAPACIDADE_FILA_TELEMETRIA 240     // 240 x 15s = 1 hora offline (por zona enviada)
+#define FILA_PERSISTIR_FLASH 1             // 0 = somente RAM
+#define FILA_ARQUIVO "/fila_telemetria.bin"
+#define FILA_INTERVALO_PERSISTENCIA 4      // Grava na flash a cada N amostras
+
+struct AmostraAgregada {
+  unsigned long timestampMs;   // millis() do fechamento da janela
+  float temperatura;
+  float umidade;
+  int luminosidade;
+  int score;
+  uint8_t zona;                // Índice em zonas.h: escolhe o canal do ThingSpeak
+};
+
+enum PoliticaOverflow {
+  DESCARTAR_MAIS_ANTIGA,   // Mantém o histórico recente
+  DESCARTAR_MAIS_NOVA      // Preserva o início do período offline
+};
+
+struct EstatisticasFila {
+  unsigned long enfileiradas;
+  unsigned long enviadas;
+  unsigned long descartadasOverflow;
+  unsigned long restauradasFlash;
+  int ocupacaoMaxima;
+};
+
+void filaIniciar(PoliticaOverflow politica);
+bool filaEnfileirar(const AmostraAgregada& amostra);
+int filaTamanho();
+bool filaEspiar(int indice, AmostraAgregada& amostra);   // 0 = mais antiga
+void filaConfirmarEnvio(int quantidade);                 // Remove as N mais antigas
+void filaConfirmarEnvioDaZona(uint8_t zona, int quantidade);   // ...só as da zona, o resto fica na ordem
+void filaPersistir();
+void filaPersistirPendentes();   // Só se houver amostra fora da flash (antes do sono profundo)
+const EstatisticasFila& filaEstatisticas();
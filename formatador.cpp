@@ -0,0 +1,141 @@
+#include "formatador.h"
+
+#define CASAS_DECIMAIS_MAXIMAS 6
+
+EscritorTexto::EscritorTexto(char* destino, size_t cap)
+    : dados(destino), capacidade(cap), tam(0), truncado(false) {
+  if (capacidade > 0) dados[0] = '\0';
+}
+
+void EscritorTexto::limpar() {
+  tam = 0;
+  truncado = false;
+  if (capacidade > 0) dados[0] = '\0';
+}
+
+void EscritorTexto::anexar(const char* texto, size_t n) {
+  if (capacidade == 0) return;
+  size_t livre = capacidade - 1 - tam;
+  if (n > livre) {
+    n = livre;
+    truncado = true;
+  }
+  memcpy(dados + tam, texto, n);
+  tam += n;
+  dados[tam] = '\0';
+}
+
+EscritorTexto& EscritorTexto::operator<<(const char* texto) {
+  if (texto != nullptr) anexar(texto, strlen(texto));
+  return *this;
+}
+
+EscritorTexto& EscritorTexto::operator<<(char c) {
+  anexar(&c, 1);
+  return *this;
+}
+
+EscritorTexto& EscritorTexto::operator<<(int valor) {
+  return *this << (long)valor;
+}
+
+EscritorTexto& EscritorTexto::operator<<(unsigned int valor) {
+  return *this << (unsigned long)valor;
+}
+
+EscritorTexto& EscritorTexto::operator<<(long valor) {
+  char tmp[24];
+  anexar(tmp, formatarInteiro(tmp, sizeof(tmp), valor));
+  return *this;
+}
+
+EscritorTexto& EscritorTexto::operator<<(unsigned long valor) {
+  char tmp[24];
+  anexar(tmp, formatarSemSinal(tmp, sizeof(tmp), valor));
+  return *this;
+}
+
+EscritorTexto& EscritorTexto::operator<<(float valor) {
+  return *this << Decimal(valor, 2);
+}
+
+EscritorTexto& EscritorTexto::operator<<(const Decimal& valor) {
+  char tmp[32];
+  anexar(tmp, formatarDecimal(tmp, sizeof(tmp), valor.valor, valor.casas));
+  return *this;
+}
+
+size_t formatarSemSinal(char* destino, size_t capacidade, unsigned long valor) {
+  char invertido[24];
+  size_t n = 0;
+  do {
+    invertido[n++] = (char)('0' + valor % 10);
+    valor /= 10;
+  } while (valor > 0);
+
+  if (n + 1 > capacidade) return 0;
+  for (size_t i = 0; i < n; i++) {
+    destino[i] = invertido[n - 1 - i];
+  }
+  destino[n] = '\0';
+  return n;
+}
+
+size_t formatarInteiro(char* destino, size_t capacidade, long valor) {
+  if (valor >= 0) {
+    return formatarSemSinal(destino, capacidade, (unsigned long)valor);
+  }
+  if (capacidade < 2) return 0;
+  destino[0] = '-';
+  // -(valor + 1) + 1 evita overflow em LONG_MIN
+  size_t n = formatarSemSinal(destino + 1, capacidade - 1, (unsigned long)(-(valor + 1)) + 1);
+  return n == 0 ? 0 : n + 1;
+}
+
+size_t formatarDecimal(char* destino, size_t capacidade, float valor, int casas) {
+  const char* especial = nullptr;
+  if (isnan(valor)) especial = "nan";
+  else if (isinf(valor)) especial = valor > 0 ? "inf" : "-inf";
+  else if (fabsf(valor) >= 1e12f) especial = "ovf";   // Fora da faixa do arredondamento
+  if (especial != nullptr) {
+    size_t n = strlen(especial);
+    if (n + 1 > capacidade) return 0;
+    memcpy(destino, especial, n + 1);
+    return n;
+  }
+
+  if (casas < 0) casas = 0;
+  if (casas > CASAS_DECIMAIS_MAXIMAS) casas = CASAS_DECIMAIS_MAXIMAS;
+
+  unsigned long escala = 1;
+  for (int i = 0; i < casas; i++) escala *= 10;
+
+  bool negativo = valor < 0;
+  // Arredondamento em inteiro de 64 bits: cobre a faixa dos sensores
+  // com folga e não passa pelo dtoa
+  unsigned long long escalado = (unsigned long long)((negativo ? -valor : valor) * (double)escala + 0.5);
+  unsigned long parteInteira = (unsigned long)(escalado / escala);
+  unsigned long parteFracionaria = (unsigned long)(escalado % escala);
+
+  size_t pos = 0;
+  if (negativo && escalado != 0) {
+    if (capacidade < 2) return 0;
+    destino[pos++] = '-';
+  }
+
+  size_t n = formatarSemSinal(destino + pos, capacidade - pos, parteInteira);
+  if (n == 0) return 0;
+  pos += n;
+
+  if (casas > 0) {
+    if (pos + 1 + casas + 1 > capacidade) return 0;
+    destino[pos++] = '.';
+    for (int i = casas - 1; i >= 0; i--) {
+      destino[pos + i] = (char)('0' + parteFracionaria % 10);
+      parteFracionaria /= 10;
+    }
+    pos += casas;
+    destino[pos] = '\0';
+  }
+  return pos;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "hal.h"
+
+// ==================== FORMATADOR SEM HEAP ====================
+// Substitui a concatenação de String: o texto é montado em um buffer de
+// tamanho fixo (na pilha ou estático) e números, inclusive float, são
+// convertidos à mão, sem printf/dtoa (que alocam no newlib).
+// Se o buffer encher, o texto é truncado e foiTruncado() avisa.
+
+// Float com número fixo de casas decimais
+struct Decimal {
+  float valor;
+  int casas;
+  explicit Decimal(float v, int c = 2) : valor(v), casas(c) {}
+};
+
+// Escreve em um buffer externo; BufferTexto<N> fornece o armazenamento
+class EscritorTexto {
+ public:
+  EscritorTexto(char* destino, size_t capacidade);
+
+  void limpar();
+  const char* c_str() const { return dados; }
+  size_t tamanho() const { return tam; }
+  bool foiTruncado() const { return truncado; }
+
+  EscritorTexto& operator<<(const char* texto);
+  EscritorTexto& operator<<(char c);
+  EscritorTexto& operator<<(int valor);
+  EscritorTexto& operator<<(unsigned int valor);
+  EscritorTexto& operator<<(long valor);
+  EscritorTexto& operator<<(unsigned long valor);
+  EscritorTexto& operator<<(float valor);         // 2 casas, como String(float)
+  EscritorTexto& operator<<(const Decimal& valor);
+
+  void anexar(const char* texto, size_t n);
+
+ private:
+  char* dados;
+  size_t capacidade;
+  size_t tam;
+  bool truncado;
+};
+
+template <size_t N>
+class BufferTexto : public EscritorTexto {
+ public:
+  BufferTexto() : EscritorTexto(armazenamento, N) {}
+  BufferTexto(const BufferTexto& outro) : EscritorTexto(armazenamento, N) {
+    anexar(outro.c_str(), outro.tamanho());
+  }
+  BufferTexto& operator=(const BufferTexto& outro) {
+    if (this != &outro) {
+      limpar();
+      anexar(outro.c_str(), outro.tamanho());
+    }
+    return *this;
+  }
+
+ private:
+  char armazenamento[N];
+};
+
+// Conversões básicas: retornam quantos caracteres foram escritos
+// (sem contar o '\0'), ou 0 se não couber
+size_t formatarInteiro(char* destino, size_t capacidade, long valor);
+size_t formatarSemSinal(char* destino, size_t capacidade, unsigned long valor);
+size_t formatarDecimal(char* destino, size_t capacidade, float valor, int casas);
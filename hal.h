@@ -0,0 +1,205 @@
+#pragma once
+
+// ==================== HAL - CAMADA DE ABSTRAÇÃO DE HARDWARE ====================
+// Tudo que a lógica do WellWork precisa do ESP32 passa por aqui: tempo,
+// GPIO, ADC, buzzer, DHT22, serial, WiFi, TCP, flash, heap, tarefas e sono.
+// hal_esp32.cpp implementa sobre o core Arduino; host/hal_host.cpp
+// implementa no Linux com relógio virtual e sensores simulados.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <WiFi.h>
+#else
+#include <algorithm>
+#include <mutex>
+using std::max;
+using std::min;
+#define HIGH 1
+#define LOW 0
+#endif
+
+// ---------- Tempo ----------
+// halMillis()/halMicros() continuam contando através do sono profundo
+unsigned long halMillis();
+unsigned long halMicros();
+void halDelay(unsigned long ms);   // Cede a CPU (no host avança o relógio virtual)
+
+// Contador de ciclos da CPU para medir trechos curtos. No host conta
+// nanossegundos de relógio real (não o virtual), então halCiclosPorUs() = 1000.
+uint32_t halCiclos();
+uint32_t halCiclosPorUs();
+
+// ---------- GPIO / buzzer ----------
+void halPinoSaida(int pino);
+void halEscreverDigital(int pino, int nivel);
+void halTocar(int pino, unsigned int frequencia, unsigned long duracaoMs);
+void halSilenciar(int pino);
+
+// ---------- ADC contínuo ----------
+// Conversões em segundo plano (DMA no ESP32, só ADC1). Os pinos entram em
+// rodízio e a taxa é dividida entre eles. halAdcContinuoLer() não
+// bloqueia: copia as conversões acumuladas desde a chamada anterior, até
+// as HAL_ADC_CONTINUO_MAX_CONVERSOES mais recentes (o anel do DMA
+// sobrescreve as mais antigas), com o índice do pino de cada uma.
+#define HAL_ADC_CONTINUO_MAX_CONVERSOES 256
+#define HAL_ADC_CONTINUO_MAX_PINOS 8       // Canais do ADC1
+
+bool halAdcContinuoIniciar(const int* pinos, int totalPinos, uint32_t conversoesPorSegundo);
+size_t halAdcContinuoLer(uint16_t* destino, uint8_t* indicePino, size_t capacidade);
+
+// ---------- DHT22 ----------
+// Transação sem bloqueio: halDhtIniciarLeitura() dá o pulso de start e
+// arma a captura das bordas; halDhtColetar() devolve os 5 bytes do quadro
+// (sem conferir o checksum) quando a janela da transação termina. Vários
+// sensores dividem a captura, uma transação por vez.
+enum EstadoQuadroDht {
+  DHT_QUADRO_PENDENTE,
+  DHT_QUADRO_PRONTO,
+  DHT_QUADRO_SEM_RESPOSTA
+};
+
+void halDhtIniciar(int pino);              // Uma vez por sensor
+bool halDhtIniciarLeitura(int pino);       // false = já há uma transação em curso
+EstadoQuadroDht halDhtColetar(uint8_t quadro[5]);
+
+// ---------- Serial ----------
+void halSerialIniciar(unsigned long baud, size_t tamanhoBufferTx);
+int halSerialEspacoLivre();
+size_t halSerialEscrever(const uint8_t* dados, size_t tamanho);
+void halSerialDescarregar();
+
+// ---------- WiFi ----------
+enum EventoHalWiFi {
+  HAL_WIFI_GOT_IP,
+  HAL_WIFI_DESCONECTADO
+};
+typedef void (*CallbackHalWiFi)(EventoHalWiFi evento);
+
+void halWiFiIniciar(CallbackHalWiFi callback);     // Modo STA, sem auto-reconnect
+// Liga o rádio se preciso. Depois da primeira associação reaproveita canal
+// e BSSID (guardados na RTC) e pula a varredura
+void halWiFiConectar(const char* ssid, const char* senha);
+void halWiFiDesligar();                            // Desassocia e desliga o rádio
+bool halWiFiConectado();
+int halWiFiRssi();
+void halWiFiIp(uint8_t ip[4]);
+bool halResolverHost(const char* host, uint8_t ip[4]);
+
+// ---------- TCP ----------
+class HalClienteTcp {
+ public:
+  bool conectar(const uint8_t ip[4], uint16_t porta);
+  bool conectado();
+  int disponivel();
+  int ler();
+  size_t lerDisponivel(uint8_t* destino, size_t capacidade);   // Não espera: só o que já chegou
+  size_t escrever(const uint8_t* dados, size_t tamanho);
+  void fechar();
+
+ private:
+#ifdef ARDUINO
+  WiFiClient cliente;
+#else
+  int descritor = -1;
+#endif
+  friend class HalServidorTcp;
+};
+
+// Escuta sem bloquear: aceitar() entrega uma conexão pendente, se houver.
+// No host escuta só no loopback, e a porta 0 pede uma livre ao sistema
+class HalServidorTcp {
+ public:
+  bool iniciar(uint16_t porta);
+  bool aceitar(HalClienteTcp& cliente);
+  uint16_t porta();
+  void parar();
+
+ private:
+#ifdef ARDUINO
+  WiFiServer* servidor = nullptr;   // O construtor do WiFiServer já pede a porta
+#else
+  int descritor = -1;
+#endif
+  uint16_t portaEscuta = 0;
+};
+
+// ---------- Armazenamento (LittleFS) ----------
+bool halArmazenamentoIniciar();
+int halArquivoAbrir(const char* caminho, bool escrita);   // -1 em falha
+int halArquivoAnexar(const char* caminho);                // Escrita no fim; cria se não existe
+size_t halArquivoLer(int arquivo, void* destino, size_t tamanho);
+size_t halArquivoEscrever(int arquivo, const void* origem, size_t tamanho);
+bool halArquivoPosicionar(int arquivo, size_t posicao);   // Só na leitura
+size_t halArquivoTamanho(int arquivo);
+void halArquivoFechar(int arquivo);
+bool halArquivoRemover(const char* caminho);
+
+// ---------- Heap ----------
+uint32_t halHeapLivre();
+uint32_t halHeapMinimoLivre();
+uint32_t halHeapMaiorBloco();
+uint32_t halHeapBytesAlocados();   // Total pedido desde o boot; 0 sem heap tracing (ESP32)
+
+// ---------- Tarefas e exclusão mútua ----------
+typedef void (*FuncaoPassoTarefa)();
+
+// Executa passo() a cada periodoMs em uma tarefa própria, fixada no núcleo
+// indicado. No host o passo roda cooperativamente dentro do halDelay().
+bool halCriarTarefa(FuncaoPassoTarefa passo, const char* nome, uint32_t pilhaBytes,
+                    int prioridade, int nucleo, unsigned long periodoMs);
+
+struct HalMutex {
+#ifdef ARDUINO
+  portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+#else
+  std::mutex mutex;
+#endif
+};
+
+void halTravar(HalMutex& m);
+void halDestravar(HalMutex& m);
+
+// Folga das pilhas (marca d'água: bytes nunca usados desde a criação) da
+// tarefa que chama - o loop(), que vem primeiro - e das criadas com
+// halCriarTarefa(). Varre a pilha: para o relatório, não para o tick. No
+// host não há pilhas separadas e retorna 0
+struct HalPilhaTarefa {
+  const char* nome;
+  uint32_t tamanho;       // Bytes
+  uint32_t folgaMinima;   // Bytes
+};
+
+int halPilhasTarefas(HalPilhaTarefa* destino, int capacidade);
+
+// ---------- Watchdog das tarefas ----------
+// Depois de halWatchdogIniciar(), toda tarefa que chamar
+// halWatchdogAlimentar() uma vez passa a ser vigiada e precisa voltar a
+// chamar dentro do prazo, senão o ESP32 reinicia. As de halCriarTarefa()
+// alimentam sozinhas a cada passo. No host nada reinicia: os atrasos só
+// são contados (SaidasSimulacao)
+bool halWatchdogIniciar(unsigned long prazoMs);
+void halWatchdogAlimentar();
+bool halReiniciouPeloWatchdog();   // O boot anterior terminou num watchdog
+
+// ---------- Sono ----------
+// Variáveis HAL_RETIDO ficam na memória RTC (8 KB no ESP32) e sobrevivem ao
+// sono profundo; o resto da RAM volta ao estado do boot. No host o
+// processo não reinicia e a macro não faz nada.
+#ifdef ARDUINO
+#define HAL_RETIDO RTC_DATA_ATTR
+#else
+#define HAL_RETIDO
+#endif
+
+void halDormirLeve(unsigned long ms);                  // RAM e GPIO mantidos; WiFi deve estar desligado
+[[noreturn]] void halDormirProfundo(unsigned long ms); // Volta pelo setup()
+bool halDespertouDoSonoProfundo();                     // Este boot veio de halDormirProfundo()
+
+// ---------- Diversos ----------
+long halAleatorio(long minimo, long maximoExclusivo);
@@ -0,0 +1,555 @@
+// Implementação da HAL sobre o core Arduino do ESP32
+#ifdef ARDUINO
+
+#include "hal.h"
+
+#include <LittleFS.h>
+#include <esp_adc/adc_continuous.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
+#include <esp_task_wdt.h>
+#include <esp_timer.h>
+
+// ---------- Tempo ----------
+// O esp_timer zera a cada boot; o tempo dos boots anteriores e do sono
+// profundo fica na RTC para o relógio não voltar ao despertar
+static HAL_RETIDO uint64_t usAntesDoBoot = 0;
+
+static uint64_t agoraUs() {
+  return usAntesDoBoot + (uint64_t)esp_timer_get_time();
+}
+
+unsigned long halMillis() {
+  return (unsigned long)(agoraUs() / 1000);
+}
+
+unsigned long halMicros() {
+  return (unsigned long)agoraUs();
+}
+
+void halDelay(unsigned long ms) {
+  delay(ms);
+}
+
+uint32_t halCiclos() {
+  return ESP.getCycleCount();
+}
+
+uint32_t halCiclosPorUs() {
+  return ESP.getCpuFreqMHz();
+}
+
+// ---------- GPIO / buzzer ----------
+void halPinoSaida(int pino) {
+  pinMode(pino, OUTPUT);
+}
+
+void halEscreverDigital(int pino, int nivel) {
+  digitalWrite(pino, nivel);
+}
+
+void halTocar(int pino, unsigned int frequencia, unsigned long duracaoMs) {
+  tone(pino, frequencia, duracaoMs);
+}
+
+void halSilenciar(int pino) {
+  noTone(pino);
+}
+
+// ---------- ADC contínuo ----------
+// Driver adc_continuous do IDF: o DMA enche quadros de HAL_ADC_QUADRO_BYTES
+// e o driver guarda até HAL_ADC_ANEL_BYTES; o que passa disso é descartado
+#define HAL_ADC_BYTES_POR_CONVERSAO SOC_ADC_DIGI_RESULT_BYTES
+#define HAL_ADC_QUADRO_BYTES (64 * HAL_ADC_BYTES_POR_CONVERSAO)
+#define HAL_ADC_ANEL_BYTES (HAL_ADC_CONTINUO_MAX_CONVERSOES * HAL_ADC_BYTES_POR_CONVERSAO)
+
+static adc_continuous_handle_t adcContinuo = nullptr;
+static int8_t indiceDoCanal[16];   // Canal do ADC1 (4 bits no TYPE1) -> índice do pino
+
+bool halAdcContinuoIniciar(const int* pinos, int totalPinos, uint32_t conversoesPorSegundo) {
+  if (adcContinuo != nullptr) return true;
+  if (totalPinos <= 0 || totalPinos > HAL_ADC_CONTINUO_MAX_PINOS) return false;
+
+  // Um item do padrão por pino: o DMA converte em rodízio
+  adc_digi_pattern_config_t padrao[HAL_ADC_CONTINUO_MAX_PINOS] = {};
+  memset(indiceDoCanal, -1, sizeof(indiceDoCanal));
+  for (int i = 0; i < totalPinos; i++) {
+    adc_unit_t unidade;
+    adc_channel_t canal;
+    if (adc_continuous_io_to_channel(pinos[i], &unidade, &canal) != ESP_OK || unidade != ADC_UNIT_1) {
+      return false;
+    }
+    padrao[i].atten = ADC_ATTEN_DB_12;   // Faixa cheia (~0-3,1 V), como o analogRead()
+    padrao[i].channel = canal;
+    padrao[i].unit = unidade;
+    padrao[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    indiceDoCanal[canal] = (int8_t)i;
+  }
+
+  adc_continuous_handle_cfg_t configDriver = {};
+  configDriver.max_store_buf_size = HAL_ADC_ANEL_BYTES;
+  configDriver.conv_frame_size = HAL_ADC_QUADRO_BYTES;
+  if (adc_continuous_new_handle(&configDriver, &adcContinuo) != ESP_OK) return false;
+
+  adc_continuous_config_t config = {};
+  config.pattern_num = totalPinos;
+  config.adc_pattern = padrao;
+  config.sample_freq_hz = max(conversoesPorSegundo, (uint32_t)SOC_ADC_SAMPLE_FREQ_THRES_LOW);
+  config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+  config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+
+  if (adc_continuous_config(adcContinuo, &config) != ESP_OK ||
+      adc_continuous_start(adcContinuo) != ESP_OK) {
+    adc_continuous_deinit(adcContinuo);
+    adcContinuo = nullptr;
+    return false;
+  }
+  return true;
+}
+
+size_t halAdcContinuoLer(uint16_t* destino, uint8_t* indicePino, size_t capacidade) {
+  if (adcContinuo == nullptr) return 0;
+
+  static uint8_t bruto[HAL_ADC_QUADRO_BYTES];
+  size_t total = 0;
+  uint32_t lidos = 0;
+  // Timeout 0: só o que já está no anel
+  while (total < capacidade &&
+         adc_continuous_read(adcContinuo, bruto, sizeof(bruto), &lidos, 0) == ESP_OK) {
+    for (uint32_t i = 0; i + HAL_ADC_BYTES_POR_CONVERSAO <= lidos && total < capacidade;
+         i += HAL_ADC_BYTES_POR_CONVERSAO) {
+      const adc_digi_output_data_t* conversao = (const adc_digi_output_data_t*)&bruto[i];
+      int8_t indice = indiceDoCanal[conversao->type1.channel];
+      if (indice < 0) continue;
+      indicePino[total] = (uint8_t)indice;
+      destino[total++] = conversao->type1.data;
+    }
+  }
+  return total;
+}
+
+// ---------- DHT22 ----------
+// Captura por borda: o ISR só carimba o tempo e o nível de cada borda, em
+// vez de ler os 40 bits com as interrupções desligadas por ~5 ms como a
+// biblioteca DHT. A decodificação roda depois, fora do ISR.
+#define DHT_PULSO_INICIO_US 1100     // Start: linha em LOW por >= 1 ms
+#define DHT_JANELA_QUADRO_US 6000    // Start + resposta + 40 bits, com folga
+#define DHT_MAX_BORDAS 96            // Soltura + resposta + 80 bordas de dados
+#define DHT_LIMIAR_BIT_UM_US 50      // Nível alto: ~27 us = 0, ~70 us = 1
+
+static int pinoDht = -1;
+static esp_timer_handle_t temporizadorDht = nullptr;
+static volatile uint32_t bordasDhtUs[DHT_MAX_BORDAS];
+static volatile uint8_t niveisDht[DHT_MAX_BORDAS];
+static volatile int totalBordasDht = 0;
+static int64_t inicioLeituraDhtUs = 0;
+static bool leituraDhtEmCurso = false;
+
+static void IRAM_ATTR aoBordaDht() {
+  int i = totalBordasDht;
+  if (i >= DHT_MAX_BORDAS) return;
+  bordasDhtUs[i] = (uint32_t)esp_timer_get_time();
+  niveisDht[i] = digitalRead(pinoDht);
+  totalBordasDht = i + 1;
+}
+
+// Fim do pulso de start (task do esp_timer): solta a linha para o sensor
+static void liberarLinhaDht(void*) {
+  attachInterrupt(digitalPinToInterrupt(pinoDht), aoBordaDht, CHANGE);
+  pinMode(pinoDht, INPUT_PULLUP);
+}
+
+void halDhtIniciar(int pino) {
+  pinMode(pino, INPUT_PULLUP);
+  if (temporizadorDht == nullptr) {
+    esp_timer_create_args_t args = {};
+    args.callback = liberarLinhaDht;
+    args.name = "dht";
+    esp_timer_create(&args, &temporizadorDht);
+  }
+}
+
+bool halDhtIniciarLeitura(int pino) {
+  if (leituraDhtEmCurso) return false;
+  pinoDht = pino;   // O ISR e a soltura da linha usam o pino da transação
+  totalBordasDht = 0;
+  pinMode(pinoDht, OUTPUT);
+  digitalWrite(pinoDht, LOW);
+  inicioLeituraDhtUs = esp_timer_get_time();
+  leituraDhtEmCurso = true;
+  esp_timer_start_once(temporizadorDht, DHT_PULSO_INICIO_US);
+  return true;
+}
+
+EstadoQuadroDht halDhtColetar(uint8_t quadro[5]) {
+  if (!leituraDhtEmCurso) return DHT_QUADRO_SEM_RESPOSTA;
+  if (esp_timer_get_time() - inicioLeituraDhtUs < DHT_JANELA_QUADRO_US) return DHT_QUADRO_PENDENTE;
+  detachInterrupt(digitalPinToInterrupt(pinoDht));
+  leituraDhtEmCurso = false;
+
+  // Os bits são os 40 últimos pulsos em nível alto completos; antes deles
+  // vêm a soltura da linha e os 80 us da resposta do sensor
+  uint8_t larguras[DHT_MAX_BORDAS / 2];
+  int pulsos = 0;
+  for (int i = 0; i + 1 < totalBordasDht; i++) {
+    if (niveisDht[i] == HIGH && niveisDht[i + 1] == LOW) {
+      uint32_t largura = bordasDhtUs[i + 1] - bordasDhtUs[i];
+      larguras[pulsos++] = (uint8_t)min(largura, (uint32_t)255);
+    }
+  }
+  if (pulsos < 40) return DHT_QUADRO_SEM_RESPOSTA;
+
+  memset(quadro, 0, 5);
+  for (int b = 0; b < 40; b++) {
+    if (larguras[pulsos - 40 + b] > DHT_LIMIAR_BIT_UM_US) {
+      quadro[b / 8] |= 0x80 >> (b % 8);
+    }
+  }
+  return DHT_QUADRO_PRONTO;
+}
+
+// ---------- Serial ----------
+void halSerialIniciar(unsigned long baud, size_t tamanhoBufferTx) {
+  // Precisa vir antes do begin()
+  Serial.setTxBufferSize(tamanhoBufferTx);
+  Serial.begin(baud);
+}
+
+int halSerialEspacoLivre() {
+  return Serial.availableForWrite();
+}
+
+size_t halSerialEscrever(const uint8_t* dados, size_t tamanho) {
+  return Serial.write(dados, tamanho);
+}
+
+void halSerialDescarregar() {
+  Serial.flush();
+}
+
+// ---------- WiFi ----------
+static CallbackHalWiFi callbackWiFi = nullptr;
+
+// Canal e BSSID da última associação: a reconexão depois do sono vai
+// direto ao AP, sem varredura (de ~1-3 s para algumas centenas de ms)
+static HAL_RETIDO int32_t canalRetido = 0;
+static HAL_RETIDO uint8_t bssidRetido[6];
+static volatile bool associando = false;
+
+static void aoEventoWiFi(arduino_event_id_t evento, arduino_event_info_t info) {
+  (void)info;
+  switch (evento) {
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      associando = false;
+      canalRetido = WiFi.channel();
+      memcpy(bssidRetido, WiFi.BSSID(), sizeof(bssidRetido));
+      if (callbackWiFi) callbackWiFi(HAL_WIFI_GOT_IP);
+      break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+    case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+      // AP mudou de canal: a próxima tentativa volta a varrer
+      if (associando) canalRetido = 0;
+      if (callbackWiFi) callbackWiFi(HAL_WIFI_DESCONECTADO);
+      break;
+    default:
+      break;
+  }
+}
+
+void halWiFiIniciar(CallbackHalWiFi callback) {
+  callbackWiFi = callback;
+  WiFi.setAutoReconnect(false);
+  WiFi.onEvent(aoEventoWiFi, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  WiFi.onEvent(aoEventoWiFi, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  WiFi.onEvent(aoEventoWiFi, ARDUINO_EVENT_WIFI_STA_LOST_IP);
+}
+
+void halWiFiConectar(const char* ssid, const char* senha) {
+  // Tentativa anterior sem IP (timeout): o canal guardado não serve mais
+  if (associando) canalRetido = 0;
+  associando = true;
+
+  WiFi.mode(WIFI_STA);
+  WiFi.disconnect();
+  if (canalRetido > 0) {
+    WiFi.begin(ssid, senha, canalRetido, bssidRetido);
+  } else {
+    WiFi.begin(ssid, senha);
+  }
+}
+
+void halWiFiDesligar() {
+  associando = false;
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);
+}
+
+bool halWiFiConectado() {
+  return WiFi.status() == WL_CONNECTED;
+}
+
+int halWiFiRssi() {
+  return WiFi.RSSI();
+}
+
+void halWiFiIp(uint8_t ip[4]) {
+  IPAddress endereco = WiFi.localIP();
+  for (int i = 0; i < 4; i++) ip[i] = endereco[i];
+}
+
+bool halResolverHost(const char* host, uint8_t ip[4]) {
+  IPAddress endereco;
+  if (!WiFi.hostByName(host, endereco)) return false;
+  for (int i = 0; i < 4; i++) ip[i] = endereco[i];
+  return true;
+}
+
+// ---------- TCP ----------
+bool HalClienteTcp::conectar(const uint8_t ip[4], uint16_t porta) {
+  cliente.stop();
+  if (!cliente.connect(IPAddress(ip[0], ip[1], ip[2], ip[3]), porta)) {
+    return false;
+  }
+  cliente.setNoDelay(true);
+  return true;
+}
+
+bool HalClienteTcp::conectado() {
+  return cliente.connected();
+}
+
+int HalClienteTcp::disponivel() {
+  return cliente.available();
+}
+
+int HalClienteTcp::ler() {
+  return cliente.read();
+}
+
+size_t HalClienteTcp::escrever(const uint8_t* dados, size_t tamanho) {
+  return cliente.write(dados, tamanho);
+}
+
+size_t HalClienteTcp::lerDisponivel(uint8_t* destino, size_t capacidade) {
+  int n = cliente.available();
+  if (n <= 0) return 0;
+  int lidos = cliente.read(destino, min((size_t)n, capacidade));
+  return lidos > 0 ? (size_t)lidos : 0;
+}
+
+void HalClienteTcp::fechar() {
+  cliente.stop();
+}
+
+bool HalServidorTcp::iniciar(uint16_t porta) {
+  parar();
+  // Alocado uma vez por boot: o servidor vive até o próximo
+  servidor = new WiFiServer(porta);
+  servidor->begin();
+  servidor->setNoDelay(true);
+  portaEscuta = porta;
+  return true;
+}
+
+bool HalServidorTcp::aceitar(HalClienteTcp& cliente) {
+  if (servidor == nullptr) return false;
+  WiFiClient novo = servidor->accept();
+  if (!novo) return false;
+  cliente.cliente = novo;
+  return true;
+}
+
+uint16_t HalServidorTcp::porta() {
+  return portaEscuta;
+}
+
+void HalServidorTcp::parar() {
+  if (servidor == nullptr) return;
+  servidor->end();
+  delete servidor;
+  servidor = nullptr;
+  portaEscuta = 0;
+}
+
+// ---------- Armazenamento ----------
+#define HAL_MAX_ARQUIVOS 4
+static File arquivos[HAL_MAX_ARQUIVOS];
+
+bool halArmazenamentoIniciar() {
+  return LittleFS.begin(true);
+}
+
+static int abrirArquivo(const char* caminho, const char* modo) {
+  for (int i = 0; i < HAL_MAX_ARQUIVOS; i++) {
+    if (!arquivos[i]) {
+      arquivos[i] = LittleFS.open(caminho, modo);
+      return arquivos[i] ? i : -1;
+    }
+  }
+  return -1;
+}
+
+int halArquivoAbrir(const char* caminho, bool escrita) {
+  return abrirArquivo(caminho, escrita ? "w" : "r");
+}
+
+int halArquivoAnexar(const char* caminho) {
+  return abrirArquivo(caminho, "a");
+}
+
+size_t halArquivoLer(int arquivo, void* destino, size_t tamanho) {
+  if (arquivo < 0 || arquivo >= HAL_MAX_ARQUIVOS) return 0;
+  return arquivos[arquivo].read((uint8_t*)destino, tamanho);
+}
+
+size_t halArquivoEscrever(int arquivo, const void* origem, size_t tamanho) {
+  if (arquivo < 0 || arquivo >= HAL_MAX_ARQUIVOS) return 0;
+  return arquivos[arquivo].write((const uint8_t*)origem, tamanho);
+}
+
+bool halArquivoPosicionar(int arquivo, size_t posicao) {
+  if (arquivo < 0 || arquivo >= HAL_MAX_ARQUIVOS) return false;
+  return arquivos[arquivo].seek(posicao);
+}
+
+size_t halArquivoTamanho(int arquivo) {
+  if (arquivo < 0 || arquivo >= HAL_MAX_ARQUIVOS) return 0;
+  return arquivos[arquivo].size();
+}
+
+void halArquivoFechar(int arquivo) {
+  if (arquivo < 0 || arquivo >= HAL_MAX_ARQUIVOS) return;
+  arquivos[arquivo].close();
+  arquivos[arquivo] = File();
+}
+
+bool halArquivoRemover(const char* caminho) {
+  return LittleFS.remove(caminho);
+}
+
+// ---------- Heap ----------
+uint32_t halHeapLivre() {
+  return ESP.getFreeHeap();
+}
+
+uint32_t halHeapMinimoLivre() {
+  return ESP.getMinFreeHeap();
+}
+
+uint32_t halHeapMaiorBloco() {
+  return ESP.getMaxAllocHeap();
+}
+
+uint32_t halHeapBytesAlocados() {
+  return 0;
+}
+
+// ---------- Tarefas e exclusão mútua ----------
+#define HAL_MAX_TAREFAS 4
+
+struct DescritorTarefa {
+  FuncaoPassoTarefa passo;
+  unsigned long periodoMs;
+  const char* nome;
+  uint32_t pilhaBytes;
+  TaskHandle_t handle;
+};
+
+static DescritorTarefa* tarefas[HAL_MAX_TAREFAS] = {};
+static int totalTarefas = 0;
+
+static void executarTarefa(void* parametro) {
+  DescritorTarefa* d = (DescritorTarefa*)parametro;
+  for (;;) {
+    d->passo();
+    halWatchdogAlimentar();
+    vTaskDelay(pdMS_TO_TICKS(d->periodoMs));
+  }
+}
+
+bool halCriarTarefa(FuncaoPassoTarefa passo, const char* nome, uint32_t pilhaBytes,
+                    int prioridade, int nucleo, unsigned long periodoMs) {
+  if (totalTarefas >= HAL_MAX_TAREFAS) return false;
+  // Alocado uma vez no boot e nunca liberado: a tarefa vive para sempre
+  DescritorTarefa* d = new DescritorTarefa{ passo, periodoMs, nome, pilhaBytes, nullptr };
+  if (xTaskCreatePinnedToCore(executarTarefa, nome, pilhaBytes, d,
+                              prioridade, &d->handle, nucleo) != pdPASS) {
+    delete d;
+    return false;
+  }
+  tarefas[totalTarefas++] = d;
+  return true;
+}
+
+// No ESP-IDF a marca d'água já vem em bytes
+int halPilhasTarefas(HalPilhaTarefa* destino, int capacidade) {
+  int total = 0;
+  if (total < capacidade) {
+    destino[total++] = { "loop", (uint32_t)getArduinoLoopTaskStackSize(),
+                         (uint32_t)uxTaskGetStackHighWaterMark(nullptr) };
+  }
+  for (int i = 0; i < totalTarefas && total < capacidade; i++) {
+    destino[total++] = { tarefas[i]->nome, tarefas[i]->pilhaBytes,
+                         (uint32_t)uxTaskGetStackHighWaterMark(tarefas[i]->handle) };
+  }
+  return total;
+}
+
+void halTravar(HalMutex& m) {
+  portENTER_CRITICAL(&m.mux);
+}
+
+void halDestravar(HalMutex& m) {
+  portEXIT_CRITICAL(&m.mux);
+}
+
+// ---------- Watchdog das tarefas ----------
+// O core 3.x já inicia o TWDT (só vigiando as tarefas ociosas): aqui ele
+// é reconfigurado com o prazo do sketch e vigia só quem se assinar
+static bool watchdogAtivo = false;
+
+bool halWatchdogIniciar(unsigned long prazoMs) {
+  esp_task_wdt_config_t config = {};
+  config.timeout_ms = prazoMs;
+  config.idle_core_mask = 0;
+  config.trigger_panic = true;   // Reinicia (com o motivo no próximo boot)
+  esp_err_t erro = esp_task_wdt_reconfigure(&config);
+  if (erro == ESP_ERR_INVALID_STATE) erro = esp_task_wdt_init(&config);
+  watchdogAtivo = erro == ESP_OK;
+  return watchdogAtivo;
+}
+
+void halWatchdogAlimentar() {
+  if (!watchdogAtivo) return;
+  // Primeira alimentação desta tarefa: assina (já conta como alimentada)
+  if (esp_task_wdt_reset() == ESP_ERR_NOT_FOUND) esp_task_wdt_add(nullptr);
+}
+
+bool halReiniciouPeloWatchdog() {
+  esp_reset_reason_t motivo = esp_reset_reason();
+  return motivo == ESP_RST_TASK_WDT || motivo == ESP_RST_INT_WDT || motivo == ESP_RST_WDT;
+}
+
+// ---------- Sono ----------
+// O esp_timer é compensado no sono leve; só o profundo mexe no deslocamento
+void halDormirLeve(unsigned long ms) {
+  esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+  esp_light_sleep_start();
+}
+
+void halDormirProfundo(unsigned long ms) {
+  usAntesDoBoot = agoraUs() + (uint64_t)ms * 1000;
+  esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+  esp_deep_sleep_start();
+}
+
+bool halDespertouDoSonoProfundo() {
+  return esp_reset_reason() == ESP_RST_DEEPSLEEP;
+}
+
+// ---------- Diversos ----------
+long halAleatorio(long minimo, long maximoExclusivo) {
+  return random(minimo, maximoExclusivo);
+}
+
+#endif  // ARDUINO
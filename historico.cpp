@@ -0,0 +1,409 @@
+#include "historico.h"
+
+#include "formatador.h"
+#include "log.h"
+
+#define HISTORICO_MAGICO 0x5748   // "HW"
+#define HISTORICO_VERSAO 1
+
+// Larguras dos códigos: prefixo 0 = sem mudança, 10 = curto, 110 = longo,
+// 111 = 32 bits. O tempo varia pouco entre envios (15 s fixos), os valores
+// andam em décimos
+#define LARGURA_TEMPO_CURTA 7
+#define LARGURA_TEMPO_LONGA 12
+#define LARGURA_VALOR_CURTA 6
+#define LARGURA_VALOR_LONGA 13
+
+struct CabecalhoBloco {
+  uint32_t tempoInicialS;
+  uint32_t tempoFinalS;
+  uint16_t magico;
+  uint16_t amostras;
+  uint16_t bits;           // Usados em dados[]
+  int16_t temperatura;     // Primeira amostra
+  uint16_t umidade;
+  uint16_t luminosidade;
+  uint8_t score;
+  uint8_t versao;
+  uint16_t reservado;
+};
+
+#define HISTORICO_BYTES_DADOS (HISTORICO_TAMANHO_BLOCO - sizeof(CabecalhoBloco))
+
+struct BlocoHistorico {
+  CabecalhoBloco cab;
+  uint8_t dados[HISTORICO_BYTES_DADOS];
+};
+static_assert(sizeof(BlocoHistorico) == HISTORICO_TAMANHO_BLOCO, "bloco sem preenchimento");
+
+// Amostra já quantizada, como fica no bloco
+struct AmostraHistorico {
+  uint32_t tempoS;
+  int32_t temperatura;     // Décimos de °C
+  int32_t umidade;         // Décimos de %
+  int32_t luminosidade;
+  int32_t score;
+};
+
+struct IndiceSegmento {
+  uint32_t tempoInicialS;
+  uint32_t tempoFinalS;
+  uint16_t blocos;
+  bool fechado;            // Cheio, ou com um bloco pela metade no fim
+};
+
+// Estado de montagem: sobrevive ao sono profundo, como o resto da RTC
+static HAL_RETIDO BlocoHistorico bloco;
+static HAL_RETIDO AmostraHistorico anterior;
+static HAL_RETIDO int32_t deltaTempoAnterior;
+static HAL_RETIDO IndiceSegmento indice[HISTORICO_SEGMENTOS];
+static HAL_RETIDO int segmentoAtual;
+static HAL_RETIDO uint32_t deslocamentoS;
+static HAL_RETIDO EstatisticasHistorico stats;
+static bool flashDisponivel = false;
+
+// ==================== BITS ====================
+struct CursorBits {
+  uint8_t* dados;
+  uint16_t posicao;
+  uint16_t capacidade;     // Em bits
+  bool estourou;
+};
+
+static void escreverBits(CursorBits& c, uint32_t valor, int largura) {
+  if (c.estourou || c.posicao + largura > c.capacidade) {
+    c.estourou = true;
+    return;
+  }
+  for (int i = largura - 1; i >= 0; i--, c.posicao++) {
+    uint8_t mascara = 0x80 >> (c.posicao & 7);
+    if ((valor >> i) & 1) c.dados[c.posicao >> 3] |= mascara;
+    else c.dados[c.posicao >> 3] &= ~mascara;
+  }
+}
+
+static uint32_t lerBits(CursorBits& c, int largura) {
+  uint32_t valor = 0;
+  if (c.posicao + largura > c.capacidade) {
+    c.estourou = true;
+    return 0;
+  }
+  for (int i = 0; i < largura; i++, c.posicao++) {
+    valor = (valor << 1) | ((c.dados[c.posicao >> 3] >> (7 - (c.posicao & 7))) & 1);
+  }
+  return valor;
+}
+
+// Zigzag: negativos pequenos também viram números pequenos
+static void escreverVariavel(CursorBits& c, int32_t valor, int larguraCurta, int larguraLonga) {
+  uint32_t z = ((uint32_t)valor << 1) ^ (uint32_t)(valor >> 31);
+  if (z == 0) {
+    escreverBits(c, 0, 1);
+  } else if (z < (1UL << larguraCurta)) {
+    escreverBits(c, 0x2, 2);
+    escreverBits(c, z, larguraCurta);
+  } else if (z < (1UL << larguraLonga)) {
+    escreverBits(c, 0x6, 3);
+    escreverBits(c, z, larguraLonga);
+  } else {
+    escreverBits(c, 0x7, 3);
+    escreverBits(c, z, 32);
+  }
+}
+
+static int32_t lerVariavel(CursorBits& c, int larguraCurta, int larguraLonga) {
+  uint32_t z;
+  if (lerBits(c, 1) == 0) return 0;
+  if (lerBits(c, 1) == 0) z = lerBits(c, larguraCurta);
+  else if (lerBits(c, 1) == 0) z = lerBits(c, larguraLonga);
+  else z = lerBits(c, 32);
+  return (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+}
+
+// ==================== BLOCO ====================
+static void iniciarBloco(const AmostraHistorico& a) {
+  memset(&bloco, 0, sizeof(bloco));
+  bloco.cab.magico = HISTORICO_MAGICO;
+  bloco.cab.versao = HISTORICO_VERSAO;
+  bloco.cab.tempoInicialS = a.tempoS;
+  bloco.cab.tempoFinalS = a.tempoS;
+  bloco.cab.amostras = 1;
+  bloco.cab.temperatura = (int16_t)a.temperatura;
+  bloco.cab.umidade = (uint16_t)a.umidade;
+  bloco.cab.luminosidade = (uint16_t)a.luminosidade;
+  bloco.cab.score = (uint8_t)a.score;
+  anterior = a;
+  deltaTempoAnterior = 0;
+}
+
+// false = não cabe mais no bloco (nada muda)
+static bool acrescentar(const AmostraHistorico& a) {
+  CursorBits c = { bloco.dados, bloco.cab.bits, HISTORICO_BYTES_DADOS * 8, false };
+  int32_t deltaTempo = (int32_t)(a.tempoS - anterior.tempoS);
+  escreverVariavel(c, deltaTempo - deltaTempoAnterior, LARGURA_TEMPO_CURTA, LARGURA_TEMPO_LONGA);
+  escreverVariavel(c, a.temperatura - anterior.temperatura, LARGURA_VALOR_CURTA, LARGURA_VALOR_LONGA);
+  escreverVariavel(c, a.umidade - anterior.umidade, LARGURA_VALOR_CURTA, LARGURA_VALOR_LONGA);
+  escreverVariavel(c, a.luminosidade - anterior.luminosidade, LARGURA_VALOR_CURTA, LARGURA_VALOR_LONGA);
+  escreverVariavel(c, a.score - anterior.score, LARGURA_VALOR_CURTA, LARGURA_VALOR_LONGA);
+  if (c.estourou || bloco.cab.amostras == UINT16_MAX) return false;
+
+  bloco.cab.bits = c.posicao;
+  bloco.cab.amostras++;
+  bloco.cab.tempoFinalS = a.tempoS;
+  anterior = a;
+  deltaTempoAnterior = deltaTempo;
+  return true;
+}
+
+// Acumula cada amostra do bloco nos intervalos da consulta
+struct ConsultaHistorico {
+  uint32_t inicioS;
+  uint32_t fimS;
+  uint32_t larguraS;
+  PontoHistorico* pontos;
+  int maxPontos;
+};
+
+static void acumular(const AmostraHistorico& a, ConsultaHistorico& q) {
+  if (a.tempoS < q.inicioS || a.tempoS > q.fimS) return;
+  PontoHistorico& p = q.pontos[min((int)((a.tempoS - q.inicioS) / q.larguraS), q.maxPontos - 1)];
+  p.amostras++;
+  p.temperatura += a.temperatura * 0.1f;
+  p.umidade += a.umidade * 0.1f;
+  p.luminosidade += a.luminosidade;
+  p.score += a.score;
+}
+
+static void decodificarBloco(const BlocoHistorico& b, ConsultaHistorico& q) {
+  AmostraHistorico a = { b.cab.tempoInicialS, b.cab.temperatura, b.cab.umidade,
+                         b.cab.luminosidade, b.cab.score };
+  acumular(a, q);
+  CursorBits c = { (uint8_t*)b.dados, 0, (uint16_t)min((unsigned)b.cab.bits, (unsigned)HISTORICO_BYTES_DADOS * 8), false };
+  int32_t deltaTempo = 0;
+  for (int i = 1; i < b.cab.amostras; i++) {
+    deltaTempo += lerVariavel(c, LARGURA_TEMPO_CURTA, LARGURA_TEMPO_LONGA);
+    a.tempoS += deltaTempo;
+    a.temperatura += lerVariavel(c, LARGURA_VALOR_CURTA, LARGURA_VALOR_LONGA);
+    a.umidade += lerVariavel(c, LARGURA_VALOR_CURTA, LARGURA_VALOR_LONGA);
+    a.luminosidade += lerVariavel(c, LARGURA_VALOR_CURTA, LARGURA_VALOR_LONGA);
+    a.score += lerVariavel(c, LARGURA_VALOR_CURTA, LARGURA_VALOR_LONGA);
+    if (c.estourou || a.tempoS > q.fimS) break;   // Bloco corrompido / passou do fim
+    acumular(a, q);
+  }
+}
+
+// ==================== SEGMENTOS ====================
+static void caminhoSegmento(BufferTexto<32>& caminho, int segmento) {
+  caminho.limpar();
+  caminho << HISTORICO_PREFIXO << segmento << ".bin";
+}
+
+static bool segmentoCheio(int segmento) {
+  return indice[segmento].fechado || indice[segmento].blocos >= HISTORICO_BLOCOS_POR_SEGMENTO;
+}
+
+// O anel anda um segmento e apaga o mais antigo inteiro
+static void rotacionar() {
+  segmentoAtual = (segmentoAtual + 1) % HISTORICO_SEGMENTOS;
+  BufferTexto<32> caminho;
+  caminhoSegmento(caminho, segmentoAtual);
+  halArquivoRemover(caminho.c_str());
+  if (indice[segmentoAtual].blocos > 0) stats.segmentosRotacionados++;
+  indice[segmentoAtual] = IndiceSegmento();
+  LOG_INFO("HIST", "🔄 Histórico no segmento ", segmentoAtual);
+}
+
+static void gravarBloco() {
+  if (!flashDisponivel) return;
+  if (segmentoCheio(segmentoAtual)) rotacionar();
+
+  BufferTexto<32> caminho;
+  caminhoSegmento(caminho, segmentoAtual);
+  int arquivo = halArquivoAnexar(caminho.c_str());
+  size_t gravados = arquivo >= 0 ? halArquivoEscrever(arquivo, &bloco, sizeof(bloco)) : 0;
+  halArquivoFechar(arquivo);
+  if (gravados != sizeof(bloco)) {
+    // Um pedaço de bloco no fim: o próximo vai para outro segmento
+    stats.falhasGravacao++;
+    indice[segmentoAtual].fechado = true;
+    LOG_ERRO("HIST", "❌ Falha gravando o histórico - ", (int)bloco.cab.amostras, " amostras perdidas");
+    return;
+  }
+
+  IndiceSegmento& s = indice[segmentoAtual];
+  if (s.blocos == 0) s.tempoInicialS = bloco.cab.tempoInicialS;
+  s.tempoFinalS = bloco.cab.tempoFinalS;
+  s.blocos++;
+  stats.blocosGravados++;
+  stats.amostrasGravadas += bloco.cab.amostras;
+}
+
+static bool lerCabecalho(int arquivo, int indiceBloco, CabecalhoBloco& cab) {
+  return halArquivoPosicionar(arquivo, (size_t)indiceBloco * HISTORICO_TAMANHO_BLOCO) &&
+         halArquivoLer(arquivo, &cab, sizeof(cab)) == sizeof(cab) &&
+         cab.magico == HISTORICO_MAGICO && cab.versao == HISTORICO_VERSAO;
+}
+
+// Boot frio: tamanho e primeiro/último bloco de cada segmento
+static void varrerSegmentos() {
+  segmentoAtual = 0;
+  uint32_t ultimoTempo = 0;
+  bool achou = false;
+  for (int i = 0; i < HISTORICO_SEGMENTOS; i++) {
+    indice[i] = IndiceSegmento();
+    BufferTexto<32> caminho;
+    caminhoSegmento(caminho, i);
+    int arquivo = halArquivoAbrir(caminho.c_str(), false);
+    if (arquivo < 0) continue;
+
+    size_t tamanho = halArquivoTamanho(arquivo);
+    int blocos = min((int)(tamanho / HISTORICO_TAMANHO_BLOCO), HISTORICO_BLOCOS_POR_SEGMENTO);
+    CabecalhoBloco primeiro, ultimo;
+    if (blocos > 0 && lerCabecalho(arquivo, 0, primeiro) && lerCabecalho(arquivo, blocos - 1, ultimo)) {
+      indice[i].tempoInicialS = primeiro.tempoInicialS;
+      indice[i].tempoFinalS = ultimo.tempoFinalS;
+      indice[i].blocos = (uint16_t)blocos;
+      indice[i].fechado = tamanho % HISTORICO_TAMANHO_BLOCO != 0;
+      if (!achou || ultimo.tempoFinalS > ultimoTempo) {
+        ultimoTempo = ultimo.tempoFinalS;
+        segmentoAtual = i;
+        achou = true;
+      }
+    }
+    halArquivoFechar(arquivo);
+    if (indice[i].blocos == 0) halArquivoRemover(caminho.c_str());   // Vazio ou ilegível
+  }
+
+  // O halMillis() recomeçou do zero: o tempo continua depois da flash
+  deslocamentoS = achou ? ultimoTempo + 1 : 0;
+  if (achou) {
+    LOG_INFO("HIST", "💾 Histórico restaurado: segmento ", segmentoAtual, " até t=", (unsigned long)ultimoTempo, " s");
+  }
+}
+
+// ==================== API ====================
+void historicoIniciar() {
+  flashDisponivel = halArmazenamentoIniciar();
+  if (halDespertouDoSonoProfundo()) return;
+
+  memset(&bloco, 0, sizeof(bloco));
+  stats = EstatisticasHistorico();
+  if (flashDisponivel) varrerSegmentos();
+}
+
+uint32_t historicoTempoS(unsigned long ms) {
+  return deslocamentoS + (uint32_t)(ms / 1000);
+}
+
+uint32_t historicoAgoraS() {
+  return historicoTempoS(halMillis());
+}
+
+void historicoRegistrar(const AmostraAgregada& amostra) {
+  if (amostra.zona != 0 || isnan(amostra.temperatura) || isnan(amostra.umidade)) return;
+
+  AmostraHistorico a = {
+    historicoTempoS(amostra.timestampMs),
+    (int32_t)lroundf(amostra.temperatura * 10.0f),
+    (int32_t)lroundf(amostra.umidade * 10.0f),
+    amostra.luminosidade,
+    amostra.score
+  };
+  // A série só anda para frente (os intervalos da consulta contam com isso)
+  if (bloco.cab.amostras > 0 && a.tempoS < anterior.tempoS) a.tempoS = anterior.tempoS;
+
+  if (bloco.cab.amostras == 0) {
+    iniciarBloco(a);
+  } else if (!acrescentar(a)) {
+    gravarBloco();
+    iniciarBloco(a);
+  }
+  stats.amostras++;
+}
+
+int historicoConsultar(uint32_t inicioS, uint32_t fimS, PontoHistorico* pontos, int maxPontos) {
+  if (maxPontos <= 0 || fimS < inicioS) return 0;
+  uint32_t t0 = (uint32_t)halMicros();
+
+  memset(pontos, 0, sizeof(PontoHistorico) * maxPontos);
+  ConsultaHistorico q = { inicioS, fimS, (fimS - inicioS) / (uint32_t)maxPontos + 1, pontos, maxPontos };
+
+  // Do segmento mais antigo (o seguinte ao atual no anel) ao atual
+  static BlocoHistorico lido;
+  for (int k = 1; flashDisponivel && k <= HISTORICO_SEGMENTOS; k++) {
+    int s = (segmentoAtual + k) % HISTORICO_SEGMENTOS;
+    const IndiceSegmento& seg = indice[s];
+    if (seg.blocos == 0 || seg.tempoFinalS < inicioS || seg.tempoInicialS > fimS) continue;
+
+    BufferTexto<32> caminho;
+    caminhoSegmento(caminho, s);
+    int arquivo = halArquivoAbrir(caminho.c_str(), false);
+    if (arquivo < 0) continue;
+    for (int b = 0; b < seg.blocos; b++) {
+      if (!lerCabecalho(arquivo, b, lido.cab)) break;
+      if (lido.cab.tempoFinalS < inicioS) continue;
+      if (lido.cab.tempoInicialS > fimS) break;
+      if (halArquivoLer(arquivo, lido.dados, sizeof(lido.dados)) != sizeof(lido.dados)) break;
+      stats.blocosLidos++;
+      decodificarBloco(lido, q);
+    }
+    halArquivoFechar(arquivo);
+  }
+  if (bloco.cab.amostras > 0 && bloco.cab.tempoFinalS >= inicioS && bloco.cab.tempoInicialS <= fimS) {
+    decodificarBloco(bloco, q);
+  }
+
+  // Médias, sem os intervalos vazios
+  int total = 0;
+  for (int i = 0; i < maxPontos; i++) {
+    PontoHistorico p = pontos[i];
+    if (p.amostras == 0) continue;
+    p.tempoS = inicioS + (uint32_t)i * q.larguraS;
+    p.temperatura /= p.amostras;
+    p.umidade /= p.amostras;
+    p.luminosidade /= p.amostras;
+    p.score /= p.amostras;
+    pontos[total++] = p;
+  }
+
+  unsigned long duracao = (uint32_t)halMicros() - t0;
+  stats.consultas++;
+  stats.duracaoConsultaMaxUs = max(stats.duracaoConsultaMaxUs, duracao);
+  return total;
+}
+
+int historicoConsultarUltimos(uint32_t duracaoS, PontoHistorico* pontos, int maxPontos) {
+  uint32_t agora = historicoAgoraS();
+  return historicoConsultar(agora > duracaoS ? agora - duracaoS : 0, agora, pontos, maxPontos);
+}
+
+void historicoLimpar() {
+  for (int i = 0; i < HISTORICO_SEGMENTOS; i++) {
+    BufferTexto<32> caminho;
+    caminhoSegmento(caminho, i);
+    halArquivoRemover(caminho.c_str());
+    indice[i] = IndiceSegmento();
+  }
+  memset(&bloco, 0, sizeof(bloco));
+  segmentoAtual = 0;
+  stats = EstatisticasHistorico();
+}
+
+const EstatisticasHistorico& historicoEstatisticas() {
+  return stats;
+}
+
+void historicoImprimirEstatisticas() {
+  int segmentos = 0;
+  unsigned long blocos = 0;
+  for (const IndiceSegmento& s : indice) {
+    segmentos += s.blocos > 0;
+    blocos += s.blocos;
+  }
+  LOG_INFO("HIST", "🗂️ Histórico: amostras=", stats.amostras, " no bloco=", (int)bloco.cab.amostras,
+           " segmentos=", segmentos, " blocos=", blocos,
+           " bytes/amostra=", Decimal(stats.amostrasGravadas > 0 ?
+               (float)stats.blocosGravados * HISTORICO_TAMANHO_BLOCO / stats.amostrasGravadas : 0.0f, 2),
+           " rotacoes=", stats.segmentosRotacionados, " falhas=", stats.falhasGravacao,
+           " consultaMax=", stats.duracaoConsultaMaxUs, " us");
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "hal.h"
+
+#include "fila_telemetria.h"
+
+// ==================== HISTÓRICO NA FLASH ====================
+// Série temporal das médias de envio da zona 0 (temperatura, umidade,
+// LDR e score), só de acréscimo, para decisões locais e análise depois de
+// um problema. As amostras são comprimidas em blocos de
+// HISTORICO_TAMANHO_BLOCO bytes:
+//   - o cabeçalho guarda a primeira amostra inteira e o intervalo de tempo;
+//   - as seguintes guardam o delta-do-delta do tempo e o delta de cada
+//     valor (décimos de °C e de %, LDR e score inteiros) em códigos de
+//     tamanho variável: 1 bit quando nada mudou.
+// O bloco é montado na RAM (retido no sono profundo) e só vai para a
+// flash cheio, com um acréscimo no fim do segmento atual. Os segmentos são
+// arquivos de HISTORICO_BLOCOS_POR_SEGMENTO blocos num anel: quando o
+// anel enche, o mais antigo é apagado inteiro. Nada é reescrito no lugar,
+// então o desgaste se espalha por igual pela área do histórico.
+//
+// Como a fila, é da tarefa de rede: registrar e consultar só nela (ou no
+// build nativo). Um reboot frio perde o bloco em montagem.
+
+#define HISTORICO_TAMANHO_BLOCO 256
+#ifndef HISTORICO_BLOCOS_POR_SEGMENTO
+#define HISTORICO_BLOCOS_POR_SEGMENTO 64   // 16 KB por arquivo
+#endif
+#ifndef HISTORICO_SEGMENTOS
+#define HISTORICO_SEGMENTOS 24             // 384 KB no total
+#endif
+#define HISTORICO_PREFIXO "/historico_"
+
+// Média de um intervalo da consulta
+struct PontoHistorico {
+  uint32_t tempoS;       // Início do intervalo
+  uint16_t amostras;
+  float temperatura;
+  float umidade;
+  float luminosidade;
+  float score;
+};
+
+struct EstatisticasHistorico {
+  unsigned long amostras;            // Registradas
+  unsigned long amostrasGravadas;    // Dentro de blocos já na flash
+  unsigned long blocosGravados;
+  unsigned long falhasGravacao;
+  unsigned long segmentosRotacionados;
+  unsigned long consultas;
+  unsigned long blocosLidos;
+  unsigned long duracaoConsultaMaxUs;
+};
+
+// No setup(), depois de filaIniciar(). No boot frio procura o segmento
+// atual e continua o tempo de onde a flash parou
+void historicoIniciar();
+
+// Na tarefa de rede, para cada média que chega do núcleo 1. Ignora as
+// outras zonas
+void historicoRegistrar(const AmostraAgregada& amostra);
+
+// Tempo do histórico (s): o halMillis() somado a um deslocamento que
+// mantém a série crescente entre reboots frios
+uint32_t historicoTempoS(unsigned long ms);
+uint32_t historicoAgoraS();
+
+// Médias de [inicio, fim] divididos em maxPontos intervalos iguais. Só os
+// intervalos com amostras saem, em ordem. Retorna quantos
+int historicoConsultar(uint32_t inicioS, uint32_t fimS, PontoHistorico* pontos, int maxPontos);
+int historicoConsultarUltimos(uint32_t duracaoS, PontoHistorico* pontos, int maxPontos);
+
+// Apaga os segmentos e o bloco em montagem (bancada, troca de instalação)
+void historicoLimpar();
+
+const EstatisticasHistorico& historicoEstatisticas();
+void historicoImprimirEstatisticas();
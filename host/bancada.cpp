@@ -0,0 +1,703 @@
+// Bancada de desempenho do tick do WellWork (build nativo).
+//
+// Roda a mesma instrumentação de perfil_estagios.h que vai no firmware,
+// em cenários fixos, e grava um CSV por estágio com min/mediana/p99/máx
+// em nanossegundos mais os bytes de heap pedidos por tick:
+//
+//   wellwork_bancada [--iteracoes N] [--saida arquivo.csv]
+//                    [--linha-base anterior.csv] [--tolerancia PCT]
+//                    [--raspagens N] [--vazao N] [--transbordo N]
+//                    [--historico N] [--spsc N]
+//
+// Com --linha-base compara as medianas com uma execução anterior e sai
+// com código 1 se algum estágio piorou além da tolerância.
+//
+// Cada iteração é um tick de sensoriamento + pausas + LEDs. Cenários:
+//   normal  - ambiente ideal às 10h: score 100, quase nada de log
+//   envio   - como o normal + fechamento das médias + POST bulk ao stub
+//   alertas - 35°C, 85%, escuro no expediente: todos os alertas e
+//             decisão CRÍTICA
+//   zonas_N - como o normal, com N zonas (a do kit + N-1 zonas sem
+//             sensor local, com amostras registradas a cada tick): o
+//             custo do tick e do estágio score por número de zonas
+//
+// Depois dos cenários, --raspagens N (padrão 2000, 0 = pula) mede o
+// endpoint de métricas pelo loopback: uma thread cliente faz N raspagens
+// keep-alive, alternando /metrics e /metrics.json, enquanto esta thread
+// (o "núcleo 0" e o "núcleo 1") roda ticks e atende. Com 1 e com
+// MAX_ZONAS zonas; os estágios entram no CSV como raspagem_<zonas> e a
+// taxa, a latência vista pelo cliente e os bytes por resposta saem no
+// stderr.
+//
+// Por fim, --vazao N (padrão 2400, 0 = pula) compara os destinos da
+// telemetria: N amostras passam pela fila (uma fila cheia por vez) e são
+// drenadas para o stub HTTP do ThingSpeak e para o broker MQTT local. Saem
+// no stderr mensagens/s, amostras/s e bytes no fio (os dois sentidos) por
+// amostra.
+//
+// --transbordo N (padrão 60, 0 = pula) confere a política de overflow da
+// fila: com o stub do ThingSpeak respondendo 503, enfileira a capacidade
+// mais N amostras, uma vez com cada política, e confere que sobraram as
+// últimas (descartar a mais antiga) ou as primeiras (descartar a mais
+// nova). Depois o stub volta e a fila cheia é drenada; sai no stderr a
+// vazão da recuperação em amostras/s. Sobra errada ou amostra perdida na
+// drenagem fazem a bancada sair com código 1.
+//
+// --spsc N (padrão 200000, 0 = pula) estressa a FilaSPSC da passagem
+// entre os núcleos com threads de verdade: um produtor insere N amostras
+// numeradas (tentando de novo com a fila cheia), um consumidor confere que
+// chegam todas, na ordem e inteiras, e uma terceira thread lê a
+// profundidade o tempo todo. Perda, reordenação, amostra rasgada ou
+// profundidade fora de 0..N fazem a bancada sair com código 1.
+//
+// --historico N (padrão 40320 = uma semana de médias de 15 s, 0 = pula)
+// grava N médias sintéticas (o perfil de um dia do simulador na escala
+// real, com o ruído de uma média de 15 s) no histórico da flash e mede no
+// stderr os bytes por amostra, o custo do registro e a latência das
+// consultas por intervalo.
+
+#include "../hal.h"
+#include "../amostragem_adaptativa.h"
+#include "../destino_telemetria.h"
+#include "../fila_spsc.h"
+#include "../fila_telemetria.h"
+#include "../historico.h"
+#include "../log.h"
+#include "../perfil_estagios.h"
+#include "../sensor_dht.h"
+#include "../servidor_metricas.h"
+#include "../zonas.h"
+#include "broker_stub.h"
+#include "servidor_stub.h"
+#include "simulador.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+void setup();
+void executarSistemaWellWork();
+void tarefaAtuacao();
+void tarefaPausas();
+void tarefaEnvio();
+void passoTarefaRede();
+void tarefaDht();
+
+#define ITERACOES_PADRAO 2000
+#define ITERACOES_AQUECIMENTO 50
+#define TOLERANCIA_PADRAO 25          // %
+#define PISO_REGRESSAO_NS 500         // Diferenças menores que isso são ruído
+#define RASPAGENS_PADRAO 2000
+#define VAZAO_PADRAO 2400
+#define VAZAO_LIMITE_S 30             // Desiste se o destino parar de confirmar
+#define TRANSBORDO_PADRAO 60          // 15 min além da hora que cabe na fila
+#define HISTORICO_PADRAO 40320        // Uma semana de médias de 15 s
+#define SPSC_PADRAO 200000
+#define CAPACIDADE_SPSC 8             // A da fila entre os núcleos do sketch
+#define INTERVALO_ENVIO_MS 15000
+#define REPETICOES_CONSULTA 20
+
+struct Cenario {
+  const char* nome;
+  float temperatura;
+  float umidade;
+  int luminosidade;
+  bool envio;
+  int zonas;     // 0 = as do sketch
+};
+
+static const Cenario cenarios[] = {
+  { "normal", 23.0f, 50.0f, 3000, false, 0 },
+  { "envio", 23.0f, 50.0f, 3000, true, 0 },
+  { "alertas", 35.0f, 85.0f, 20, false, 0 },
+  { "zonas_1", 23.0f, 50.0f, 3000, false, 1 },
+  { "zonas_4", 23.0f, 50.0f, 3000, false, 4 },
+  { "zonas_16", 23.0f, 50.0f, 3000, false, 16 },
+  { "zonas_64", 23.0f, 50.0f, 3000, false, 64 },
+};
+
+// Zona 0 = a do kit (sensores simulados); as outras recebem amostras
+// registradas, espalhadas em volta do ambiente do cenário
+static ConfigZona zonasBancada[MAX_ZONAS];
+
+static void configurarZonas(const Cenario& c) {
+  zonasBancada[0] = zonasConfig(0);
+  for (int z = 1; z < c.zonas; z++) {
+    zonasBancada[z] = { "bancada", -1, -1, nullptr, nullptr, (uint16_t)(z * 5 % 60) };
+  }
+  zonasIniciar(zonasBancada, c.zonas, c.zonas);
+}
+
+static void registrarZonas(const Cenario& c) {
+  for (int z = 1; z < c.zonas; z++) {
+    zonasRegistrarAmostra(z, c.temperatura + (z % 7) * 1.5f, c.umidade - (z % 5) * 6.0f,
+                          (float)(c.luminosidade - (z % 4) * 900));
+  }
+}
+
+static void iteracao(const Cenario& c) {
+  registrarZonas(c);
+  executarSistemaWellWork();
+  tarefaPausas();
+  tarefaAtuacao();
+  if (c.envio) {
+    tarefaEnvio();
+    passoTarefaRede();
+  }
+  logDrenar();   // Fora das medições: a UART é de outra tarefa
+}
+
+// O tick só lê o cache do DHT: uma transação com o ambiente do cenário
+// antes de medir (o relógio não anda durante as iterações, então o cache
+// não envelhece)
+static void lerDhtDoCenario() {
+  halDelay(DHT_INTERVALO_MINIMO_MS);
+  tarefaDht();
+  halDelay(DHT_DURACAO_TRANSACAO_MS);
+  tarefaDht();
+}
+
+static void escreverCenario(FILE* saida, const Cenario& c) {
+  for (int e = 0; e < TOTAL_ESTAGIOS; e++) {
+    ResumoEstagio r;
+    perfilResumo((EstagioTick)e, r);
+    if (r.amostras == 0) continue;
+    BufferTexto<96> linha;
+    perfilEscreverCsv(linha, (EstagioTick)e);
+    fprintf(saida, "%s;%s\n", c.nome, linha.c_str());
+  }
+  ResumoHeapTick heap = perfilResumoHeap();
+  fprintf(saida, "%s;bytes_tick;%lu;%lu;%lu\n", c.nome, heap.ticks,
+          (unsigned long)heap.bytesMedio, (unsigned long)heap.bytesMax);
+}
+
+// ==================== RASPAGEM DO ENDPOINT DE MÉTRICAS ====================
+struct ResultadoRaspagem {
+  std::vector<double> latenciasUs;
+  size_t bytesTexto = 0;
+  size_t bytesJson = 0;
+  int falhas = 0;
+};
+
+// Lê uma resposta inteira (cabeçalho + Content-Length bytes); retorna o corpo
+static long lerResposta(int fd, std::string& resposta) {
+  resposta.clear();
+  char buffer[16384];
+  size_t fimCabecalho = std::string::npos;
+  long tamanhoCorpo = -1;
+  while (fimCabecalho == std::string::npos ||
+         resposta.size() < fimCabecalho + 4 + (size_t)tamanhoCorpo) {
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) return -1;
+    resposta.append(buffer, n);
+    if (fimCabecalho == std::string::npos) {
+      fimCabecalho = resposta.find("\r\n\r\n");
+      if (fimCabecalho == std::string::npos) continue;
+      size_t campo = resposta.find("Content-Length: ");
+      if (resposta.compare(0, 12, "HTTP/1.1 200") != 0 || campo == std::string::npos) return -1;
+      tamanhoCorpo = atol(resposta.c_str() + campo + 16);
+    }
+  }
+  return tamanhoCorpo;
+}
+
+static void clienteRaspagem(uint16_t porta, int raspagens, ResultadoRaspagem& r,
+                            std::atomic<bool>& terminou) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in destino = {};
+  destino.sin_family = AF_INET;
+  destino.sin_port = htons(porta);
+  destino.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (fd < 0 || connect(fd, (sockaddr*)&destino, sizeof(destino)) != 0) {
+    r.falhas = raspagens;
+    terminou = true;
+    return;
+  }
+
+  static const char* const requisicoes[2] = {
+    "GET /metrics HTTP/1.1\r\nHost: wellwork\r\nAccept: text/plain\r\n\r\n",
+    "GET /metrics.json HTTP/1.1\r\nHost: wellwork\r\nAccept: application/json\r\n\r\n",
+  };
+  std::string resposta;
+  for (int i = 0; i < raspagens; i++) {
+    bool json = i % 2;
+    auto inicio = std::chrono::steady_clock::now();
+    send(fd, requisicoes[json], strlen(requisicoes[json]), MSG_NOSIGNAL);
+    long corpo = lerResposta(fd, resposta);
+    if (corpo < 0) {
+      r.falhas++;
+      break;
+    }
+    r.latenciasUs.push_back(std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - inicio).count());
+    (json ? r.bytesJson : r.bytesTexto) = (size_t)corpo;
+  }
+  close(fd);
+  terminou = true;
+}
+
+// Ticks e atendimento na mesma thread, como o tick e a tarefa de métricas
+// dividem o tempo do ESP32 (em núcleos diferentes)
+static void raspar(FILE* saida, int zonas, int raspagens) {
+  Cenario c = { "raspagem", 23.0f, 50.0f, 3000, false, zonas };
+  BufferTexto<24> nome;
+  nome << "raspagem_" << zonas;
+  c.nome = nome.c_str();
+
+  configurarZonas(c);
+  simForcarAmbiente(c.temperatura, c.umidade, c.luminosidade);
+  lerDhtDoCenario();
+  for (int i = 0; i < ITERACOES_AQUECIMENTO; i++) iteracao(c);
+  perfilZerar();
+
+  ResultadoRaspagem r;
+  std::atomic<bool> terminou(false);
+  unsigned long ticks = 0;
+  auto inicio = std::chrono::steady_clock::now();
+  std::thread cliente(clienteRaspagem, servidorMetricasPorta(), raspagens, std::ref(r), std::ref(terminou));
+  while (!terminou) {
+    iteracao(c);
+    servidorMetricasProcessar();
+    ticks++;
+  }
+  cliente.join();
+  double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+  escreverCenario(saida, c);
+
+  std::vector<double>& l = r.latenciasUs;
+  std::sort(l.begin(), l.end());
+  double p50 = l.empty() ? 0 : l[l.size() / 2];
+  double p99 = l.empty() ? 0 : l[std::min(l.size() - 1, l.size() * 99 / 100)];
+  fprintf(stderr, "%s: %zu raspagens em %.2f s = %.0f/s | latência p50=%.0f us p99=%.0f us | "
+                  "texto=%zu bytes json=%zu bytes | %lu ticks no período | falhas=%d\n",
+          c.nome, l.size(), segundos, l.size() / segundos, p50, p99,
+          r.bytesTexto, r.bytesJson, ticks, r.falhas);
+}
+
+// ==================== VAZÃO DOS DESTINOS DA TELEMETRIA ====================
+struct TrafegoDestino {
+  unsigned long mensagens;
+  unsigned long long bytes;
+};
+
+static TrafegoDestino lerTrafego(const char* destino) {
+  if (!strcmp(destino, "mqtt")) {
+    EstatisticasBroker b = brokerEstatisticas();
+    return { b.publicacoes, b.bytesRecebidos + b.bytesEnviados };
+  }
+  EstatisticasStub s = stubEstatisticas();
+  return { s.requisicoes, s.bytesRecebidos + s.bytesEnviados };
+}
+
+// Uma fila cheia por vez, drenada sem esperar o relógio virtual: mede o
+// destino e o caminho até o stub, não o ritmo da API
+static void medirVazao(const char* nomeDestino, int amostras) {
+  Cenario c = { "vazao", 23.0f, 50.0f, 3000, false, 1 };
+  configurarZonas(c);
+  telemetriaUsarDestino(nomeDestino);
+  const DestinoTelemetria& destino = telemetriaDestino();
+
+  TrafegoDestino antes = lerTrafego(nomeDestino);
+  unsigned long enviadasAntes = filaEstatisticas().enviadas;
+  int restantes = amostras;
+  auto inicio = std::chrono::steady_clock::now();
+  auto limite = inicio + std::chrono::seconds(VAZAO_LIMITE_S);
+  while (restantes > 0 || filaTamanho() > 0) {
+    // Variação pequena entre amostras, como nas médias de 15 s
+    for (; restantes > 0 && filaTamanho() < CAPACIDADE_FILA_TELEMETRIA; restantes--) {
+      AmostraAgregada a = { halMillis(), 22.0f + (restantes % 30) * 0.1f, 48.0f + (restantes % 20) * 0.2f,
+                            2800 + restantes % 400, 90 + restantes % 11, 0 };
+      filaEnfileirar(a);
+    }
+    if (destino.processar != nullptr) destino.processar();
+    destino.drenar();
+    logDrenar();
+    if (std::chrono::steady_clock::now() > limite) break;
+  }
+  double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+  TrafegoDestino depois = lerTrafego(nomeDestino);
+  unsigned long mensagens = depois.mensagens - antes.mensagens;
+  unsigned long enviadas = filaEstatisticas().enviadas - enviadasAntes;
+  fprintf(stderr, "vazao_%s: %lu amostras em %lu mensagens, %.2f s = %.0f mensagens/s %.0f amostras/s | "
+                  "%.1f bytes/amostra no fio | pendentes=%d\n",
+          nomeDestino, enviadas, mensagens, segundos, mensagens / segundos, enviadas / segundos,
+          enviadas > 0 ? (double)(depois.bytes - antes.bytes) / enviadas : 0.0, filaTamanho());
+  filaConfirmarEnvio(filaTamanho());
+}
+
+// ==================== TRANSBORDO DA FILA ====================
+// O timestamp numera a amostra: a i-ésima fecha a janela em i x 15 s
+static AmostraAgregada amostraDoTransbordo(unsigned long baseMs, int i) {
+  return { baseMs + (unsigned long)i * INTERVALO_ENVIO_MS, 22.0f + (i % 30) * 0.1f, 48.0f + (i % 20) * 0.2f,
+           2800 + i % 400, 90 + i % 11, 0 };
+}
+
+// Com o stub do ThingSpeak recusando (503), enfileira a capacidade mais
+// "excedentes" amostras tentando drenar a cada uma, como a tarefa de rede
+// durante a queda; confere quais ficaram pela política e drena o resto
+// com o stub de volta, medindo a vazão da recuperação
+static bool transbordar(PoliticaOverflow politica, int excedentes) {
+  const char* nome = politica == DESCARTAR_MAIS_ANTIGA ? "antiga" : "nova";
+  Cenario c = { "transbordo", 23.0f, 50.0f, 3000, false, 1 };
+  configurarZonas(c);
+  telemetriaUsarDestino("thingspeak");
+  const DestinoTelemetria& destino = telemetriaDestino();
+
+  filaConfirmarEnvio(filaTamanho());
+  filaIniciar(politica);
+  unsigned long descartadasAntes = filaEstatisticas().descartadasOverflow;
+  unsigned long recusadasAntes = stubEstatisticas().respostasErro;
+
+  stubDefinirStatus(503);
+  int total = CAPACIDADE_FILA_TELEMETRIA + excedentes;
+  int rejeitadas = 0;
+  unsigned long baseMs = halMillis();
+  for (int i = 0; i < total; i++) {
+    if (!filaEnfileirar(amostraDoTransbordo(baseMs, i))) rejeitadas++;
+    destino.drenar();
+    logDrenar();
+  }
+  unsigned long recusadas = stubEstatisticas().respostasErro - recusadasAntes;
+  unsigned long descartadas = filaEstatisticas().descartadasOverflow - descartadasAntes;
+
+  // Mais antiga: ficam as últimas; mais nova: as primeiras
+  int primeira = politica == DESCARTAR_MAIS_ANTIGA ? excedentes : 0;
+  int foraDoLugar = 0;
+  for (int i = 0; i < filaTamanho(); i++) {
+    AmostraAgregada a;
+    filaEspiar(i, a);
+    if (a.timestampMs != amostraDoTransbordo(baseMs, primeira + i).timestampMs) foraDoLugar++;
+  }
+  int ficaram = filaTamanho();
+
+  stubDefinirStatus(202);
+  EstatisticasStub antes = stubEstatisticas();
+  auto inicio = std::chrono::steady_clock::now();
+  auto limite = inicio + std::chrono::seconds(VAZAO_LIMITE_S);
+  while (filaTamanho() > 0 && std::chrono::steady_clock::now() < limite) {
+    destino.drenar();
+    logDrenar();
+  }
+  double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+  EstatisticasStub depois = stubEstatisticas();
+  unsigned long drenadas = depois.entradas - antes.entradas;
+
+  bool ok = ficaram == CAPACIDADE_FILA_TELEMETRIA && foraDoLugar == 0 && descartadas == (unsigned long)excedentes &&
+            rejeitadas == (politica == DESCARTAR_MAIS_NOVA ? excedentes : 0) && recusadas > 0 &&
+            drenadas == (unsigned long)ficaram && filaTamanho() == 0;
+  fprintf(stderr, "transbordo_%s: %d amostras com o stub fora (%lu POSTs recusados), %lu descartadas | "
+                  "ficaram %d (da %d à %d), %d fora do lugar | drenadas %lu em %lu POSTs, %.3f s = %.0f amostras/s | %s\n",
+          nome, total, recusadas, descartadas, ficaram, primeira, primeira + ficaram - 1, foraDoLugar,
+          drenadas, depois.requisicoes - antes.requisicoes, segundos, segundos > 0 ? drenadas / segundos : 0.0, ok ? "ok" : "FALHOU");
+  filaConfirmarEnvio(filaTamanho());
+  return ok;
+}
+
+// ==================== FILA ENTRE NÚCLEOS (SPSC) ====================
+// Os campos derivam do número de sequência: uma cópia rasgada (metade de
+// uma amostra, metade de outra) não confere
+static AmostraAgregada amostraNumerada(uint32_t sequencia) {
+  return { sequencia, (float)(sequencia % 1000), (float)(sequencia % 977),
+           (int)(sequencia * 2654435761u >> 1), (int)(sequencia ^ 0x5A5A5A5Au) >> 1, (uint8_t)sequencia };
+}
+
+static bool amostraConfere(const AmostraAgregada& a, uint32_t sequencia) {
+  AmostraAgregada esperada = amostraNumerada(sequencia);
+  return a.timestampMs == esperada.timestampMs && a.temperatura == esperada.temperatura &&
+         a.umidade == esperada.umidade && a.luminosidade == esperada.luminosidade &&
+         a.score == esperada.score && a.zona == esperada.zona;
+}
+
+static bool estressarSpsc(uint32_t total) {
+  static FilaSPSC<AmostraAgregada, CAPACIDADE_SPSC> fila;
+  std::atomic<bool> terminou(false);
+  std::atomic<unsigned long> leiturasProfundidade(0);
+  std::atomic<unsigned long> profundidadesInvalidas(0);
+  uint32_t recebidas = 0;
+  unsigned long foraDeOrdem = 0;
+  unsigned long rasgadas = 0;
+
+  auto inicio = std::chrono::steady_clock::now();
+  std::thread produtor([&] {
+    for (uint32_t i = 0; i < total; i++) {
+      AmostraAgregada a = amostraNumerada(i);
+      while (!fila.inserir(a)) std::this_thread::yield();
+    }
+  });
+  std::thread observador([&] {
+    while (!terminou.load(std::memory_order_relaxed)) {
+      if (fila.profundidade() > CAPACIDADE_SPSC) profundidadesInvalidas++;
+      leiturasProfundidade++;
+      std::this_thread::yield();   // Com um núcleo só, não segura a CPU das outras duas
+    }
+  });
+
+  // Consumidor nesta thread, como a tarefa de rede
+  uint32_t esperada = 0;
+  while (esperada < total) {
+    AmostraAgregada a;
+    if (!fila.retirar(a)) {
+      std::this_thread::yield();
+      continue;
+    }
+    recebidas++;
+    if (a.timestampMs != esperada) {
+      foraDeOrdem++;
+      esperada = (uint32_t)a.timestampMs;   // Segue dali para não contar tudo de novo
+    }
+    if (!amostraConfere(a, esperada)) rasgadas++;
+    esperada++;
+  }
+  produtor.join();
+  terminou = true;
+  observador.join();
+  double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+  bool ok = recebidas == total && foraDeOrdem == 0 && rasgadas == 0 && profundidadesInvalidas == 0 &&
+            fila.inseridos() == total && fila.profundidade() == 0;
+  fprintf(stderr, "spsc: %u amostras em %.2f s = %.0f amostras/s | fila cheia=%lu vezes profundidade max=%zu/%d | "
+                  "recebidas=%u fora de ordem=%lu rasgadas=%lu | %lu leituras da profundidade, %lu inválidas | %s\n",
+          total, segundos, total / segundos, fila.descartes(), fila.profundidadeMaxima(), CAPACIDADE_SPSC,
+          recebidas, foraDeOrdem, rasgadas, leiturasProfundidade.load(), profundidadesInvalidas.load(),
+          ok ? "ok" : "FALHOU");
+  return ok;
+}
+
+// ==================== HISTÓRICO NA FLASH ====================
+// Média de 15 s na hora h (0-24) do dia: as curvas do simulador, mas um
+// dia real em vez de 2 minutos, com o ruído que sobra depois da média
+static AmostraAgregada mediaSintetica(double h, std::mt19937& gerador) {
+  std::normal_distribution<float> ruido(0.0f, 1.0f);
+  float temperatura = (float)(22.5 + 7.0 * cos((h - 15.0) / 24.0 * 2.0 * M_PI)) + 0.08f * ruido(gerador);
+  float umidade = (float)(50.0 - 22.0 * cos((h - 15.0) / 24.0 * 2.0 * M_PI)) + 0.1f * ruido(gerador);
+  int luz = h >= 8.0 && h < 18.0 ? 3000 : (h >= 18.0 && h < 22.0 ? 1200 : 40);
+  luz += (int)lroundf(8.0f * ruido(gerador));
+  int score = 100 - (temperatura > 26.0f ? 15 : 0) - (umidade < 40.0f || umidade > 60.0f ? 15 : 0);
+  return { 0, temperatura, umidade, max(luz, 0), score, 0 };
+}
+
+// A consulta termina na última amostra (o relógio virtual não anda uma semana)
+static void medirConsulta(const char* nome, uint32_t fimS, uint32_t duracaoS, int maxPontos) {
+  std::vector<PontoHistorico> pontos(maxPontos);
+  std::vector<double> duracoes;
+  unsigned long blocosAntes = historicoEstatisticas().blocosLidos;
+  int n = 0;
+  for (int r = 0; r < REPETICOES_CONSULTA; r++) {
+    auto inicio = std::chrono::steady_clock::now();
+    n = historicoConsultar(fimS - min(duracaoS, fimS), fimS, pontos.data(), maxPontos);
+    duracoes.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - inicio).count());
+  }
+  std::sort(duracoes.begin(), duracoes.end());
+  unsigned long blocos = (historicoEstatisticas().blocosLidos - blocosAntes) / REPETICOES_CONSULTA;
+  fprintf(stderr, "historico_%s: %d pontos, %lu blocos lidos | mediana=%.0f us max=%.0f us\n",
+          nome, n, blocos, duracoes[duracoes.size() / 2], duracoes.back());
+}
+
+static void medirHistorico(int amostras) {
+  historicoLimpar();
+  std::mt19937 gerador(42);
+  std::uniform_int_distribution<int> folga(0, 30);   // ms entre o fim da janela e o envio
+  unsigned long baseMs = halMillis();
+  std::vector<double> registros;
+  registros.reserve(amostras);
+  for (int i = 0; i < amostras; i++) {
+    double h = fmod(7.0 + i * 15.0 / 3600.0, 24.0);
+    AmostraAgregada a = mediaSintetica(h, gerador);
+    a.timestampMs = baseMs + (unsigned long)i * INTERVALO_ENVIO_MS + folga(gerador);
+    auto inicio = std::chrono::steady_clock::now();
+    historicoRegistrar(a);
+    registros.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - inicio).count());
+    logDrenar();
+  }
+  std::sort(registros.begin(), registros.end());
+
+  const EstatisticasHistorico& h = historicoEstatisticas();
+  double bytesPorAmostra = h.amostrasGravadas > 0 ?
+      (double)h.blocosGravados * HISTORICO_TAMANHO_BLOCO / h.amostrasGravadas : 0.0;
+  fprintf(stderr, "historico: %d amostras em %lu blocos = %.2f bytes/amostra (%zu na fila) | "
+                  "%.1f dias cabem em %d KB | registro mediana=%.2f us max=%.0f us | rotações=%lu\n",
+          amostras, h.blocosGravados, bytesPorAmostra, sizeof(AmostraAgregada),
+          bytesPorAmostra > 0 ? HISTORICO_SEGMENTOS * HISTORICO_BLOCOS_POR_SEGMENTO * HISTORICO_TAMANHO_BLOCO /
+                                bytesPorAmostra * 15.0 / 86400.0 : 0.0,
+          HISTORICO_SEGMENTOS * HISTORICO_BLOCOS_POR_SEGMENTO * HISTORICO_TAMANHO_BLOCO / 1024,
+          registros[registros.size() / 2], registros.back(), h.segmentosRotacionados);
+
+  uint32_t fimS = historicoTempoS(baseMs + (unsigned long)amostras * INTERVALO_ENVIO_MS);
+  medirConsulta("1h_bruto", fimS, 3600, 240);
+  medirConsulta("8h_100", fimS, 8 * 3600, 100);
+  medirConsulta("24h_96", fimS, 24 * 3600, 96);
+  medirConsulta("7d_168", fimS, 7 * 86400, 168);
+}
+
+// cenario;estagio -> mediana (ns) ou bytes médios por tick
+static std::map<std::string, unsigned long> lerLinhaBase(const char* caminho) {
+  std::map<std::string, unsigned long> valores;
+  FILE* f = fopen(caminho, "r");
+  if (f == nullptr) return valores;
+
+  char linha[256];
+  while (fgets(linha, sizeof(linha), f)) {
+    if (linha[0] == '#' || !strncmp(linha, "cenario;", 8)) continue;
+    std::vector<std::string> campos;
+    std::string campo;
+    for (const char* p = linha; *p && *p != '\n'; p++) {
+      if (*p == ';') {
+        campos.push_back(campo);
+        campo.clear();
+      } else {
+        campo += *p;
+      }
+    }
+    campos.push_back(campo);
+    if (campos.size() < 4) continue;
+
+    bool heap = campos[1] == "bytes_tick";
+    if (!heap && campos.size() < 5) continue;
+    valores[campos[0] + ";" + campos[1]] = strtoul(campos[heap ? 3 : 4].c_str(), nullptr, 10);
+  }
+  fclose(f);
+  return valores;
+}
+
+static bool compararComLinhaBase(const char* caminhoBase, const char* caminhoAtual, int tolerancia) {
+  std::map<std::string, unsigned long> base = lerLinhaBase(caminhoBase);
+  std::map<std::string, unsigned long> atual = lerLinhaBase(caminhoAtual);
+  if (base.empty()) {
+    fprintf(stderr, "linha de base vazia ou inexistente: %s\n", caminhoBase);
+    return false;
+  }
+
+  bool regrediu = false;
+  fprintf(stderr, "\n%-24s %12s %12s %8s\n", "cenario;estagio", "base", "atual", "delta");
+  for (const auto& par : atual) {
+    auto b = base.find(par.first);
+    if (b == base.end()) continue;
+    bool heap = par.first.find(";bytes_tick") != std::string::npos;
+    long delta = (long)par.second - (long)b->second;
+    double pct = b->second > 0 ? 100.0 * delta / b->second : 0.0;
+
+    // Heap: qualquer byte a mais por tick é regressão
+    bool piorou = heap ? delta > 0
+                       : delta > PISO_REGRESSAO_NS && pct > tolerancia;
+    regrediu |= piorou;
+    fprintf(stderr, "%-24s %12lu %12lu %7.1f%%%s\n", par.first.c_str(), b->second,
+            par.second, pct, piorou ? "  <-- REGRESSÃO" : "");
+  }
+  return !regrediu;
+}
+
+int main(int argc, char** argv) {
+  int iteracoes = ITERACOES_PADRAO;
+  int tolerancia = TOLERANCIA_PADRAO;
+  int raspagens = RASPAGENS_PADRAO;
+  int vazao = VAZAO_PADRAO;
+  int historico = HISTORICO_PADRAO;
+  int transbordo = TRANSBORDO_PADRAO;
+  long spsc = SPSC_PADRAO;
+  const char* caminhoSaida = nullptr;
+  const char* caminhoBase = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    bool temValor = i + 1 < argc;
+    if (!strcmp(argv[i], "--iteracoes") && temValor) {
+      iteracoes = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--saida") && temValor) {
+      caminhoSaida = argv[++i];
+    } else if (!strcmp(argv[i], "--linha-base") && temValor) {
+      caminhoBase = argv[++i];
+    } else if (!strcmp(argv[i], "--tolerancia") && temValor) {
+      tolerancia = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--raspagens") && temValor) {
+      raspagens = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--vazao") && temValor) {
+      vazao = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--historico") && temValor) {
+      historico = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--transbordo") && temValor) {
+      transbordo = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--spsc") && temValor) {
+      spsc = atol(argv[++i]);
+    } else {
+      fprintf(stderr, "uso: %s [--iteracoes N] [--saida arquivo.csv] "
+                      "[--linha-base anterior.csv] [--tolerancia PCT] [--raspagens N]\n"
+                      "          [--vazao N] [--transbordo N] [--historico N] [--spsc N]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (caminhoBase != nullptr && caminhoSaida == nullptr) caminhoSaida = "bancada_atual.csv";
+
+  ConfigSimulacao sim;
+  sim.portaHttp = stubIniciar(ConfigStub());
+  if (sim.portaHttp == 0) {
+    fprintf(stderr, "não foi possível abrir o stub HTTP\n");
+    return 1;
+  }
+  sim.portaMqtt = brokerIniciar(ConfigBroker());
+  if (sim.portaMqtt == 0) {
+    fprintf(stderr, "não foi possível abrir o broker MQTT\n");
+    return 1;
+  }
+  simConfigurar(sim);
+  simLimparFlash();
+
+  // Boot e relógio virtual até as 10h (WiFi associado, fora das pausas)
+  setup();
+  adaptativoHabilitar(false);   // Todo tick de "envio" vai ao stub, como no modo fixo
+  halDelay(3 * sim.msPorHoraVirtual);
+  logDrenar();
+
+  FILE* saida = caminhoSaida ? fopen(caminhoSaida, "w") : stdout;
+  if (saida == nullptr) {
+    fprintf(stderr, "não foi possível abrir %s\n", caminhoSaida);
+    return 1;
+  }
+  fprintf(saida, "# wellwork_bancada iteracoes=%d amostras_janela=%d\n",
+          iteracoes, PERFIL_AMOSTRAS_ESTAGIO);
+  fprintf(saida, "cenario;estagio;amostras;min_ns;mediana_ns;p99_ns;max_ns\n");
+  fprintf(saida, "cenario;bytes_tick;ticks;bytes_medio;bytes_max\n");
+
+  for (const Cenario& c : cenarios) {
+    if (c.zonas > 0) configurarZonas(c);
+    simForcarAmbiente(c.temperatura, c.umidade, c.luminosidade);
+    lerDhtDoCenario();
+    for (int i = 0; i < ITERACOES_AQUECIMENTO; i++) iteracao(c);
+    perfilZerar();
+    for (int i = 0; i < iteracoes; i++) iteracao(c);
+    escreverCenario(saida, c);
+  }
+  if (raspagens > 0) {
+    raspar(saida, 1, raspagens);
+    raspar(saida, MAX_ZONAS, raspagens);
+  }
+  if (vazao > 0) {
+    medirVazao("thingspeak", vazao);
+    medirVazao("mqtt", vazao);
+  }
+  // A política do sketch por último: fica a que o setup() escolheu
+  bool transbordoOk = true;
+  if (transbordo > 0) {
+    transbordoOk = transbordar(DESCARTAR_MAIS_NOVA, transbordo);
+    transbordoOk = transbordar(DESCARTAR_MAIS_ANTIGA, transbordo) && transbordoOk;
+  }
+  if (historico > 0) medirHistorico(historico);
+  bool spscOk = spsc <= 0 || estressarSpsc((uint32_t)spsc);
+
+  if (saida != stdout) fclose(saida);
+  stubParar();
+  brokerParar();
+
+  if (caminhoBase != nullptr && !compararComLinhaBase(caminhoBase, caminhoSaida, tolerancia)) return 1;
+  return spscOk && transbordoOk ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+#include "broker_stub.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+
+static ConfigBroker config;
+static EstatisticasBroker estatisticas = {};
+static std::set<std::string> topicosVistos;
+static std::mutex muxEstatisticas;
+static std::atomic<bool> rodando(false);
+static std::thread thread;
+static int escuta = -1;
+static std::mt19937 gerador;
+
+static bool enviarTudo(int fd, const uint8_t* dados, size_t tamanho) {
+  size_t enviados = 0;
+  while (enviados < tamanho) {
+    ssize_t n = send(fd, dados + enviados, tamanho - enviados, MSG_NOSIGNAL);
+    if (n <= 0) return false;
+    enviados += (size_t)n;
+  }
+  std::lock_guard<std::mutex> trava(muxEstatisticas);
+  estatisticas.bytesEnviados += tamanho;
+  return true;
+}
+
+// Um pacote completo (cabeçalho fixo já separado). false = fecha a conexão
+static bool tratarPacote(int fd, uint8_t tipo, const uint8_t* corpo, size_t tamanho) {
+  switch (tipo >> 4) {
+    case 1: {   // CONNECT
+      static const uint8_t connack[4] = { 0x20, 0x02, 0x00, 0x00 };
+      return enviarTudo(fd, connack, sizeof(connack));
+    }
+    case 3: {   // PUBLISH
+      int qos = (tipo >> 1) & 0x03;
+      bool dup = tipo & 0x08;
+      if (tamanho < 2) return false;
+      size_t tamanhoTopico = (size_t)(corpo[0] << 8 | corpo[1]);
+      size_t inicioCarga = 2 + tamanhoTopico + (qos > 0 ? 2 : 0);
+      if (inicioCarga > tamanho) return false;
+      std::string topico((const char*)corpo + 2, tamanhoTopico);
+      const uint8_t* carga = corpo + inicioCarga;
+      size_t tamanhoCarga = tamanho - inicioCarga;
+
+      bool perder;
+      {
+        std::lock_guard<std::mutex> trava(muxEstatisticas);
+        estatisticas.publicacoes++;
+        if (dup) estatisticas.duplicadas++;
+        else if (topico.size() > 7 && topico.compare(topico.size() - 7, 7, "/alerta") == 0) estatisticas.alertas++;
+        else if (tamanhoCarga >= 3 && carga[0] == 1) estatisticas.amostras += carga[2];
+        topicosVistos.insert(topico);
+        estatisticas.topicos = topicosVistos.size();
+        perder = qos > 0 && std::uniform_real_distribution<double>(0, 1)(gerador) < config.probabilidadePerdaPuback;
+        if (perder) estatisticas.pubacksPerdidos++;
+      }
+      if (qos == 0 || perder) return true;
+      const uint8_t* id = corpo + 2 + tamanhoTopico;
+      uint8_t puback[4] = { 0x40, 0x02, id[0], id[1] };
+      return enviarTudo(fd, puback, sizeof(puback));
+    }
+    case 12: {   // PINGREQ
+      {
+        std::lock_guard<std::mutex> trava(muxEstatisticas);
+        estatisticas.pings++;
+      }
+      static const uint8_t pingresp[2] = { 0xD0, 0x00 };
+      return enviarTudo(fd, pingresp, sizeof(pingresp));
+    }
+    case 14:    // DISCONNECT
+      return false;
+    default:
+      return true;
+  }
+}
+
+// Atende uma conexão até o cliente fechar ou desconectar
+static void atenderConexao(int fd) {
+  std::string pendente;
+  char bloco[4096];
+
+  while (rodando) {
+    // Cabeçalho fixo: tipo + "remaining length" (1 a 4 bytes)
+    size_t restante = 0;
+    size_t bytesComprimento = 0;
+    bool completo = false;
+    for (size_t i = 1; i < pendente.size() && i <= 4; i++) {
+      restante |= (size_t)((uint8_t)pendente[i] & 0x7F) << (7 * (i - 1));
+      if (!((uint8_t)pendente[i] & 0x80)) {
+        bytesComprimento = i;
+        completo = pendente.size() >= 1 + i + restante;
+        break;
+      }
+    }
+    if (completo) {
+      size_t total = 1 + bytesComprimento + restante;
+      {
+        std::lock_guard<std::mutex> trava(muxEstatisticas);
+        estatisticas.bytesRecebidos += total;
+      }
+      bool continuar = tratarPacote(fd, (uint8_t)pendente[0],
+                                    (const uint8_t*)pendente.data() + 1 + bytesComprimento, restante);
+      pendente.erase(0, total);
+      if (!continuar) return;
+      continue;
+    }
+
+    pollfd p = { fd, POLLIN, 0 };
+    if (poll(&p, 1, 100) <= 0) continue;
+    ssize_t n = recv(fd, bloco, sizeof(bloco), 0);
+    if (n <= 0) return;
+    pendente.append(bloco, (size_t)n);
+  }
+}
+
+static void laco() {
+  while (rodando) {
+    pollfd p = { escuta, POLLIN, 0 };
+    if (poll(&p, 1, 100) <= 0) continue;
+    int fd = accept(escuta, nullptr, nullptr);
+    if (fd < 0) continue;
+    {
+      std::lock_guard<std::mutex> trava(muxEstatisticas);
+      estatisticas.conexoes++;
+    }
+    atenderConexao(fd);
+    close(fd);
+  }
+}
+
+uint16_t brokerIniciar(const ConfigBroker& novaConfig) {
+  config = novaConfig;
+  gerador.seed(config.semente);
+  escuta = socket(AF_INET, SOCK_STREAM, 0);
+  if (escuta < 0) return 0;
+
+  int um = 1;
+  setsockopt(escuta, SOL_SOCKET, SO_REUSEADDR, &um, sizeof(um));
+
+  sockaddr_in endereco = {};
+  endereco.sin_family = AF_INET;
+  endereco.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  endereco.sin_port = 0;   // Porta livre qualquer
+  socklen_t tam = sizeof(endereco);
+  if (bind(escuta, (sockaddr*)&endereco, sizeof(endereco)) != 0 ||
+      listen(escuta, 4) != 0 ||
+      getsockname(escuta, (sockaddr*)&endereco, &tam) != 0) {
+    close(escuta);
+    escuta = -1;
+    return 0;
+  }
+
+  rodando = true;
+  thread = std::thread(laco);
+  return ntohs(endereco.sin_port);
+}
+
+void brokerParar() {
+  if (!rodando) return;
+  rodando = false;
+  thread.join();
+  close(escuta);
+  escuta = -1;
+}
+
+EstatisticasBroker brokerEstatisticas() {
+  std::lock_guard<std::mutex> trava(muxEstatisticas);
+  return estatisticas;
+}
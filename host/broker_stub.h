@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+// ==================== STUB DO BROKER MQTT ====================
+// Broker MQTT 3.1.1 mínimo em 127.0.0.1 numa thread própria: CONNACK,
+// PUBACK dos PUBLISH QoS 1 e PINGRESP. Não repassa nada a assinantes;
+// decodifica a carga do WellWork (telemetria_mqtt.h) para contar amostras
+// e alertas, e pode "perder" PUBACKs para exercitar o reenvio com DUP.
+
+struct EstatisticasBroker {
+  unsigned long conexoes;
+  unsigned long publicacoes;
+  unsigned long duplicadas;      // PUBLISH com DUP (reenvio do cliente)
+  unsigned long amostras;        // Registros nas cargas, sem as duplicadas
+  unsigned long alertas;         // Publicações em .../alerta, sem as duplicadas
+  unsigned long topicos;         // Tópicos distintos
+  unsigned long pings;
+  unsigned long pubacksPerdidos;
+  unsigned long long bytesRecebidos;
+  unsigned long long bytesEnviados;
+};
+
+struct ConfigBroker {
+  double probabilidadePerdaPuback = 0.0;
+  uint32_t semente = 42;
+};
+
+uint16_t brokerIniciar(const ConfigBroker& config);   // Retorna a porta (0 em falha)
+void brokerParar();
+EstatisticasBroker brokerEstatisticas();
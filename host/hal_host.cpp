@@ -0,0 +1,770 @@
+// Implementação da HAL para o build nativo (Linux): relógio virtual,
+// sensores simulados, WiFi com quedas programadas, TCP real via loopback
+// e flash em um diretório local.
+#ifndef ARDUINO
+
+#include "../hal.h"
+#include "simulador.h"
+
+#include <arpa/inet.h>
+#include <malloc.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <random>
+#include <string>
+
+// ==================== ESTADO DA SIMULAÇÃO ====================
+static ConfigSimulacao config;
+static SaidasSimulacao saidas;
+static uint64_t relogioUs = 0;
+static std::mt19937 gerador(42);
+static bool radioLigado = false;
+static bool despertouDoSonoProfundo = false;
+
+// Todo avanço do relógio passa por aqui para entrar na conta de consumo
+static void avancarRelogio(uint64_t alvoUs, EstadoConsumo estado) {
+  if (alvoUs <= relogioUs) return;
+  uint64_t dt = alvoUs - relogioUs;
+  ConsumoSimulado& c = saidas.consumo;
+  float corrente = estado == CONSUMO_SONO_PROFUNDO ? config.correnteSonoProfundoMa
+                 : estado == CONSUMO_SONO_LEVE ? config.correnteSonoLeveMa
+                 : config.correnteAcordadoMa;
+  if (estado == CONSUMO_ACORDADO && radioLigado) {
+    corrente += config.correnteRadioMa;
+    c.tempoRadioUs += dt;
+  }
+  c.tempoUs[estado] += dt;
+  c.cargaMaUs += (double)corrente * dt;
+  relogioUs = alvoUs;
+}
+
+double simCorrenteMediaMa() {
+  return relogioUs > 0 ? saidas.consumo.cargaMaUs / relogioUs : 0.0;
+}
+
+double simHoraVirtual() {
+  double horas = (double)(relogioUs / 1000) / config.msPorHoraVirtual;
+  return fmod(config.horaInicial + horas, 24.0);
+}
+
+static double horasDesdeBoot() {
+  return (double)(relogioUs / 1000) / config.msPorHoraVirtual;
+}
+
+static float ruido(float desvio) {
+  std::normal_distribution<float> normal(0.0f, desvio);
+  return normal(gerador);
+}
+
+static bool sortear(double probabilidade) {
+  if (probabilidade <= 0.0) return false;
+  std::uniform_real_distribution<double> uniforme(0.0, 1.0);
+  return uniforme(gerador) < probabilidade;
+}
+
+// ---------- Perfil do ambiente ----------
+// Temperatura: mínima de madrugada, pico de ~29.5°C às 15h (passa do
+// limite de 28°C à tarde). Umidade anda no sentido oposto e fica abaixo
+// de 30% no pico de calor. Luz: escritório aceso das 8h às 18h, com
+// persianas fechadas (escuro) das 16h às 17h e luz esquecida acesa
+// das 20h às 22h.
+static bool ambienteForcado = false;
+static float temperaturaForcada = 0;
+static float umidadeForcada = 0;
+static int luminosidadeForcada = 0;
+
+void simForcarAmbiente(float temperatura, float umidade, int luminosidade) {
+  ambienteForcado = true;
+  temperaturaForcada = temperatura;
+  umidadeForcada = umidade;
+  luminosidadeForcada = luminosidade;
+}
+
+void simLiberarAmbiente() {
+  ambienteForcado = false;
+}
+
+float simTemperaturaAmbiente() {
+  if (ambienteForcado) return temperaturaForcada;
+  double h = simHoraVirtual();
+  return (float)(22.5 + 7.0 * cos((h - 15.0) / 24.0 * 2.0 * M_PI));
+}
+
+float simUmidadeAmbiente() {
+  if (ambienteForcado) return umidadeForcada;
+  double h = simHoraVirtual();
+  return (float)(50.0 - 22.0 * cos((h - 15.0) / 24.0 * 2.0 * M_PI));
+}
+
+int simLuminosidadeAmbiente() {
+  if (ambienteForcado) return luminosidadeForcada;
+  double h = simHoraVirtual();
+  if (h >= 16.0 && h < 17.0) return 80;
+  if (h >= 8.0 && h < 18.0) return 3000;
+  if (h >= 18.0 && h < 20.0) return 1200;
+  if (h >= 20.0 && h < 22.0) return 2600;
+  if (h >= 7.0 && h < 8.0) return 600;
+  return 40;
+}
+
+void simConfigurar(const ConfigSimulacao& novaConfig) {
+  config = novaConfig;
+  gerador.seed(config.semente);
+  mkdir(config.diretorioFlash, 0755);
+}
+
+const ConfigSimulacao& simConfig() {
+  return config;
+}
+
+uint64_t simRelogioUs() {
+  return relogioUs;
+}
+
+const SaidasSimulacao& simSaidas() {
+  return saidas;
+}
+
+// ==================== WIFI SIMULADO ====================
+static CallbackHalWiFi callbackWiFi = nullptr;
+static bool associado = false;
+static uint64_t associarEmUs = UINT64_MAX;
+static bool apConhecido = false;   // Canal/BSSID "na RTC" após a primeira associação
+
+static bool emQuedaWiFi() {
+  if (config.semRede) return true;
+  double h = horasDesdeBoot();
+  for (const IntervaloQueda& q : config.quedasWiFi) {
+    if (h >= q.horaInicio && h < q.horaFim) return true;
+  }
+  return false;
+}
+
+// Sem auto-reconnect, como no ESP32: depois de uma queda só volta com
+// uma nova chamada a halWiFiConectar()
+static void atualizarWiFi() {
+  bool queda = emQuedaWiFi();
+  if (associado && queda) {
+    associado = false;
+    associarEmUs = UINT64_MAX;
+    saidas.eventosWiFi++;
+    if (callbackWiFi) callbackWiFi(HAL_WIFI_DESCONECTADO);
+  } else if (!associado && relogioUs >= associarEmUs) {
+    associarEmUs = UINT64_MAX;
+    if (queda) return;   // Tentativa falhou; o backoff tenta de novo
+    associado = true;
+    apConhecido = true;
+    saidas.eventosWiFi++;
+    if (callbackWiFi) callbackWiFi(HAL_WIFI_GOT_IP);
+  }
+}
+
+bool simWiFiAssociado() {
+  return associado;
+}
+
+void halWiFiIniciar(CallbackHalWiFi callback) {
+  callbackWiFi = callback;
+}
+
+void halWiFiConectar(const char* ssid, const char* senha) {
+  (void)ssid;
+  (void)senha;
+  associado = false;
+  radioLigado = true;
+  unsigned long atrasoMs = apConhecido ? config.atrasoReconexaoRapidaMs : config.atrasoAssociacaoMs;
+  associarEmUs = relogioUs + (uint64_t)atrasoMs * 1000;
+}
+
+void halWiFiDesligar() {
+  associado = false;
+  associarEmUs = UINT64_MAX;
+  radioLigado = false;
+}
+
+bool halWiFiConectado() {
+  atualizarWiFi();
+  return associado;
+}
+
+int halWiFiRssi() {
+  return associado ? -55 + (int)ruido(3.0f) : 0;
+}
+
+void halWiFiIp(uint8_t ip[4]) {
+  static const uint8_t local[4] = { 10, 0, 0, 42 };
+  memcpy(ip, local, 4);
+}
+
+bool halResolverHost(const char* host, uint8_t ip[4]) {
+  (void)host;
+  if (!associado) return false;
+  static const uint8_t loopback[4] = { 127, 0, 0, 1 };
+  memcpy(ip, loopback, 4);
+  return true;
+}
+
+// ==================== TEMPO E TAREFAS COOPERATIVAS ====================
+struct TarefaHost {
+  FuncaoPassoTarefa passo;
+  uint64_t periodoUs;
+  uint64_t proximaUs;
+};
+
+#define HOST_MAX_TAREFAS 4
+static TarefaHost tarefas[HOST_MAX_TAREFAS];
+static int totalTarefas = 0;
+static bool executandoTarefa = false;
+
+unsigned long halMillis() {
+  return (unsigned long)(relogioUs / 1000);
+}
+
+unsigned long halMicros() {
+  return (unsigned long)(uint32_t)relogioUs;
+}
+
+uint32_t halCiclos() {
+  auto agora = std::chrono::steady_clock::now().time_since_epoch();
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(agora).count();
+}
+
+uint32_t halCiclosPorUs() {
+  return 1000;
+}
+
+// Avança o relógio virtual até o fim da espera, rodando no caminho as
+// tarefas criadas com halCriarTarefa() (o "outro núcleo"). Uma espera
+// feita de dentro de uma dessas tarefas só avança o relógio.
+void halDelay(unsigned long ms) {
+  uint64_t alvo = relogioUs + (uint64_t)ms * 1000;
+
+  while (!executandoTarefa) {
+    int proxima = -1;
+    for (int i = 0; i < totalTarefas; i++) {
+      if (tarefas[i].proximaUs <= alvo &&
+          (proxima < 0 || tarefas[i].proximaUs < tarefas[proxima].proximaUs)) {
+        proxima = i;
+      }
+    }
+    if (proxima < 0) break;
+
+    TarefaHost& t = tarefas[proxima];
+    avancarRelogio(t.proximaUs, CONSUMO_ACORDADO);
+    atualizarWiFi();
+    executandoTarefa = true;
+    t.passo();
+    executandoTarefa = false;
+    t.proximaUs = relogioUs + t.periodoUs;
+  }
+
+  avancarRelogio(alvo, CONSUMO_ACORDADO);
+  atualizarWiFi();
+}
+
+bool halCriarTarefa(FuncaoPassoTarefa passo, const char* nome, uint32_t pilhaBytes,
+                    int prioridade, int nucleo, unsigned long periodoMs) {
+  (void)nome;
+  (void)pilhaBytes;
+  (void)prioridade;
+  (void)nucleo;
+  if (totalTarefas >= HOST_MAX_TAREFAS) return false;
+  tarefas[totalTarefas++] = { passo, (uint64_t)periodoMs * 1000, relogioUs };
+  return true;
+}
+
+int halPilhasTarefas(HalPilhaTarefa* destino, int capacidade) {
+  (void)destino;
+  (void)capacidade;
+  return 0;
+}
+
+// Sem reboot: a alimentação que chega depois do prazo conta como um
+// disparo. O sono profundo desarma, como o reboot no ESP32
+static uint64_t watchdogPrazoUs = 0;
+static uint64_t watchdogUltimaUs = 0;
+
+bool halWatchdogIniciar(unsigned long prazoMs) {
+  watchdogPrazoUs = (uint64_t)prazoMs * 1000;
+  watchdogUltimaUs = relogioUs;
+  return true;
+}
+
+void halWatchdogAlimentar() {
+  if (watchdogPrazoUs == 0) return;
+  uint64_t intervalo = relogioUs - watchdogUltimaUs;
+  saidas.maiorIntervaloWatchdogUs = max(saidas.maiorIntervaloWatchdogUs, (unsigned long long)intervalo);
+  if (intervalo > watchdogPrazoUs) saidas.disparosWatchdog++;
+  watchdogUltimaUs = relogioUs;
+}
+
+bool halReiniciouPeloWatchdog() {
+  return false;
+}
+
+void halTravar(HalMutex& m) {
+  m.mutex.lock();
+}
+
+void halDestravar(HalMutex& m) {
+  m.mutex.unlock();
+}
+
+long halAleatorio(long minimo, long maximoExclusivo) {
+  if (maximoExclusivo <= minimo) return minimo;
+  std::uniform_int_distribution<long> uniforme(minimo, maximoExclusivo - 1);
+  return uniforme(gerador);
+}
+
+// ==================== GPIO / ADC / BUZZER / DHT ====================
+#define HOST_MAX_PINOS 40
+static int nivelPino[HOST_MAX_PINOS];
+static uint64_t ligadoDesdeUs[HOST_MAX_PINOS];
+
+void halPinoSaida(int pino) {
+  if (pino < 0 || pino >= HOST_MAX_PINOS) return;
+  nivelPino[pino] = LOW;
+}
+
+void halEscreverDigital(int pino, int nivel) {
+  if (pino < 0 || pino >= HOST_MAX_PINOS) return;
+  if (nivel == nivelPino[pino]) return;
+  if (nivel == HIGH) {
+    ligadoDesdeUs[pino] = relogioUs;
+  } else {
+    saidas.tempoLigadoMs[pino] += (relogioUs - ligadoDesdeUs[pino]) / 1000;
+  }
+  nivelPino[pino] = nivel;
+  if (config.aoMudarPino) config.aoMudarPino(pino, nivel);
+}
+
+void simFinalizar() {
+  for (int p = 0; p < HOST_MAX_PINOS; p++) {
+    if (nivelPino[p] == HIGH) {
+      saidas.tempoLigadoMs[p] += (relogioUs - ligadoDesdeUs[p]) / 1000;
+      ligadoDesdeUs[p] = relogioUs;
+    }
+  }
+}
+
+// Os LDRs das zonas estão ligados ao ADC em rodízio. As conversões do
+// intervalo desde a última leitura são geradas na hora, com o ambiente
+// atual (deslocado pelo índice do pino): ruído gaussiano e picos raros
+// (transmissões do WiFi acoplando na linha)
+static uint32_t conversoesPorSegundoAdc = 0;
+static int totalPinosAdc = 0;
+static int proximoPinoAdc = 0;
+static uint64_t ultimaLeituraAdcUs = 0;
+static double conversoesPendentesAdc = 0;
+
+bool halAdcContinuoIniciar(const int* pinos, int totalPinos, uint32_t conversoesPorSegundo) {
+  (void)pinos;
+  if (totalPinos <= 0 || totalPinos > HAL_ADC_CONTINUO_MAX_PINOS) return false;
+  conversoesPorSegundoAdc = conversoesPorSegundo;
+  totalPinosAdc = totalPinos;
+  proximoPinoAdc = 0;
+  ultimaLeituraAdcUs = relogioUs;
+  conversoesPendentesAdc = 0;
+  return conversoesPorSegundo > 0;
+}
+
+size_t halAdcContinuoLer(uint16_t* destino, uint8_t* indicePino, size_t capacidade) {
+  if (conversoesPorSegundoAdc == 0) return 0;
+  conversoesPendentesAdc += (relogioUs - ultimaLeituraAdcUs) * conversoesPorSegundoAdc / 1e6;
+  ultimaLeituraAdcUs = relogioUs;
+
+  size_t total = (size_t)min(conversoesPendentesAdc, (double)HAL_ADC_CONTINUO_MAX_CONVERSOES);
+  total = min(total, capacidade);
+  conversoesPendentesAdc = min(conversoesPendentesAdc - total, (double)HAL_ADC_CONTINUO_MAX_CONVERSOES);
+
+  int ambiente = simLuminosidadeAmbiente();
+  std::uniform_int_distribution<int> sinalPico(0, 1);
+  for (size_t i = 0; i < total; i++) {
+    int pino = proximoPinoAdc;
+    proximoPinoAdc = (proximoPinoAdc + 1) % totalPinosAdc;
+    float valor = ambiente + pino * config.deslocamentoLuzPorZona + ruido(config.ruidoAdc);
+    if (sortear(config.probabilidadePicoAdc)) {
+      valor += sinalPico(gerador) ? config.amplitudePicoAdc : -config.amplitudePicoAdc;
+    }
+    indicePino[i] = (uint8_t)pino;
+    destino[i] = (uint16_t)min(4095, max(0, (int)lroundf(valor)));
+  }
+  saidas.leiturasAdc += total;
+  return total;
+}
+
+void halTocar(int pino, unsigned int frequencia, unsigned long duracaoMs) {
+  saidas.toquesBuzzer++;
+  if (config.aoTocar) config.aoTocar(pino, frequencia, duracaoMs);
+}
+
+void halSilenciar(int pino) {
+  (void)pino;
+}
+
+// O quadro é montado no start, com o ambiente daquele instante (deslocado
+// pela ordem em que o pino foi registrado), e só é entregue depois de
+// duracaoTransacaoDhtUs de relógio virtual
+#define HOST_MAX_SENSORES_DHT 8
+static int pinosDht[HOST_MAX_SENSORES_DHT];
+static int totalPinosDht = 0;
+static bool dhtEmCurso = false;
+static bool dhtResponde = false;
+static uint64_t dhtInicioUs = 0;
+static uint8_t dhtQuadro[5];
+
+void halDhtIniciar(int pino) {
+  dhtEmCurso = false;
+  for (int i = 0; i < totalPinosDht; i++) {
+    if (pinosDht[i] == pino) return;
+  }
+  if (totalPinosDht < HOST_MAX_SENSORES_DHT) pinosDht[totalPinosDht++] = pino;
+}
+
+bool halDhtIniciarLeitura(int pino) {
+  if (dhtEmCurso) return false;
+  int zona = 0;
+  while (zona < totalPinosDht && pinosDht[zona] != pino) zona++;
+  if (zona == totalPinosDht) return false;
+  saidas.leiturasDht++;
+  dhtEmCurso = true;
+  dhtInicioUs = relogioUs;
+  dhtResponde = !sortear(config.probabilidadeFalhaDht);
+
+  // Décimos de % e de °C, big-endian; bit 15 da temperatura = negativa
+  float u = min(100.0f, max(0.0f, simUmidadeAmbiente() + zona * config.deslocamentoUmidadePorZona + ruido(1.0f)));
+  float t = simTemperaturaAmbiente() + zona * config.deslocamentoTemperaturaPorZona + ruido(0.2f);
+  uint16_t umidade = (uint16_t)lroundf(u * 10.0f);
+  uint16_t temperatura = (uint16_t)lroundf(fabsf(t) * 10.0f) | (t < 0 ? 0x8000 : 0);
+  dhtQuadro[0] = umidade >> 8;
+  dhtQuadro[1] = umidade & 0xFF;
+  dhtQuadro[2] = temperatura >> 8;
+  dhtQuadro[3] = temperatura & 0xFF;
+  dhtQuadro[4] = (uint8_t)(dhtQuadro[0] + dhtQuadro[1] + dhtQuadro[2] + dhtQuadro[3]);
+
+  if (sortear(config.probabilidadeErroCrcDht)) {
+    std::uniform_int_distribution<int> bit(0, 39);
+    int b = bit(gerador);
+    dhtQuadro[b / 8] ^= 0x80 >> (b % 8);
+  }
+  return true;
+}
+
+EstadoQuadroDht halDhtColetar(uint8_t quadro[5]) {
+  if (!dhtEmCurso) return DHT_QUADRO_SEM_RESPOSTA;
+  if (relogioUs - dhtInicioUs < config.duracaoTransacaoDhtUs) return DHT_QUADRO_PENDENTE;
+  dhtEmCurso = false;
+  if (!dhtResponde) return DHT_QUADRO_SEM_RESPOSTA;
+  memcpy(quadro, dhtQuadro, 5);
+  return DHT_QUADRO_PRONTO;
+}
+
+// ==================== SONO ====================
+// As tarefas cooperativas (o "núcleo 0") param junto, como no ESP32
+void halDormirLeve(unsigned long ms) {
+  saidas.consumo.sonosLeves++;
+  avancarRelogio(relogioUs + (uint64_t)ms * 1000, CONSUMO_SONO_LEVE);
+  avancarRelogio(relogioUs + config.despertarLeveUs, CONSUMO_ACORDADO);
+  atualizarWiFi();
+}
+
+// O processo continua, então a RAM "não volta": o que garante a retenção
+// no host é o setup() pular os módulos HAL_RETIDO, como no firmware
+void halDormirProfundo(unsigned long ms) {
+  saidas.consumo.sonosProfundos++;
+
+  // GPIOs voltam ao padrão (LEDs apagados), rádio e tarefas morrem
+  for (int p = 0; p < HOST_MAX_PINOS; p++) halEscreverDigital(p, LOW);
+  halWiFiDesligar();
+  totalTarefas = 0;
+  watchdogPrazoUs = 0;
+  dhtEmCurso = false;
+
+  avancarRelogio(relogioUs + (uint64_t)ms * 1000, CONSUMO_SONO_PROFUNDO);
+  avancarRelogio(relogioUs + (uint64_t)config.bootSonoProfundoMs * 1000, CONSUMO_ACORDADO);
+  despertouDoSonoProfundo = true;
+  throw ReinicioSonoProfundo();
+}
+
+bool halDespertouDoSonoProfundo() {
+  return despertouDoSonoProfundo;
+}
+
+// ==================== SERIAL ====================
+void halSerialIniciar(unsigned long baud, size_t tamanhoBufferTx) {
+  (void)baud;
+  (void)tamanhoBufferTx;
+}
+
+int halSerialEspacoLivre() {
+  return 4096;
+}
+
+size_t halSerialEscrever(const uint8_t* dados, size_t tamanho) {
+  saidas.bytesSerial += tamanho;
+  if (config.ecoarSerial) fwrite(dados, 1, tamanho, stdout);
+  return tamanho;
+}
+
+void halSerialDescarregar() {
+  if (config.ecoarSerial) fflush(stdout);
+}
+
+// ==================== TCP (LOOPBACK) ====================
+bool HalClienteTcp::conectar(const uint8_t ip[4], uint16_t porta) {
+  fechar();
+  if (!associado) return false;
+  if (porta == 80 && config.portaHttp != 0) porta = config.portaHttp;
+  if (porta == 1883 && config.portaMqtt != 0) porta = config.portaMqtt;
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return false;
+
+  sockaddr_in destino = {};
+  destino.sin_family = AF_INET;
+  destino.sin_port = htons(porta);
+  memcpy(&destino.sin_addr.s_addr, ip, 4);
+  if (connect(fd, (sockaddr*)&destino, sizeof(destino)) != 0) {
+    close(fd);
+    return false;
+  }
+
+  int um = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &um, sizeof(um));
+  descritor = fd;
+  return true;
+}
+
+bool HalClienteTcp::conectado() {
+  if (descritor < 0) return false;
+  if (!associado) {   // Queda do WiFi derruba o socket
+    fechar();
+    return false;
+  }
+  pollfd p = { descritor, POLLIN, 0 };
+  if (poll(&p, 1, 0) > 0) {
+    if (p.revents & (POLLERR | POLLHUP)) return false;
+    char c;
+    if (recv(descritor, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 0) return false;
+  }
+  return true;
+}
+
+// Sem dados prontos espera um pouco de tempo real: o servidor do outro
+// lado do loopback não anda com o relógio virtual
+int HalClienteTcp::disponivel() {
+  if (descritor < 0) return 0;
+  int n = 0;
+  ioctl(descritor, FIONREAD, &n);
+  if (n > 0) return n;
+  pollfd p = { descritor, POLLIN, 0 };
+  if (poll(&p, 1, 2) > 0) ioctl(descritor, FIONREAD, &n);
+  return n;
+}
+
+int HalClienteTcp::ler() {
+  if (descritor < 0) return -1;
+  uint8_t c;
+  return recv(descritor, &c, 1, MSG_DONTWAIT) == 1 ? c : -1;
+}
+
+size_t HalClienteTcp::escrever(const uint8_t* dados, size_t tamanho) {
+  if (descritor < 0) return 0;
+  size_t enviados = 0;
+  while (enviados < tamanho) {
+    ssize_t n = send(descritor, dados + enviados, tamanho - enviados, MSG_NOSIGNAL);
+    if (n <= 0) break;
+    enviados += (size_t)n;
+  }
+  return enviados;
+}
+
+size_t HalClienteTcp::lerDisponivel(uint8_t* destino, size_t capacidade) {
+  if (descritor < 0) return 0;
+  ssize_t n = recv(descritor, destino, capacidade, MSG_DONTWAIT);
+  return n > 0 ? (size_t)n : 0;
+}
+
+void HalClienteTcp::fechar() {
+  if (descritor >= 0) close(descritor);
+  descritor = -1;
+}
+
+bool HalServidorTcp::iniciar(uint16_t porta) {
+  parar();
+  if (config.semRede) return false;
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (fd < 0) return false;
+  int um = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &um, sizeof(um));
+
+  sockaddr_in endereco = {};
+  endereco.sin_family = AF_INET;
+  endereco.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  endereco.sin_port = htons(porta);
+  socklen_t tamanho = sizeof(endereco);
+  if (bind(fd, (sockaddr*)&endereco, sizeof(endereco)) != 0 || listen(fd, 8) != 0 ||
+      getsockname(fd, (sockaddr*)&endereco, &tamanho) != 0) {
+    close(fd);
+    return false;
+  }
+  descritor = fd;
+  portaEscuta = ntohs(endereco.sin_port);
+  return true;
+}
+
+// Como no ESP32, o servidor só atende com o WiFi associado
+bool HalServidorTcp::aceitar(HalClienteTcp& cliente) {
+  if (descritor < 0) return false;
+  int fd = accept4(descritor, nullptr, nullptr, SOCK_CLOEXEC);
+  if (fd < 0) return false;
+  if (!associado) {
+    close(fd);
+    return false;
+  }
+  int um = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &um, sizeof(um));
+  cliente.fechar();
+  cliente.descritor = fd;
+  return true;
+}
+
+uint16_t HalServidorTcp::porta() {
+  return portaEscuta;
+}
+
+void HalServidorTcp::parar() {
+  if (descritor >= 0) close(descritor);
+  descritor = -1;
+  portaEscuta = 0;
+}
+
+// ==================== ARMAZENAMENTO ====================
+#define HAL_MAX_ARQUIVOS 4
+static FILE* arquivos[HAL_MAX_ARQUIVOS];
+
+static std::string caminhoLocal(const char* caminho) {
+  return std::string(config.diretorioFlash) + caminho;
+}
+
+void simLimparFlash() {
+  std::string comando = std::string("rm -rf '") + config.diretorioFlash + "'/*";
+  if (system(comando.c_str()) != 0) fprintf(stderr, "falha limpando a flash\n");
+}
+
+bool halArmazenamentoIniciar() {
+  struct stat info;
+  return stat(config.diretorioFlash, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+static int abrirArquivo(const char* caminho, const char* modo) {
+  for (int i = 0; i < HAL_MAX_ARQUIVOS; i++) {
+    if (arquivos[i] == nullptr) {
+      arquivos[i] = fopen(caminhoLocal(caminho).c_str(), modo);
+      return arquivos[i] ? i : -1;
+    }
+  }
+  return -1;
+}
+
+int halArquivoAbrir(const char* caminho, bool escrita) {
+  return abrirArquivo(caminho, escrita ? "wb" : "rb");
+}
+
+int halArquivoAnexar(const char* caminho) {
+  return abrirArquivo(caminho, "ab");
+}
+
+size_t halArquivoLer(int arquivo, void* destino, size_t tamanho) {
+  if (arquivo < 0 || arquivo >= HAL_MAX_ARQUIVOS || !arquivos[arquivo]) return 0;
+  return fread(destino, 1, tamanho, arquivos[arquivo]);
+}
+
+size_t halArquivoEscrever(int arquivo, const void* origem, size_t tamanho) {
+  if (arquivo < 0 || arquivo >= HAL_MAX_ARQUIVOS || !arquivos[arquivo]) return 0;
+  return fwrite(origem, 1, tamanho, arquivos[arquivo]);
+}
+
+bool halArquivoPosicionar(int arquivo, size_t posicao) {
+  if (arquivo < 0 || arquivo >= HAL_MAX_ARQUIVOS || !arquivos[arquivo]) return false;
+  return fseek(arquivos[arquivo], (long)posicao, SEEK_SET) == 0;
+}
+
+size_t halArquivoTamanho(int arquivo) {
+  if (arquivo < 0 || arquivo >= HAL_MAX_ARQUIVOS || !arquivos[arquivo]) return 0;
+  struct stat info;
+  return fstat(fileno(arquivos[arquivo]), &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+void halArquivoFechar(int arquivo) {
+  if (arquivo < 0 || arquivo >= HAL_MAX_ARQUIVOS || !arquivos[arquivo]) return;
+  fclose(arquivos[arquivo]);
+  arquivos[arquivo] = nullptr;
+}
+
+bool halArquivoRemover(const char* caminho) {
+  return remove(caminhoLocal(caminho).c_str()) == 0;
+}
+
+// ==================== HEAP ====================
+// Contabiliza new/delete do processo inteiro contra um heap nominal do
+// tamanho do DRAM livre de um ESP32 após o boot.
+#define HOST_HEAP_NOMINAL 300000u
+
+static std::atomic<size_t> heapEmUso(0);
+static std::atomic<size_t> heapPicoEmUso(0);
+static std::atomic<uint32_t> heapTotalAlocado(0);
+
+static void* alocar(size_t tamanho) {
+  void* p = malloc(tamanho ? tamanho : 1);
+  if (p == nullptr) throw std::bad_alloc();
+  heapTotalAlocado += (uint32_t)tamanho;
+  size_t uso = heapEmUso += malloc_usable_size(p);
+  size_t pico = heapPicoEmUso.load();
+  while (uso > pico && !heapPicoEmUso.compare_exchange_weak(pico, uso)) {
+  }
+  return p;
+}
+
+static void liberar(void* p) {
+  if (p == nullptr) return;
+  heapEmUso -= malloc_usable_size(p);
+  free(p);
+}
+
+void* operator new(size_t tamanho) { return alocar(tamanho); }
+void* operator new[](size_t tamanho) { return alocar(tamanho); }
+void operator delete(void* p) noexcept { liberar(p); }
+void operator delete[](void* p) noexcept { liberar(p); }
+void operator delete(void* p, size_t) noexcept { liberar(p); }
+void operator delete[](void* p, size_t) noexcept { liberar(p); }
+
+uint32_t halHeapLivre() {
+  size_t uso = heapEmUso.load();
+  return uso >= HOST_HEAP_NOMINAL ? 0 : (uint32_t)(HOST_HEAP_NOMINAL - uso);
+}
+
+uint32_t halHeapMinimoLivre() {
+  size_t pico = heapPicoEmUso.load();
+  return pico >= HOST_HEAP_NOMINAL ? 0 : (uint32_t)(HOST_HEAP_NOMINAL - pico);
+}
+
+uint32_t halHeapMaiorBloco() {
+  return halHeapLivre();
+}
+
+uint32_t halHeapBytesAlocados() {
+  return heapTotalAlocado.load();
+}
+
+#endif  // !ARDUINO
@@ -0,0 +1,387 @@
+// Build nativo do WellWork: roda setup()/loop() do sketch sobre a HAL do
+// host por N horas virtuais e imprime um resumo ao final.
+//
+//   wellwork_host [--horas N] [--semente S] [--queda INI FIM] [--falha-dht P]
+//                 [--sem-keepalive] [--status-http COD] [--sem-adaptativo]
+//                 [--crc-dht P] [--ambiente T U LDR] [--energia acordado|leve|profundo]
+//                 [--zonas N] [--metricas PORTA] [--destino thingspeak|mqtt]
+//                 [--perda-puback P] [--historico HORAS PONTOS] [--serial]
+//                 [--gravar ARQ] [--reproduzir ARQ] [--saidas ARQ]
+//
+// --queda pode ser repetido; INI/FIM em horas virtuais desde o boot.
+// --ambiente fixa temperatura, umidade e LDR (só o ruído do sensor varia).
+// --energia escolhe o modo de energia; o sono profundo "reinicia" o sketch
+// (ReinicioSonoProfundo) e o resumo mostra a corrente média estimada.
+// --zonas ativa as N primeiras zonas da tabela do sketch; os sensores das
+// zonas extras veem o ambiente deslocado (simulador.h).
+// --metricas fixa a porta do endpoint de métricas no loopback (padrão:
+// uma livre, mostrada no log); a simulação roda mais rápido que o tempo
+// real, então para raspar à mão use muitas --horas.
+// --destino troca o destino da telemetria; o MQTT vai para o broker stub
+// local, que perde a fração P dos PUBACKs com --perda-puback.
+// --historico consulta, no fim, as últimas HORAS virtuais do histórico da
+// flash reduzidas a PONTOS médias.
+// --gravar grava a trilha dos sensores (trilha_sensores.h) da simulação;
+// --reproduzir roda o sketch sobre uma trilha gravada (aqui ou no ESP32),
+// sem rede, até o fim dela (ou até --horas), o mais rápido possível, e
+// mostra a vazão em dias virtuais por segundo. --saidas escreve o log de
+// saídas (pinos, buzzer, resultado das zonas, pausas, envios e alertas),
+// uma linha por evento, para comparar duas execuções com diff.
+
+#include "../hal.h"
+#include "../agendador.h"
+#include "../alertas_criticos.h"
+#include "../amostragem_adaptativa.h"
+#include "../cliente_http.h"
+#include "../conexao_wifi.h"
+#include "../destino_telemetria.h"
+#include "../fila_telemetria.h"
+#include "../historico.h"
+#include "../log.h"
+#include "../metricas_heap.h"
+#include "../modo_energia.h"
+#include "../saude.h"
+#include "../sensor_dht.h"
+#include "../servidor_metricas.h"
+#include "../telemetria_mqtt.h"
+#include "../trilha_sensores.h"
+#include "../zonas.h"
+#include "broker_stub.h"
+#include "servidor_stub.h"
+#include "simulador.h"
+
+#include <stdio.h>
+
+#include <chrono>
+#include <vector>
+
+void setup();
+void loop();
+
+extern ClienteHttpPersistente clienteThingSpeak;
+
+// Arquivos da trilha e do log de saídas
+static FILE* arquivoTrilha = nullptr;
+static FILE* arquivoSaidas = nullptr;
+
+static size_t escreverTrilha(const uint8_t* dados, size_t tamanho) {
+  return fwrite(dados, 1, tamanho, arquivoTrilha);
+}
+
+static size_t lerTrilha(uint8_t* destino, size_t tamanho) {
+  return fread(destino, 1, tamanho, arquivoTrilha);
+}
+
+static void escreverSaida(const char* linha, size_t tamanho) {
+  fwrite(linha, 1, tamanho, arquivoSaidas);
+  fputc('\n', arquivoSaidas);
+}
+
+static void aoMudarPino(int pino, int nivel) {
+  trilhaSaida("pino ", pino, " ", nivel);
+}
+
+static void aoTocar(int pino, unsigned int frequencia, unsigned long duracaoMs) {
+  trilhaSaida("tom ", pino, " ", frequencia, "Hz ", duracaoMs, "ms");
+}
+
+static void uso(const char* programa) {
+  fprintf(stderr,
+          "uso: %s [--horas N] [--semente S] [--queda INI FIM] [--falha-dht P]\n"
+          "          [--sem-keepalive] [--status-http COD] [--sem-adaptativo]\n"
+          "          [--crc-dht P] [--ambiente T U LDR]\n"
+          "          [--energia acordado|leve|profundo]\n"
+          "          [--zonas N] [--metricas PORTA] [--destino thingspeak|mqtt]\n"
+          "          [--perda-puback P] [--historico HORAS PONTOS] [--serial]\n"
+          "          [--gravar ARQ] [--reproduzir ARQ] [--saidas ARQ]\n",
+          programa);
+}
+
+int main(int argc, char** argv) {
+  ConfigSimulacao sim;
+  ConfigStub stub;
+  ConfigBroker broker;
+  double horas = 24.0;
+  bool horasDadas = false;
+  const char* caminhoGravar = nullptr;
+  const char* caminhoReproduzir = nullptr;
+  const char* caminhoSaidas = nullptr;
+  bool adaptativo = true;
+  bool ambienteFixo = false;
+  float temperaturaFixa = 0, umidadeFixa = 0;
+  int luminosidadeFixa = 0;
+  ModoEnergia modoEnergia = ENERGIA_ACORDADO;
+  double horasHistorico = 0;
+  int pontosHistorico = 0;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    bool temValor = i + 1 < argc;
+    if (!strcmp(a, "--horas") && temValor) {
+      horas = atof(argv[++i]);
+      horasDadas = true;
+    } else if (!strcmp(a, "--semente") && temValor) {
+      sim.semente = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (!strcmp(a, "--queda") && i + 2 < argc) {
+      double inicio = atof(argv[++i]);
+      double fim = atof(argv[++i]);
+      sim.quedasWiFi.push_back({ inicio, fim });
+    } else if (!strcmp(a, "--falha-dht") && temValor) {
+      sim.probabilidadeFalhaDht = atof(argv[++i]);
+    } else if (!strcmp(a, "--crc-dht") && temValor) {
+      sim.probabilidadeErroCrcDht = atof(argv[++i]);
+    } else if (!strcmp(a, "--sem-keepalive")) {
+      stub.fecharAposResposta = true;
+    } else if (!strcmp(a, "--status-http") && temValor) {
+      stub.statusResposta = atoi(argv[++i]);
+    } else if (!strcmp(a, "--sem-adaptativo")) {
+      adaptativo = false;
+    } else if (!strcmp(a, "--ambiente") && i + 3 < argc) {
+      ambienteFixo = true;
+      temperaturaFixa = atof(argv[++i]);
+      umidadeFixa = atof(argv[++i]);
+      luminosidadeFixa = atoi(argv[++i]);
+    } else if (!strcmp(a, "--energia") && temValor) {
+      const char* modo = argv[++i];
+      if (!strcmp(modo, "acordado")) modoEnergia = ENERGIA_ACORDADO;
+      else if (!strcmp(modo, "leve")) modoEnergia = ENERGIA_SONO_LEVE;
+      else if (!strcmp(modo, "profundo")) modoEnergia = ENERGIA_SONO_PROFUNDO;
+      else {
+        uso(argv[0]);
+        return 2;
+      }
+    } else if (!strcmp(a, "--zonas") && temValor) {
+      zonasSelecionarQuantidade(atoi(argv[++i]));
+    } else if (!strcmp(a, "--metricas") && temValor) {
+      metricasSelecionarPorta((uint16_t)atoi(argv[++i]));
+    } else if (!strcmp(a, "--destino") && temValor) {
+      telemetriaSelecionarDestino(argv[++i]);
+    } else if (!strcmp(a, "--perda-puback") && temValor) {
+      broker.probabilidadePerdaPuback = atof(argv[++i]);
+    } else if (!strcmp(a, "--historico") && i + 2 < argc) {
+      horasHistorico = atof(argv[++i]);
+      pontosHistorico = atoi(argv[++i]);
+    } else if (!strcmp(a, "--serial")) {
+      sim.ecoarSerial = true;
+    } else if (!strcmp(a, "--gravar") && temValor) {
+      caminhoGravar = argv[++i];
+    } else if (!strcmp(a, "--reproduzir") && temValor) {
+      caminhoReproduzir = argv[++i];
+    } else if (!strcmp(a, "--saidas") && temValor) {
+      caminhoSaidas = argv[++i];
+    } else {
+      uso(argv[0]);
+      return 2;
+    }
+  }
+
+  if (caminhoGravar && caminhoReproduzir) {
+    uso(argv[0]);
+    return 2;
+  }
+  bool reproduzindo = caminhoReproduzir != nullptr;
+  if (caminhoSaidas != nullptr) {
+    arquivoSaidas = fopen(caminhoSaidas, "w");
+    if (arquivoSaidas == nullptr) {
+      fprintf(stderr, "não foi possível criar %s\n", caminhoSaidas);
+      return 1;
+    }
+    sim.aoMudarPino = aoMudarPino;
+    sim.aoTocar = aoTocar;
+  }
+
+  // A reprodução não usa rede: os envios param na fila
+  if (reproduzindo) {
+    sim.semRede = true;
+  } else {
+    sim.portaHttp = stubIniciar(stub);
+    if (sim.portaHttp == 0) {
+      fprintf(stderr, "não foi possível abrir o stub HTTP\n");
+      return 1;
+    }
+    broker.semente = sim.semente;
+    sim.portaMqtt = brokerIniciar(broker);
+    if (sim.portaMqtt == 0) {
+      fprintf(stderr, "não foi possível abrir o broker MQTT\n");
+      return 1;
+    }
+  }
+  simConfigurar(sim);
+  simLimparFlash();   // Cada execução começa com a flash vazia
+  if (ambienteFixo) simForcarAmbiente(temperaturaFixa, umidadeFixa, luminosidadeFixa);
+
+  // Trilha e log de saídas antes do setup(), como as outras seleções
+  if (caminhoGravar != nullptr || reproduzindo) {
+    arquivoTrilha = fopen(reproduzindo ? caminhoReproduzir : caminhoGravar, reproduzindo ? "rb" : "wb");
+    if (arquivoTrilha == nullptr) {
+      fprintf(stderr, "não foi possível abrir %s\n", reproduzindo ? caminhoReproduzir : caminhoGravar);
+      return 1;
+    }
+    if (!reproduzindo) {
+      trilhaGravar(escreverTrilha);
+    } else if (!trilhaReproduzir(lerTrilha)) {
+      fprintf(stderr, "%s não é uma trilha do WellWork\n", caminhoReproduzir);
+      return 1;
+    }
+  }
+  if (arquivoSaidas != nullptr) trilhaRegistrarSaidas(escreverSaida);
+
+  auto inicioReal = std::chrono::steady_clock::now();
+  uint64_t fimUs = reproduzindo && !horasDadas ? UINT64_MAX : (uint64_t)(horas * sim.msPorHoraVirtual * 1000.0);
+
+  energiaSelecionarModo(modoEnergia);
+  setup();
+  if (!adaptativo) adaptativoHabilitar(false);
+  while (simRelogioUs() < fimUs && !trilhaTerminou()) {
+    try {
+      loop();
+    } catch (const ReinicioSonoProfundo&) {
+      setup();   // Despertar: o sketch recomeça pelo setup(), como no ESP32
+    }
+  }
+  logDescarregar();
+  simFinalizar();
+  trilhaEncerrar();
+  trilhaEscoar();   // Com TRILHA_GRAVAR=1 o último bloco ainda espera a "tarefa de rede"
+  if (arquivoTrilha != nullptr) fclose(arquivoTrilha);
+  if (arquivoSaidas != nullptr) fclose(arquivoSaidas);
+
+  double segundosReais = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicioReal).count();
+  stubParar();
+  brokerParar();
+
+  const SaidasSimulacao& s = simSaidas();
+  EstatisticasStub st = stubEstatisticas();
+  EstatisticasBroker br = brokerEstatisticas();
+  const EstatisticasMqtt& mqtt = mqttEstatisticasConexao();
+  const EstatisticasFila& fila = filaEstatisticas();
+  const EstatisticasWiFi& wifi = wifiEstatisticas();
+  const EstatisticasHttp& http = clienteThingSpeak.estatisticas();
+  const MetricasHeap& heap = heapAtualizarMetricas();
+  const EstatisticasAdaptativo& adapt = adaptativoEstatisticas();
+  const EstatisticasDht& dht = dhtEstatisticas();
+  const EstatisticasEnergia& energia = energiaEstatisticas();
+  const ConsumoSimulado& consumo = s.consumo;
+  double correnteMa = simCorrenteMediaMa();
+
+  printf("\n==================== RESUMO DA SIMULAÇÃO ====================\n");
+  double horasSimuladas = simRelogioUs() / 1000.0 / sim.msPorHoraVirtual;
+  printf("Tempo virtual: %.1f h (%.1f s de relógio do dispositivo) em %.2f s reais\n",
+         horasSimuladas, simRelogioUs() / 1e6, segundosReais);
+  for (int i = 0; i < agendadorTotalTarefas(); i++) {
+    const Tarefa* t = agendadorTarefa(i);
+    printf("Tarefa %-10s execuções=%lu overruns=%lu perdidos=%lu\n",
+           t->nome, t->execucoes, t->overruns, t->periodosPerdidos);
+  }
+  printf("Sensores: %lu transações DHT, %lu conversões ADC\n", s.leiturasDht, s.leiturasAdc);
+  printf("DHT: ok=%lu checksum=%lu sem resposta=%lu adiadas=%lu | consultas=%lu vencidas=%lu idade max=%lu ms\n",
+         dht.sucessos, dht.falhasChecksum, dht.semResposta, dht.adiadas,
+         dht.consultas, dht.consultasVencidas, dht.idadeMaximaMs);
+  const ArmazemZonas& zonas = zonasArmazem();
+  for (int z = 0; z < zonas.total; z++) {
+    printf("Zona %d %-8s score=%d alertas=%d pausa=%d | canal %s\n", z, zonasConfig(z).nome,
+           zonas.score[z], zonas.alertas[z], (int)zonas.statusPausa[z],
+           zonasConfig(z).canalThingSpeak != nullptr ? zonasConfig(z).canalThingSpeak : "-");
+  }
+  printf("LEDs ligados (s): vermelho=%llu azul=%llu escuro=%llu claro=%llu | buzzer=%lu toques\n",
+         s.tempoLigadoMs[12] / 1000, s.tempoLigadoMs[14] / 1000,
+         s.tempoLigadoMs[16] / 1000, s.tempoLigadoMs[17] / 1000, s.toquesBuzzer);
+  printf("Adaptativo: amostras economizadas=%lu envios economizados=%lu (mudança=%lu heartbeat=%lu)\n",
+         adapt.amostrasEconomizadas, adapt.enviosEconomizados, adapt.enviosPorMudanca, adapt.enviosHeartbeat);
+  printf("Energia (%s): corrente média=%.2f mA | acordado=%.1f s sono leve=%.1f s sono profundo=%.1f s rádio=%.1f s\n",
+         energiaNomeModo(energiaModo()), correnteMa,
+         consumo.tempoUs[CONSUMO_ACORDADO] / 1e6, consumo.tempoUs[CONSUMO_SONO_LEVE] / 1e6,
+         consumo.tempoUs[CONSUMO_SONO_PROFUNDO] / 1e6, consumo.tempoRadioUs / 1e6);
+  printf("Energia: sonos leves=%lu profundos=%lu | despertar->leitura média=%lu us max=%lu us | bateria 2000 mAh ≈ %.1f dias\n",
+         consumo.sonosLeves, consumo.sonosProfundos, energia.latenciaMediaUs, energia.latenciaMaxUs,
+         correnteMa > 0 ? 2000.0 / correnteMa / 24.0 : 0.0);
+  printf("WiFi: tentativas=%lu quedas=%lu reconexões=%lu offline=%lu ms\n",
+         wifi.tentativas, wifi.quedas, wifi.reconexoes, wifi.tempoOfflineTotalMs);
+  printf("Fila: enfileiradas=%lu enviadas=%lu descartadas=%lu pendentes=%d pico=%d\n",
+         fila.enfileiradas, fila.enviadas, fila.descartadasOverflow, filaTamanho(), fila.ocupacaoMaxima);
+  printf("HTTP (cliente): requisições=%lu conexões=%lu reaproveitadas=%lu falhas=%lu\n",
+         http.requisicoes, http.conexoesAbertas, http.reaproveitadas, http.falhas);
+  printf("HTTP (stub): conexões=%lu requisições=%lu entradas=%lu alertas=%lu canais=%lu bytes=%llu erros=%lu | %.1f bytes/amostra\n",
+         st.conexoes, st.requisicoes, st.entradas, st.alertas, st.canais, st.bytesRecebidos, st.respostasErro,
+         st.entradas > 0 ? (double)(st.bytesRecebidos + st.bytesEnviados) / st.entradas : 0.0);
+  printf("Telemetria: destino %s\n", telemetriaDestino().nome);
+  printf("MQTT (cliente): conexões=%lu publicações=%lu confirmadas=%lu reenvios=%lu pings=%lu falhas=%lu\n",
+         mqtt.conexoes, mqtt.publicacoes, mqtt.confirmadas, mqtt.reenvios, mqtt.pings, mqtt.falhas);
+  printf("MQTT (broker): conexões=%lu publicações=%lu duplicadas=%lu amostras=%lu alertas=%lu tópicos=%lu "
+         "pubacks perdidos=%lu bytes=%llu | %.1f bytes/amostra\n",
+         br.conexoes, br.publicacoes, br.duplicadas, br.amostras, br.alertas, br.topicos, br.pubacksPerdidos,
+         br.bytesRecebidos, br.amostras > 0 ? (double)(br.bytesRecebidos + br.bytesEnviados) / br.amostras : 0.0);
+  // Latência de ponta a ponta: da amostra crua à confirmação do servidor
+  const EstatisticasAlertas& alertas = alertasEstatisticas();
+  printf("Alertas críticos: transições=%lu notificações=%lu suprimidas=%lu enviados=%lu confirmados=%lu "
+         "pendentes=%d reenvios=%lu coalescidos=%lu descartados=%lu\n",
+         alertas.transicoes, alertas.notificacoes, alertas.suprimidas, alertas.enviados, alertas.confirmados,
+         alertasPendentes(), alertas.reenvios, alertas.coalescidos, alertas.descartados + alertas.descartesFila);
+  if (alertas.confirmados > 0) {
+    printf("Latência dos alertas: média=%lu ms p50<=%lu ms p99<=%lu ms max=%lu ms\n",
+           alertas.latenciaSomaMs / alertas.confirmados, alertasPercentilLatenciaMs(0.5f),
+           alertasPercentilLatenciaMs(0.99f), alertas.latenciaMaxMs);
+    unsigned long inicio = 0;
+    for (int b = 0; b < ALERTA_BALDES_LATENCIA; b++) {
+      unsigned long limite = alertasLimiteBaldeMs(b);
+      unsigned long n = alertas.latenciaBaldes[b];
+      if (n > 0) {
+        int barra = (int)((n * 40 + alertas.confirmados - 1) / alertas.confirmados);
+        if (limite > 0) printf("  %6lu-%-6lu ms %6lu %.*s\n", inicio, limite, n, barra, "########################################");
+        else printf("  %6lu+       ms %6lu %.*s\n", inicio, n, barra, "########################################");
+      }
+      inicio = limite;
+    }
+  }
+  const EstatisticasServidorMetricas& metricas = servidorMetricasEstatisticas();
+  printf("Métricas (porta %u): conexões=%lu requisições=%lu texto=%lu json=%lu maior resposta=%zu bytes\n",
+         servidorMetricasPorta(), metricas.conexoes, metricas.requisicoes, metricas.respostasTexto,
+         metricas.respostasJson, metricas.maiorResposta);
+  const EstatisticasHistorico& hist = historicoEstatisticas();
+  printf("Histórico: amostras=%lu blocos=%lu (%.2f bytes/amostra) rotações=%lu falhas=%lu\n",
+         hist.amostras, hist.blocosGravados,
+         hist.amostrasGravadas > 0 ? (double)hist.blocosGravados * HISTORICO_TAMANHO_BLOCO / hist.amostrasGravadas : 0.0,
+         hist.segmentosRotacionados, hist.falhasGravacao);
+  if (pontosHistorico > 0) {
+    std::vector<PontoHistorico> pontos(pontosHistorico);
+    uint32_t duracaoS = (uint32_t)(horasHistorico * sim.msPorHoraVirtual / 1000.0);
+    int n = historicoConsultarUltimos(duracaoS, pontos.data(), pontosHistorico);
+    printf("Histórico das últimas %.1f h virtuais (%d pontos):\n", horasHistorico, n);
+    for (int i = 0; i < n; i++) {
+      const PontoHistorico& p = pontos[i];
+      printf("  t=%lu s amostras=%u temp=%.1f umid=%.1f ldr=%.0f score=%.1f\n",
+             (unsigned long)p.tempoS, p.amostras, p.temperatura, p.umidade, p.luminosidade, p.score);
+    }
+  }
+  const EstatisticasTrilha& trilha = trilhaEstatisticas();
+  if (trilhaModo() != TRILHA_DESLIGADA) {
+    printf("Trilha (%s): registros=%lu bytes=%llu (%.1f bytes/registro) perdidos=%lu desalinhados=%lu "
+           "desvio max=%lu ms%s\n",
+           reproduzindo ? "reproduzida" : "gravada", trilha.registros, trilha.bytes,
+           trilha.registros > 0 ? (double)trilha.bytes / trilha.registros : 0.0, trilha.perdidos,
+           trilha.desalinhados, trilha.desvioMaxMs, trilha.divergiu ? " | DIVERGIU" : "");
+  }
+  if (arquivoSaidas != nullptr) printf("Log de saídas: %lu eventos em %s\n", trilha.saidas, caminhoSaidas);
+  if (reproduzindo && segundosReais > 0) {
+    double dias = horasSimuladas / 24.0;
+    double diasDispositivo = simRelogioUs() / 1e6 / 86400.0;
+    printf("Reprodução: %.1f dias virtuais (%.2f dias de relógio do dispositivo) em %.2f s reais = "
+           "%.0f dias virtuais/s (%.2f dias do dispositivo/s)\n",
+           dias, diasDispositivo, segundosReais, dias / segundosReais, diasDispositivo / segundosReais);
+  }
+  for (int m = 0; m < TOTAL_MEDIDAS_SAUDE; m++) {
+    MedidaSaude medida = (MedidaSaude)m;
+    const HistogramaSaude& h = saudeHistograma(medida);
+    if (h.total == 0) continue;
+    const char* unidade = saudeUnidade(medida);
+    printf("Saúde %-7s n=%lu média=%lu %s p50<=%lu %s p99<=%lu %s max=%lu %s\n", saudeNomeMedida(medida),
+           (unsigned long)h.total, (unsigned long)(h.soma / h.total), unidade,
+           (unsigned long)saudePercentil(medida, 0.5f), unidade,
+           (unsigned long)saudePercentil(medida, 0.99f), unidade, (unsigned long)h.maximo, unidade);
+  }
+  printf("Watchdog (%d s): maior intervalo entre alimentações=%llu ms disparos=%lu\n", SAUDE_WATCHDOG_MS / 1000,
+         s.maiorIntervaloWatchdogUs / 1000, s.disparosWatchdog);
+  printf("Heap: ticks=%lu com alocação=%lu | serial: %llu bytes\n",
+         heap.ticksMedidos, heap.ticksComAlocacao, s.bytesSerial);
+  return trilha.divergiu ? 1 : 0;
+}
@@ -0,0 +1,29 @@
+# Teste de regressão (CTest): reproduz uma trilha gravada com o
+# wellwork_host e compara o log de saídas com o esperado, byte a byte.
+#
+#   cmake -DHOST=<wellwork_host> -DTRILHA=<arq> -DESPERADO=<arq>
+#         -DSAIDA=<arq> -P reproduzir_trilha.cmake
+#
+# Mudança de comportamento de propósito: grave de novo o esperado com
+#   wellwork_host --reproduzir <trilha> --saidas <esperado>
+
+foreach(variavel HOST TRILHA ESPERADO SAIDA)
+  if(NOT DEFINED ${variavel})
+    message(FATAL_ERROR "faltou -D${variavel}=...")
+  endif()
+endforeach()
+
+execute_process(
+  COMMAND ${HOST} --reproduzir ${TRILHA} --saidas ${SAIDA}
+  RESULT_VARIABLE resultado
+  OUTPUT_QUIET)
+if(NOT resultado EQUAL 0)
+  message(FATAL_ERROR "a reprodução de ${TRILHA} saiu com ${resultado} (trilha divergiu?)")
+endif()
+
+execute_process(
+  COMMAND ${CMAKE_COMMAND} -E compare_files ${ESPERADO} ${SAIDA}
+  RESULT_VARIABLE diferente)
+if(diferente)
+  message(FATAL_ERROR "o log de saídas mudou: diff ${ESPERADO} ${SAIDA}")
+endif()
@@ -0,0 +1,161 @@
+#include "servidor_stub.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+static ConfigStub config;
+static std::atomic<int> statusResposta(202);   // Mudável com o stub rodando
+static EstatisticasStub estatisticas = {};
+static std::set<std::string> canaisVistos;
+static std::mutex muxEstatisticas;
+static std::atomic<bool> rodando(false);
+static std::thread thread;
+static int escuta = -1;
+
+static size_t contarOcorrencias(const std::string& texto, const char* padrao) {
+  size_t n = 0;
+  size_t tam = strlen(padrao);
+  for (size_t p = texto.find(padrao); p != std::string::npos; p = texto.find(padrao, p + tam)) n++;
+  return n;
+}
+
+static bool enviarTudo(int fd, const std::string& dados) {
+  size_t enviados = 0;
+  while (enviados < dados.size()) {
+    ssize_t n = send(fd, dados.data() + enviados, dados.size() - enviados, MSG_NOSIGNAL);
+    if (n <= 0) return false;
+    enviados += (size_t)n;
+  }
+  return true;
+}
+
+// Atende requisições de uma conexão até o cliente fechar
+static void atenderConexao(int fd) {
+  std::string pendente;
+  char bloco[4096];
+
+  while (rodando) {
+    size_t fimCabecalho = pendente.find("\r\n\r\n");
+    if (fimCabecalho != std::string::npos) {
+      size_t tamanhoCorpo = 0;
+      size_t p = pendente.find("Content-Length:");
+      if (p != std::string::npos && p < fimCabecalho) tamanhoCorpo = strtoul(pendente.c_str() + p + 15, nullptr, 10);
+      size_t total = fimCabecalho + 4 + tamanhoCorpo;
+      if (pendente.size() >= total) {
+        std::string corpo = pendente.substr(fimCabecalho + 4, tamanhoCorpo);
+        std::string canal;
+        size_t c = pendente.find("/channels/");
+        if (c != std::string::npos && c < pendente.find("\r\n")) {
+          c += 10;
+          canal = pendente.substr(c, pendente.find('/', c) - c);
+        }
+        pendente.erase(0, total);
+
+        int status = statusResposta;
+        bool erro = status < 200 || status >= 300;
+        {
+          std::lock_guard<std::mutex> trava(muxEstatisticas);
+          estatisticas.requisicoes++;
+          estatisticas.bytesRecebidos += total;
+          if (erro) estatisticas.respostasErro++;
+          else {
+            estatisticas.entradas += contarOcorrencias(corpo, "\"delta_t\"");
+            estatisticas.alertas += contarOcorrencias(corpo, "\"status\"");
+          }
+          if (!canal.empty()) canaisVistos.insert(canal);
+          estatisticas.canais = canaisVistos.size();
+        }
+
+        const char* corpoResposta = erro ? "{\"success\":false}" : "{\"success\":true}";
+        std::string resposta = "HTTP/1.1 " + std::to_string(status) +
+                               (erro ? " Error" : " Accepted") + "\r\n" +
+                               "Content-Type: application/json\r\n" +
+                               "Content-Length: " + std::to_string(strlen(corpoResposta)) + "\r\n" +
+                               (config.fecharAposResposta ? "Connection: close\r\n" : "Connection: keep-alive\r\n") +
+                               "\r\n" + corpoResposta;
+        {
+          std::lock_guard<std::mutex> trava(muxEstatisticas);
+          estatisticas.bytesEnviados += resposta.size();
+        }
+        if (!enviarTudo(fd, resposta) || config.fecharAposResposta) return;
+        continue;
+      }
+    }
+
+    pollfd p = { fd, POLLIN, 0 };
+    if (poll(&p, 1, 100) <= 0) continue;
+    ssize_t n = recv(fd, bloco, sizeof(bloco), 0);
+    if (n <= 0) return;
+    pendente.append(bloco, (size_t)n);
+  }
+}
+
+static void laco() {
+  while (rodando) {
+    pollfd p = { escuta, POLLIN, 0 };
+    if (poll(&p, 1, 100) <= 0) continue;
+    int fd = accept(escuta, nullptr, nullptr);
+    if (fd < 0) continue;
+    {
+      std::lock_guard<std::mutex> trava(muxEstatisticas);
+      estatisticas.conexoes++;
+    }
+    atenderConexao(fd);
+    close(fd);
+  }
+}
+
+uint16_t stubIniciar(const ConfigStub& novaConfig) {
+  config = novaConfig;
+  statusResposta = config.statusResposta;
+  escuta = socket(AF_INET, SOCK_STREAM, 0);
+  if (escuta < 0) return 0;
+
+  int um = 1;
+  setsockopt(escuta, SOL_SOCKET, SO_REUSEADDR, &um, sizeof(um));
+
+  sockaddr_in endereco = {};
+  endereco.sin_family = AF_INET;
+  endereco.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  endereco.sin_port = 0;   // Porta livre qualquer
+  socklen_t tam = sizeof(endereco);
+  if (bind(escuta, (sockaddr*)&endereco, sizeof(endereco)) != 0 ||
+      listen(escuta, 4) != 0 ||
+      getsockname(escuta, (sockaddr*)&endereco, &tam) != 0) {
+    close(escuta);
+    escuta = -1;
+    return 0;
+  }
+
+  rodando = true;
+  thread = std::thread(laco);
+  return ntohs(endereco.sin_port);
+}
+
+void stubParar() {
+  if (!rodando) return;
+  rodando = false;
+  thread.join();
+  close(escuta);
+  escuta = -1;
+}
+
+void stubDefinirStatus(int status) {
+  statusResposta = status;
+}
+
+EstatisticasStub stubEstatisticas() {
+  std::lock_guard<std::mutex> trava(muxEstatisticas);
+  return estatisticas;
+}
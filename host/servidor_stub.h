@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+// ==================== STUB HTTP DO THINGSPEAK ====================
+// Servidor HTTP/1.1 mínimo em 127.0.0.1 numa thread própria. Responde
+// 202 Accepted ao bulk_update (e ao update dos alertas) mantendo a conexão
+// aberta, e conta conexões x requisições para conferir o reaproveitamento
+// do keep-alive.
+
+struct EstatisticasStub {
+  unsigned long conexoes;
+  unsigned long requisicoes;
+  unsigned long entradas;        // Objetos com "delta_t" recebidos
+  unsigned long alertas;         // Atualizações com "status" (alertas críticos)
+  unsigned long canais;          // Canais distintos em /channels/<id>/
+  unsigned long long bytesRecebidos;
+  unsigned long long bytesEnviados;
+  unsigned long respostasErro;
+};
+
+struct ConfigStub {
+  int statusResposta = 202;
+  bool fecharAposResposta = false;   // Simula servidor sem keep-alive
+};
+
+uint16_t stubIniciar(const ConfigStub& config);   // Retorna a porta (0 em falha)
+void stubParar();
+// Troca o status das respostas com o stub rodando (ex.: servidor fora do
+// ar no meio de um cenário da bancada)
+void stubDefinirStatus(int status);
+EstatisticasStub stubEstatisticas();
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+// ==================== SIMULADOR DO HOST ====================
+// Estado do "hardware" visto pela HAL no build nativo: relógio virtual,
+// sensores sintéticos (perfil de um dia de escritório + ruído com semente),
+// WiFi com quedas programadas, redirecionamento do HTTP e do MQTT para os
+// stubs locais e um modelo de consumo de corrente por estado (acordado,
+// rádio, sonos).
+
+struct IntervaloQueda {
+  double horaInicio;   // Horas virtuais desde o boot
+  double horaFim;
+};
+
+struct ConfigSimulacao {
+  uint32_t semente = 42;
+  unsigned long msPorHoraVirtual = 5000;   // SEGUNDOS_POR_HORA_VIRTUAL * 1000
+  int horaInicial = 7;                     // HORA_INICIAL
+  unsigned long atrasoAssociacaoMs = 1200; // Tempo até o GOT_IP
+  unsigned long atrasoReconexaoRapidaMs = 300;   // Com canal/BSSID já conhecidos
+  std::vector<IntervaloQueda> quedasWiFi;
+  double probabilidadeFalhaDht = 0.0;      // Transação sem resposta do sensor
+  double probabilidadeErroCrcDht = 0.0;    // Quadro com um bit trocado
+  unsigned long duracaoTransacaoDhtUs = 5000;   // Start + resposta + 40 bits
+  float ruidoAdc = 25.0f;                  // Desvio das conversões do LDR
+  double probabilidadePicoAdc = 0.005;     // Conversões com pico (WiFi transmitindo)
+  float amplitudePicoAdc = 600.0f;
+  // Sensores das outras zonas: o ambiente deslocado pelo índice do sensor
+  float deslocamentoTemperaturaPorZona = 1.5f;
+  float deslocamentoUmidadePorZona = -4.0f;
+  float deslocamentoLuzPorZona = -900.0f;
+  uint16_t portaHttp = 0;                  // Conexões para a porta 80 vão para cá
+  uint16_t portaMqtt = 0;                  // ...e as para a 1883, para o broker local
+  const char* diretorioFlash = "wellwork_flash";
+  bool ecoarSerial = false;                // Copia a serial para o stdout
+  bool semRede = false;                    // Sem AP nem sockets de escuta (reprodução de trilha)
+
+  // Observadores das saídas (log de saídas da reprodução)
+  void (*aoMudarPino)(int pino, int nivel) = nullptr;
+  void (*aoTocar)(int pino, unsigned int frequencia, unsigned long duracaoMs) = nullptr;
+
+  // Modelo de consumo (ordens de grandeza da folha de dados do ESP32).
+  // O código do sketch não gasta tempo virtual, então o tempo acordado
+  // é o das esperas, dos boots e das sessões de rádio
+  float correnteAcordadoMa = 30.0f;        // CPU ligada, rádio desligado
+  float correnteRadioMa = 90.0f;           // Adicional com o WiFi ligado
+  float correnteSonoLeveMa = 0.8f;
+  float correnteSonoProfundoMa = 0.01f;    // RTC + memória RTC
+  unsigned long despertarLeveUs = 500;     // Do timer até voltar a executar
+  unsigned long bootSonoProfundoMs = 120;  // ROM + bootloader + início do app
+};
+
+enum EstadoConsumo {
+  CONSUMO_ACORDADO,
+  CONSUMO_SONO_LEVE,
+  CONSUMO_SONO_PROFUNDO,
+  TOTAL_ESTADOS_CONSUMO
+};
+
+struct ConsumoSimulado {
+  unsigned long long tempoUs[TOTAL_ESTADOS_CONSUMO] = {};
+  unsigned long long tempoRadioUs = 0;
+  double cargaMaUs = 0;                    // Integral da corrente no tempo
+  unsigned long sonosLeves = 0;
+  unsigned long sonosProfundos = 0;
+};
+
+// Lançada por halDormirProfundo(): quem roda o loop() captura e chama
+// setup() de novo, como no despertar do ESP32
+struct ReinicioSonoProfundo {};
+
+struct SaidasSimulacao {
+  unsigned long long bytesSerial = 0;
+  unsigned long toquesBuzzer = 0;
+  unsigned long leiturasDht = 0;           // Transações (start + quadro)
+  unsigned long leiturasAdc = 0;           // Conversões entregues pelo ADC contínuo
+  unsigned long eventosWiFi = 0;
+  unsigned long disparosWatchdog = 0;      // Alimentações depois do prazo (no ESP32, reboots)
+  unsigned long long maiorIntervaloWatchdogUs = 0;
+  unsigned long long tempoLigadoMs[40] = {};   // Por pino GPIO
+  ConsumoSimulado consumo;
+};
+
+void simConfigurar(const ConfigSimulacao& config);
+const ConfigSimulacao& simConfig();
+uint64_t simRelogioUs();
+double simHoraVirtual();           // Hora do dia (0-24, fracionária)
+bool simWiFiAssociado();
+double simCorrenteMediaMa();       // Carga total / tempo desde o início
+const SaidasSimulacao& simSaidas();
+void simFinalizar();               // Fecha a contabilidade dos LEDs
+void simLimparFlash();
+
+// Valores "verdadeiros" do ambiente na hora virtual atual (sem ruído)
+float simTemperaturaAmbiente();
+float simUmidadeAmbiente();
+int simLuminosidadeAmbiente();
+
+// Fixa o ambiente (cenários de benchmark); simLiberarAmbiente() volta ao perfil
+void simForcarAmbiente(float temperatura, float umidade, int luminosidade);
+void simLiberarAmbiente();
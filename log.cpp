@@ -0,0 +1,162 @@
+#include "log.h"
+
+#define LOG_MARCADOR_BINARIO 0xA5
+#define LOG_BLOCO_DRENAGEM 128
+
+static char anel[LOG_TAMANHO_BUFFER];
+static size_t cabeca = 0;      // Próximo byte a sair para a UART
+static size_t ocupado = 0;
+static FormatoLog formatoAtual = LOG_FORMATO_TEXTO;
+static EstatisticasLog estatisticas = {};
+
+// Supressão de repetições consecutivas
+static uint32_t ultimoHash = 0;
+static const char* ultimaTag = "";
+static int ultimoNivel = LOG_NIVEL_INFO;
+static unsigned long inicioJanela = 0;
+static unsigned long repeticoes = 0;
+
+// Produtores nos dois núcleos: seção crítica curta (só memcpy)
+static HalMutex muxLog;
+
+static const char letraNivel[] = { '-', 'E', 'W', 'I', 'D' };
+
+static uint32_t hashMensagem(const char* tag, const char* texto, size_t tamanho) {
+  uint32_t h = 2166136261UL;   // FNV-1a
+  for (const char* p = tag; *p; p++) h = (h ^ (uint8_t)*p) * 16777619UL;
+  for (size_t i = 0; i < tamanho; i++) h = (h ^ (uint8_t)texto[i]) * 16777619UL;
+  return h;
+}
+
+static void copiarParaAnel(const void* origem, size_t n) {
+  const char* bytes = (const char*)origem;
+  size_t cauda = (cabeca + ocupado) % LOG_TAMANHO_BUFFER;
+  size_t primeiro = min(n, (size_t)(LOG_TAMANHO_BUFFER - cauda));
+  memcpy(anel + cauda, bytes, primeiro);
+  memcpy(anel, bytes + primeiro, n - primeiro);
+  ocupado += n;
+}
+
+// Chamada com o mux travado
+static void emitir(int nivel, const char* tag, const char* texto, size_t tamanho) {
+  char prefixo[40];
+  size_t tamPrefixo = 0;
+  size_t tamTag = strlen(tag);
+  if (tamTag > 16) tamTag = 16;
+
+  if (formatoAtual == LOG_FORMATO_BINARIO) {
+    // [A5][ms u32 LE][nivel][tamTag][tag][tamMsg][msg]
+    uint32_t ms = halMillis();
+    if (tamanho > 255) tamanho = 255;
+    prefixo[tamPrefixo++] = (char)LOG_MARCADOR_BINARIO;
+    memcpy(prefixo + tamPrefixo, &ms, sizeof(ms));
+    tamPrefixo += sizeof(ms);
+    prefixo[tamPrefixo++] = (char)nivel;
+    prefixo[tamPrefixo++] = (char)tamTag;
+    memcpy(prefixo + tamPrefixo, tag, tamTag);
+    tamPrefixo += tamTag;
+    prefixo[tamPrefixo++] = (char)tamanho;
+  } else {
+    EscritorTexto p(prefixo, sizeof(prefixo));
+    if (formatoAtual == LOG_FORMATO_CSV) {
+      p << halMillis() << ";" << letraNivel[nivel] << ";";
+      p.anexar(tag, tamTag);
+      p << ";";
+    } else {
+      p << "[" << letraNivel[nivel] << "][";
+      p.anexar(tag, tamTag);
+      p << "] ";
+    }
+    tamPrefixo = p.tamanho();
+  }
+
+  size_t terminador = formatoAtual == LOG_FORMATO_BINARIO ? 0 : 1;
+  size_t total = tamPrefixo + tamanho + terminador;
+  if (total > LOG_TAMANHO_BUFFER - ocupado) {
+    estatisticas.descartadasBufferCheio++;
+    return;
+  }
+
+  copiarParaAnel(prefixo, tamPrefixo);
+  copiarParaAnel(texto, tamanho);
+  if (terminador) copiarParaAnel("\n", 1);
+
+  estatisticas.publicadas++;
+  if (ocupado > estatisticas.ocupacaoMaxima) estatisticas.ocupacaoMaxima = ocupado;
+}
+
+void logIniciar(FormatoLog formato) {
+  formatoAtual = formato;
+}
+
+void logDefinirFormato(FormatoLog formato) {
+  halTravar(muxLog);
+  formatoAtual = formato;
+  halDestravar(muxLog);
+}
+
+void logPublicar(int nivel, const char* tag, const char* texto, size_t tamanho) {
+  if (nivel < LOG_NIVEL_ERRO || nivel > LOG_NIVEL_DEBUG) return;
+  uint32_t h = hashMensagem(tag, texto, tamanho);
+  unsigned long agora = halMillis();
+
+  halTravar(muxLog);
+  if (h == ultimoHash && agora - inicioJanela < LOG_JANELA_REPETICAO_MS) {
+    repeticoes++;
+    estatisticas.suprimidasRepeticao++;
+    halDestravar(muxLog);
+    return;
+  }
+
+  if (repeticoes > 0) {
+    char aviso[48];
+    EscritorTexto a(aviso, sizeof(aviso));
+    a << "(mensagem anterior repetida " << repeticoes << "x)";
+    emitir(ultimoNivel, ultimaTag, a.c_str(), a.tamanho());
+  }
+
+  ultimoHash = h;
+  ultimaTag = tag;
+  ultimoNivel = nivel;
+  inicioJanela = agora;
+  repeticoes = 0;
+
+  emitir(nivel, tag, texto, tamanho);
+  halDestravar(muxLog);
+}
+
+size_t logDrenar() {
+  size_t enviados = 0;
+  char bloco[LOG_BLOCO_DRENAGEM];
+
+  for (;;) {
+    int livre = halSerialEspacoLivre();
+    if (livre <= 0) break;
+
+    halTravar(muxLog);
+    size_t contiguo = min(ocupado, (size_t)(LOG_TAMANHO_BUFFER - cabeca));
+    size_t n = min(contiguo, min((size_t)livre, sizeof(bloco)));
+    memcpy(bloco, anel + cabeca, n);
+    cabeca = (cabeca + n) % LOG_TAMANHO_BUFFER;
+    ocupado -= n;
+    halDestravar(muxLog);
+
+    if (n == 0) break;
+    halSerialEscrever((const uint8_t*)bloco, n);
+    enviados += n;
+  }
+
+  estatisticas.bytesEscritos += enviados;
+  return enviados;
+}
+
+void logDescarregar() {
+  while (ocupado > 0) {
+    if (logDrenar() == 0) halDelay(1);
+  }
+  halSerialDescarregar();
+}
+
+const EstatisticasLog& logEstatisticas() {
+  return estatisticas;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "hal.h"
+
+#include <initializer_list>
+
+#include "formatador.h"
+
+// ==================== LOG COM NÍVEIS ====================
+// LOG_ERRO / LOG_AVISO / LOG_INFO / LOG_DEBUG(tag, partes...).
+// Níveis acima de LOG_NIVEL_COMPILADO ficam atrás de um if (false): o
+// compilador ainda confere os tipos, mas nem os argumentos são avaliados
+// nem sobra código no binário. Os habilitados são formatados na pilha e
+// copiados para um buffer circular, que a tarefa "log" escoa para a UART
+// só até o espaço livre do TX - quem loga nunca espera pela serial.
+// Mensagens idênticas em sequência são contadas em vez de repetidas.
+
+#define LOG_NIVEL_NENHUM 0
+#define LOG_NIVEL_ERRO 1
+#define LOG_NIVEL_AVISO 2
+#define LOG_NIVEL_INFO 3
+#define LOG_NIVEL_DEBUG 4
+
+// Ajuste aqui (ou com -DLOG_NIVEL_COMPILADO=...) o nível gerado no binário.
+// LOG_NIVEL_DEBUG inclui o dump completo de cada tick.
+#ifndef LOG_NIVEL_COMPILADO
+#define LOG_NIVEL_COMPILADO LOG_NIVEL_INFO
+#endif
+
+#define TAMANHO_LINHA_LOG 160            // Linha formatada na pilha
+#define LOG_TAMANHO_BUFFER 4096          // Buffer circular entre quem loga e a UART
+#define LOG_BUFFER_TX_UART 1024          // Buffer de TX do driver da serial
+#define LOG_JANELA_REPETICAO_MS 10000    // Repetições dentro da janela são contadas
+
+enum FormatoLog {
+  LOG_FORMATO_TEXTO,     // [I][WIFI] mensagem
+  LOG_FORMATO_CSV,       // ms;I;WIFI;mensagem
+  LOG_FORMATO_BINARIO    // Quadro compacto para captura em alta taxa
+};
+
+struct EstatisticasLog {
+  unsigned long publicadas;
+  unsigned long descartadasBufferCheio;
+  unsigned long suprimidasRepeticao;
+  unsigned long bytesEscritos;
+  size_t ocupacaoMaxima;
+};
+
+void logIniciar(FormatoLog formato);
+void logDefinirFormato(FormatoLog formato);
+void logPublicar(int nivel, const char* tag, const char* texto, size_t tamanho);
+size_t logDrenar();         // Não bloqueia; retorna bytes enviados à UART
+void logDescarregar();      // Bloqueia até esvaziar (antes de reiniciar/dormir)
+const EstatisticasLog& logEstatisticas();
+
+template <typename... Partes>
+void logEscrever(int nivel, const char* tag, const Partes&... partes) {
+  BufferTexto<TAMANHO_LINHA_LOG> linha;
+  (void)std::initializer_list<int>{ ((void)(linha << partes), 0)... };
+  logPublicar(nivel, tag, linha.c_str(), linha.tamanho());
+}
+
+#if LOG_NIVEL_COMPILADO >= LOG_NIVEL_ERRO
+#define LOG_ERRO(tag, ...) logEscrever(LOG_NIVEL_ERRO, tag, __VA_ARGS__)
+#else
+#define LOG_ERRO(tag, ...) do { if (false) logEscrever(LOG_NIVEL_ERRO, tag, __VA_ARGS__); } while (0)
+#endif
+
+#if LOG_NIVEL_COMPILADO >= LOG_NIVEL_AVISO
+#define LOG_AVISO(tag, ...) logEscrever(LOG_NIVEL_AVISO, tag, __VA_ARGS__)
+#else
+#define LOG_AVISO(tag, ...) do { if (false) logEscrever(LOG_NIVEL_AVISO, tag, __VA_ARGS__); } while (0)
+#endif
+
+#if LOG_NIVEL_COMPILADO >= LOG_NIVEL_INFO
+#define LOG_INFO(tag, ...) logEscrever(LOG_NIVEL_INFO, tag, __VA_ARGS__)
+#else
+#define LOG_INFO(tag, ...) do { if (false) logEscrever(LOG_NIVEL_INFO, tag, __VA_ARGS__); } while (0)
+#endif
+
+#if LOG_NIVEL_COMPILADO >= LOG_NIVEL_DEBUG
+#define LOG_DEBUG(tag, ...) logEscrever(LOG_NIVEL_DEBUG, tag, __VA_ARGS__)
+#else
+#define LOG_DEBUG(tag, ...) do { if (false) logEscrever(LOG_NIVEL_DEBUG, tag, __VA_ARGS__); } while (0)
+#endif
@@ -0,0 +1,43 @@
+#include "metricas_heap.h"
+
+#include "log.h"
+
+static MetricasHeap metricas = {};
+static uint32_t livreNoInicio = 0;
+
+void heapInicioTick() {
+  livreNoInicio = halHeapLivre();
+}
+
+void heapFimTick() {
+  // A tarefa de rede roda no outro núcleo e também mexe no heap, então um
+  // tick isolado pode aparecer com ruído; o que importa é a tendência
+  long consumo = (long)livreNoInicio - (long)halHeapLivre();
+  metricas.ticksMedidos++;
+  if (consumo > 0) {
+    metricas.ticksComAlocacao++;
+    if (consumo > metricas.maiorConsumoTick) {
+      metricas.maiorConsumoTick = consumo;
+    }
+  }
+}
+
+const MetricasHeap& heapAtualizarMetricas() {
+  metricas.livreAtual = halHeapLivre();
+  metricas.livreMinimo = halHeapMinimoLivre();
+  metricas.maiorBlocoLivre = halHeapMaiorBloco();
+  metricas.fragmentacaoPercentual = metricas.livreAtual > 0
+      ? 100 - (int)((uint64_t)metricas.maiorBlocoLivre * 100 / metricas.livreAtual)
+      : 0;
+  return metricas;
+}
+
+void heapImprimirMetricas() {
+  heapAtualizarMetricas();
+  LOG_INFO("HEAP", "🧠 Heap: livre=", metricas.livreAtual,
+                " minimo=", metricas.livreMinimo,
+                " maiorBloco=", metricas.maiorBlocoLivre,
+                " fragmentacao=", metricas.fragmentacaoPercentual, "%",
+                " ticksComAlocacao=", metricas.ticksComAlocacao, "/", metricas.ticksMedidos,
+                " piorTick=", metricas.maiorConsumoTick, "B");
+}
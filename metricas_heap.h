@@ -0,0 +1,23 @@
+#pragma once
+
+#include "hal.h"
+
+// ==================== MÉTRICAS DE HEAP ====================
+// Mede a variação do heap livre em volta de cada tick de sensoriamento
+// para provar que o regime permanente não aloca, e acompanha a
+// fragmentação (maior bloco livre x heap livre total).
+
+struct MetricasHeap {
+  uint32_t livreAtual;
+  uint32_t livreMinimo;         // Marca d'água desde o boot
+  uint32_t maiorBlocoLivre;
+  int fragmentacaoPercentual;   // 0 = heap livre contíguo
+  unsigned long ticksMedidos;
+  unsigned long ticksComAlocacao;   // Ticks que terminaram com menos heap
+  long maiorConsumoTick;            // Bytes, pior tick
+};
+
+void heapInicioTick();
+void heapFimTick();
+const MetricasHeap& heapAtualizarMetricas();
+void heapImprimirMetricas();
@@ -0,0 +1,97 @@
+#include "modo_energia.h"
+
+#include "log.h"
+
+#define ENERGIA_MARCADOR_RTC 0x57574553UL   // "WWES"
+
+// Tudo na RTC: o modo, o instante programado do despertar e os contadores
+// precisam atravessar o sono profundo
+struct EstadoEnergia {
+  uint32_t marcador;             // Gravado antes de dormir; confirma a RTC no despertar
+  ModoEnergia modo;
+  bool aguardandoAmostra;
+  uint32_t despertarProgramadoUs;
+  unsigned long long latenciaSomaUs;
+  EstatisticasEnergia estatisticas;
+};
+
+static HAL_RETIDO EstadoEnergia estado = { 0, MODO_ENERGIA_PADRAO, false, 0, 0, {} };
+
+static const char* const nomesModos[] = { "acordado", "sono_leve", "sono_profundo" };
+
+void energiaSelecionarModo(ModoEnergia modo) {
+  estado.modo = modo;
+}
+
+bool energiaIniciar() {
+  bool retomado = halDespertouDoSonoProfundo() && estado.marcador == ENERGIA_MARCADOR_RTC;
+  estado.marcador = 0;   // Vale só para este despertar
+
+  if (!retomado) {
+    estado.aguardandoAmostra = false;
+    estado.latenciaSomaUs = 0;
+    estado.estatisticas = EstatisticasEnergia();
+  }
+  return retomado;
+}
+
+ModoEnergia energiaModo() {
+  return estado.modo;
+}
+
+const char* energiaNomeModo(ModoEnergia modo) {
+  return nomesModos[modo];
+}
+
+bool energiaDormir(unsigned long esperaMs, bool permitido) {
+  if (estado.modo == ENERGIA_ACORDADO || !permitido || esperaMs < ENERGIA_SONO_LEVE_MINIMO_MS) {
+    return false;
+  }
+
+  // A UART para durante o sono: o log sai antes
+  logDescarregar();
+
+  EstatisticasEnergia& e = estado.estatisticas;
+  e.tempoDormindoMs += esperaMs;
+  estado.aguardandoAmostra = true;
+
+  if (estado.modo == ENERGIA_SONO_PROFUNDO && esperaMs >= ENERGIA_SONO_PROFUNDO_MINIMO_MS) {
+    unsigned long sonoMs = esperaMs - ENERGIA_BOOT_ESTIMADO_MS;
+    estado.despertarProgramadoUs = (uint32_t)(halMicros() + sonoMs * 1000UL);
+    estado.marcador = ENERGIA_MARCADOR_RTC;
+    e.sonosProfundos++;
+    halDormirProfundo(sonoMs);
+  }
+
+  estado.despertarProgramadoUs = (uint32_t)(halMicros() + esperaMs * 1000UL);
+  e.sonosLeves++;
+  halDormirLeve(esperaMs);
+  return true;
+}
+
+void energiaMarcarAmostra() {
+  if (!estado.aguardandoAmostra) return;
+  estado.aguardandoAmostra = false;
+
+  // Leitura antes do despertar programado (acordou cedo) conta como zero
+  int32_t latencia = (int32_t)((uint32_t)halMicros() - estado.despertarProgramadoUs);
+  unsigned long latenciaUs = latencia > 0 ? (unsigned long)latencia : 0;
+
+  EstatisticasEnergia& e = estado.estatisticas;
+  e.amostrasAposDespertar++;
+  estado.latenciaSomaUs += latenciaUs;
+  e.latenciaMediaUs = (unsigned long)(estado.latenciaSomaUs / e.amostrasAposDespertar);
+  if (latenciaUs > e.latenciaMaxUs) e.latenciaMaxUs = latenciaUs;
+}
+
+const EstatisticasEnergia& energiaEstatisticas() {
+  return estado.estatisticas;
+}
+
+void energiaImprimirEstatisticas() {
+  const EstatisticasEnergia& e = estado.estatisticas;
+  LOG_INFO("ENERGIA", "🔋 Energia: modo=", energiaNomeModo(estado.modo),
+           " sonosLeves=", e.sonosLeves, " sonosProfundos=", e.sonosProfundos,
+           " dormindo=", (unsigned long)(e.tempoDormindoMs / 1000), "s",
+           " latencia media=", e.latenciaMediaUs, "us max=", e.latenciaMaxUs, "us");
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "hal.h"
+
+// ==================== MODO DE ENERGIA ====================
+// Decide o que fazer no tempo livre entre as tarefas do agendador:
+//
+//   ENERGIA_ACORDADO      - halDelay(), rádio sempre ligado (alimentação USB)
+//   ENERGIA_SONO_LEVE     - sono leve entre as tarefas; RAM e GPIO mantidos
+//   ENERGIA_SONO_PROFUNDO - sono profundo nas esperas longas (leve nas
+//                           curtas); o estado HAL_RETIDO fica na RTC e o
+//                           setup() pula a reinicialização no despertar
+//
+// Nos dois modos de sono o WiFi só liga quando há lote para enviar, e só
+// se dorme com o rádio desligado e a tarefa de rede ociosa.
+
+#ifndef MODO_ENERGIA_PADRAO
+#define MODO_ENERGIA_PADRAO ENERGIA_ACORDADO
+#endif
+
+#define ENERGIA_SONO_LEVE_MINIMO_MS 10         // Menos que isso não paga o despertar
+#define ENERGIA_SONO_PROFUNDO_MINIMO_MS 3000   // Abaixo disso o boot gasta mais que o sono leve
+#define ENERGIA_BOOT_ESTIMADO_MS 120           // Desperta antes para amostrar na hora
+#define ENERGIA_AMOSTRAS_POR_CONEXAO 4         // Lote mínimo para ligar o rádio...
+#define ENERGIA_ESPERA_MAXIMA_ENVIO_MS 60000   // ...ou idade máxima da amostra mais antiga
+
+enum ModoEnergia : uint8_t {
+  ENERGIA_ACORDADO,
+  ENERGIA_SONO_LEVE,
+  ENERGIA_SONO_PROFUNDO
+};
+
+struct EstatisticasEnergia {
+  unsigned long sonosLeves;
+  unsigned long sonosProfundos;
+  unsigned long long tempoDormindoMs;
+  unsigned long amostrasAposDespertar;
+  unsigned long latenciaMediaUs;     // Do fim do sono programado até a leitura
+  unsigned long latenciaMaxUs;
+};
+
+// Antes do setup() (ex.: opção do build nativo); vale até o próximo boot frio
+void energiaSelecionarModo(ModoEnergia modo);
+
+// No início do setup(). true = despertou do sono profundo com a RTC
+// válida, e os módulos HAL_RETIDO não devem ser reiniciados
+bool energiaIniciar();
+
+ModoEnergia energiaModo();
+const char* energiaNomeModo(ModoEnergia modo);
+
+// Dorme pela espera do agendador se o modo e "permitido" deixarem.
+// false = não dormiu (o chamador faz a espera normal). No sono profundo
+// não retorna.
+bool energiaDormir(unsigned long esperaMs, bool permitido);
+
+// No início de cada leitura dos sensores: mede a latência desde o despertar
+void energiaMarcarAmostra();
+
+const EstatisticasEnergia& energiaEstatisticas();
+void energiaImprimirEstatisticas();
@@ -0,0 +1,121 @@
+#include "perfil_estagios.h"
+
+#include <algorithm>
+
+#include "log.h"
+
+struct JanelaEstagio {
+  uint32_t ciclos[PERFIL_AMOSTRAS_ESTAGIO];
+  unsigned long total;
+};
+
+static JanelaEstagio janelas[TOTAL_ESTAGIOS];
+
+static const char* const nomesEstagios[TOTAL_ESTAGIOS] = {
+  "ldr", "dht", "score", "decisao", "tick", "atuacao", "pausas", "envio", "rede",
+  "metricas", "raspagem"
+};
+
+// Heap por tick
+static uint32_t alocadosNoInicio = 0;
+static uint32_t livreNoInicio = 0;
+static unsigned long ticksHeap = 0;
+static unsigned long long bytesHeapSoma = 0;
+static uint32_t bytesHeapMax = 0;
+
+uint32_t perfilMarca() {
+  return halCiclos();
+}
+
+void perfilRegistrar(EstagioTick estagio, uint32_t marcaInicio) {
+  JanelaEstagio& j = janelas[estagio];
+  j.ciclos[j.total & (PERFIL_AMOSTRAS_ESTAGIO - 1)] = halCiclos() - marcaInicio;
+  j.total++;
+}
+
+void perfilInicioTick() {
+  alocadosNoInicio = halHeapBytesAlocados();
+  livreNoInicio = halHeapLivre();
+}
+
+void perfilFimTick() {
+  // Sem heap tracing (ESP32) só dá para ver o saldo; no host conta também
+  // o que foi alocado e liberado dentro do próprio tick
+  uint32_t alocados = halHeapBytesAlocados() - alocadosNoInicio;
+  uint32_t livreAgora = halHeapLivre();
+  uint32_t saldo = livreNoInicio > livreAgora ? livreNoInicio - livreAgora : 0;
+  uint32_t bytes = max(alocados, saldo);
+
+  ticksHeap++;
+  bytesHeapSoma += bytes;
+  if (bytes > bytesHeapMax) bytesHeapMax = bytes;
+}
+
+static uint32_t paraNs(uint32_t ciclos) {
+  return (uint32_t)((uint64_t)ciclos * 1000 / halCiclosPorUs());
+}
+
+void perfilResumo(EstagioTick estagio, ResumoEstagio& resumo) {
+  const JanelaEstagio& j = janelas[estagio];
+  resumo = {};
+  resumo.nome = nomesEstagios[estagio];
+  resumo.amostras = j.total;
+  if (j.total == 0) return;
+
+  size_t n = min(j.total, (unsigned long)PERFIL_AMOSTRAS_ESTAGIO);
+  uint32_t valores[PERFIL_AMOSTRAS_ESTAGIO];
+  memcpy(valores, j.ciclos, n * sizeof(uint32_t));
+
+  // Só quatro posições interessam: duas seleções em vez de ordenar tudo.
+  // A segunda fica à direita da mediana para não mexer nela
+  size_t mediana = n / 2;
+  size_t p99 = min(n - 1, (n * 99 + 99) / 100 - 1);
+  std::nth_element(valores, valores + mediana, valores + n);
+  if (p99 > mediana) std::nth_element(valores + mediana + 1, valores + p99, valores + n);
+
+  resumo.minNs = paraNs(*std::min_element(valores, valores + mediana + 1));
+  resumo.medianaNs = paraNs(valores[mediana]);
+  resumo.p99Ns = paraNs(valores[p99]);
+  resumo.maxNs = paraNs(*std::max_element(valores + p99, valores + n));
+}
+
+ResumoHeapTick perfilResumoHeap() {
+  ResumoHeapTick r = {};
+  r.ticks = ticksHeap;
+  r.bytesMedio = ticksHeap > 0 ? (uint32_t)(bytesHeapSoma / ticksHeap) : 0;
+  r.bytesMax = bytesHeapMax;
+  return r;
+}
+
+const char* perfilNomeEstagio(EstagioTick estagio) {
+  return nomesEstagios[estagio];
+}
+
+void perfilZerar() {
+  for (int e = 0; e < TOTAL_ESTAGIOS; e++) {
+    janelas[e].total = 0;
+  }
+  ticksHeap = 0;
+  bytesHeapSoma = 0;
+  bytesHeapMax = 0;
+}
+
+void perfilEscreverCsv(EscritorTexto& saida, EstagioTick estagio) {
+  ResumoEstagio r;
+  perfilResumo(estagio, r);
+  saida << r.nome << ";" << r.amostras << ";" << (unsigned long)r.minNs << ";"
+        << (unsigned long)r.medianaNs << ";" << (unsigned long)r.p99Ns << ";"
+        << (unsigned long)r.maxNs;
+}
+
+void perfilImprimir() {
+  for (int e = 0; e < TOTAL_ESTAGIOS; e++) {
+    if (janelas[e].total == 0) continue;
+    BufferTexto<80> linha;
+    perfilEscreverCsv(linha, (EstagioTick)e);
+    LOG_INFO("PERF", "⏱️ ", linha.c_str());
+  }
+  ResumoHeapTick heap = perfilResumoHeap();
+  LOG_INFO("PERF", "⏱️ heap_tick;", heap.ticks, ";medio=", (unsigned long)heap.bytesMedio,
+           "B;max=", (unsigned long)heap.bytesMax, "B");
+}
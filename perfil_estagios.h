@@ -0,0 +1,74 @@
+#pragma once
+
+#include "hal.h"
+
+#include "formatador.h"
+
+// ==================== PERFIL DOS ESTÁGIOS DO TICK ====================
+// Mede em ciclos de CPU (ESP.getCycleCount(); nanossegundos no host) cada
+// estágio do pipeline de sensoriamento e guarda as últimas
+// PERFIL_AMOSTRAS_ESTAGIO durações por estágio para tirar min/mediana/
+// p99/máx. Cada estágio é escrito por um único núcleo, sem lock.
+// PERFIL_HABILITADO=0 remove toda a instrumentação do binário.
+
+#ifndef PERFIL_HABILITADO
+#define PERFIL_HABILITADO 1
+#endif
+
+#ifndef PERFIL_AMOSTRAS_ESTAGIO
+#define PERFIL_AMOSTRAS_ESTAGIO 256   // Potência de 2
+#endif
+
+enum EstagioTick {
+  ESTAGIO_LDR,        // luzAmostrar(): filtro de todos os LDRs
+  ESTAGIO_DHT,        // Caches do DHT e LDR de cada zona no armazém
+  ESTAGIO_SCORE,      // zonasAvaliar(): regras, score e pausas de todas as zonas
+  ESTAGIO_DECISAO,    // tomarDecisaoAmbiental() com o log
+  ESTAGIO_TICK,       // executarSistemaWellWork() inteiro
+  ESTAGIO_ATUACAO,    // tarefaAtuacao(): LEDs de alerta
+  ESTAGIO_PAUSAS,     // tarefaPausas(): agenda de pausas e avisos do dia
+  ESTAGIO_ENVIO,      // tarefaEnvio(): fecha as janelas + entrega ao núcleo de rede
+  ESTAGIO_REDE,       // drenarFilaThingSpeak() no núcleo 0 (HTTP)
+  ESTAGIO_METRICAS,   // metricasCapturar(): foto do estado para o endpoint local
+  ESTAGIO_RASPAGEM,   // Uma resposta do endpoint de métricas no núcleo 0
+  TOTAL_ESTAGIOS
+};
+
+struct ResumoEstagio {
+  const char* nome;
+  unsigned long amostras;   // Total desde o último perfilZerar()
+  uint32_t minNs;           // Estatísticas da janela das últimas amostras
+  uint32_t medianaNs;
+  uint32_t p99Ns;
+  uint32_t maxNs;
+};
+
+struct ResumoHeapTick {
+  unsigned long ticks;
+  uint32_t bytesMedio;      // Bytes alocados por tick
+  uint32_t bytesMax;
+};
+
+uint32_t perfilMarca();
+void perfilRegistrar(EstagioTick estagio, uint32_t marcaInicio);
+
+// Em volta do tick: bytes pedidos ao heap (no ESP32, saldo do heap livre)
+void perfilInicioTick();
+void perfilFimTick();
+
+void perfilResumo(EstagioTick estagio, ResumoEstagio& resumo);
+ResumoHeapTick perfilResumoHeap();
+const char* perfilNomeEstagio(EstagioTick estagio);
+void perfilZerar();
+
+// Uma linha CSV por estágio: estagio;amostras;min_ns;mediana_ns;p99_ns;max_ns
+void perfilEscreverCsv(EscritorTexto& saida, EstagioTick estagio);
+void perfilImprimir();
+
+#if PERFIL_HABILITADO
+#define PERFIL_INICIO(marca) uint32_t marca = perfilMarca()
+#define PERFIL_FIM(estagio, marca) perfilRegistrar(estagio, marca)
+#else
+#define PERFIL_INICIO(marca) do { } while (0)
+#define PERFIL_FIM(estagio, marca) do { } while (0)
+#endif
@@ -0,0 +1,165 @@
+#include "regras_ambiente.h"
+
+#include "config_arquivo.h"
+#include "log.h"
+
+// Na RTC: a tabela ajustada não é relida da flash a cada despertar
+static HAL_RETIDO RegraAmbiente regras[TOTAL_REGRAS];
+
+// Derivados da tabela, recalculados quando ela muda
+static HAL_RETIDO uint8_t scorePorMascara[1 << TOTAL_REGRAS];
+static HAL_RETIDO MascaraViolacoes regrasDaSaida[TOTAL_SAIDAS];
+static HAL_RETIDO MascaraViolacoes regrasDaHora[24];
+
+static bool horaNaFaixa(const RegraAmbiente& r, int hora) {
+  if (r.horaInicio < 0) return true;
+  if (r.horaInicio <= r.horaFim) return hora >= r.horaInicio && hora <= r.horaFim;
+  return hora >= r.horaInicio || hora <= r.horaFim;
+}
+
+static void recalcularDerivados() {
+  for (int s = 0; s < TOTAL_SAIDAS; s++) regrasDaSaida[s] = 0;
+  for (int h = 0; h < 24; h++) regrasDaHora[h] = 0;
+
+  for (int i = 0; i < TOTAL_REGRAS; i++) {
+    regrasDaSaida[regras[i].saida] |= 1u << i;
+    for (int h = 0; h < 24; h++) {
+      if (horaNaFaixa(regras[i], h)) regrasDaHora[h] |= 1u << i;
+    }
+  }
+
+  for (int m = 0; m < (1 << TOTAL_REGRAS); m++) {
+    int score = SCORE_MAXIMO;
+    for (int i = 0; i < TOTAL_REGRAS; i++) {
+      if (m & (1 << i)) score -= regras[i].penalidade;
+    }
+    scorePorMascara[m] = (uint8_t)max(score, 0);
+  }
+}
+
+// ---------- Arquivo de ajustes ----------
+static bool aplicarAjuste(char* chave, char* valor) {
+  char* campo = strchr(chave, '.');
+  if (campo == nullptr) return false;
+  *campo++ = '\0';
+
+  for (int i = 0; i < TOTAL_REGRAS; i++) {
+    RegraAmbiente& r = regras[i];
+    if (strcmp(r.nome, chave) != 0) continue;
+
+    char* fim;
+    if (!strcmp(campo, "limite")) {
+      float limite = strtof(valor, &fim);
+      if (fim == valor) return false;
+      r.limite = limite;
+      return true;
+    }
+    if (!strcmp(campo, "histerese")) {
+      float histerese = strtof(valor, &fim);
+      if (fim == valor || histerese < 0) return false;
+      r.histerese = histerese;
+      return true;
+    }
+    if (!strcmp(campo, "penalidade")) {
+      long pontos = strtol(valor, &fim, 10);
+      if (fim == valor || pontos < 0 || pontos > SCORE_MAXIMO) return false;
+      r.penalidade = (uint8_t)pontos;
+      return true;
+    }
+    if (!strcmp(campo, "horas")) {
+      if (!strcmp(valor, "todas")) {
+        r.horaInicio = -1;
+        r.horaFim = -1;
+        return true;
+      }
+      long inicio = strtol(valor, &fim, 10);
+      if (fim == valor || *fim != '-') return false;
+      char* resto = fim + 1;
+      long horaFim = strtol(resto, &fim, 10);
+      if (fim == resto || inicio < 0 || inicio > 23 || horaFim < 0 || horaFim > 23) return false;
+      r.horaInicio = (int8_t)inicio;
+      r.horaFim = (int8_t)horaFim;
+      return true;
+    }
+    return false;
+  }
+  return false;
+}
+
+// ---------- API ----------
+void regrasIniciar() {
+  for (int i = 0; i < TOTAL_REGRAS; i++) regras[i] = REGRAS_PADRAO[i];
+  int ajustes = configCarregar(REGRAS_ARQUIVO, aplicarAjuste);
+  if (ajustes >= 0) {
+    LOG_INFO("REGRAS", "⚙️ ", ajustes, " ajustes de regras carregados de ", REGRAS_ARQUIVO);
+  }
+  recalcularDerivados();
+}
+
+MascaraViolacoes regrasAvaliar(float temperatura, float umidade, int luminosidade, int hora,
+                               MascaraViolacoes anteriores) {
+  const float valores[TOTAL_GRANDEZAS] = { temperatura, umidade, (float)luminosidade };
+  MascaraViolacoes ativas = regrasDaHora[hora % 24];
+  MascaraViolacoes violacoes = 0;
+
+  // NAN falha nas duas comparações: leitura inválida não viola nada
+  for (int i = 0; i < TOTAL_REGRAS; i++) {
+    if (!(ativas & (1u << i))) continue;
+    const RegraAmbiente& r = regras[i];
+    float v = valores[r.grandeza];
+    // Já violada: o limite recua pela histerese, para não piscar na borda
+    float limite = r.limite;
+    if (anteriores & (1u << i)) limite += r.acimaDoLimite ? -r.histerese : r.histerese;
+    if (r.acimaDoLimite ? v > limite : v < limite) violacoes |= 1u << i;
+  }
+  return violacoes;
+}
+
+void regrasAvaliarLote(const float* temperatura, const float* umidade, const float* luminosidade,
+                       int hora, const MascaraViolacoes* anteriores, MascaraViolacoes* violacoes,
+                       int total) {
+  const float* const valores[TOTAL_GRANDEZAS] = { temperatura, umidade, luminosidade };
+  MascaraViolacoes ativas = regrasDaHora[hora % 24];
+  for (int z = 0; z < total; z++) violacoes[z] = 0;
+
+  for (int i = 0; i < TOTAL_REGRAS; i++) {
+    if (!(ativas & (1u << i))) continue;
+    const RegraAmbiente& r = regras[i];
+    const float* v = valores[r.grandeza];
+    const MascaraViolacoes bit = (MascaraViolacoes)(1u << i);
+    const float limite = r.limite;
+    const float recuado = r.limite + (r.acimaDoLimite ? -r.histerese : r.histerese);
+
+    if (r.acimaDoLimite) {
+      for (int z = 0; z < total; z++) {
+        float l = (anteriores[z] & bit) ? recuado : limite;
+        violacoes[z] |= v[z] > l ? bit : 0;
+      }
+    } else {
+      for (int z = 0; z < total; z++) {
+        float l = (anteriores[z] & bit) ? recuado : limite;
+        violacoes[z] |= v[z] < l ? bit : 0;
+      }
+    }
+  }
+}
+
+int regrasScore(MascaraViolacoes violacoes) {
+  return scorePorMascara[violacoes];
+}
+
+int regrasContarAlertas(MascaraViolacoes violacoes) {
+  int alertas = 0;
+  for (int s = 0; s < TOTAL_SAIDAS; s++) {
+    if (violacoes & regrasDaSaida[s]) alertas++;
+  }
+  return alertas;
+}
+
+bool regrasSaidaAtiva(MascaraViolacoes violacoes, SaidaAlerta saida) {
+  return (violacoes & regrasDaSaida[saida]) != 0;
+}
+
+const RegraAmbiente& regra(int indice) {
+  return regras[indice];
+}
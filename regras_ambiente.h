@@ -0,0 +1,106 @@
+#pragma once
+
+#include "hal.h"
+
+// ==================== REGRAS DO AMBIENTE ====================
+// Uma tabela só define todos os limites (temperatura, umidade e luz por
+// faixa de horário). Cada amostra é avaliada uma vez em uma máscara de
+// violações, e score, contagem de alertas, LEDs e recomendações saem
+// dessa máscara. Os limites podem ser ajustados por instalação no
+// arquivo REGRAS_ARQUIVO da flash, sem recompilar:
+//
+//   # chave = valor
+//   temp_alta.limite = 29.5
+//   escuro_expediente.horas = 9-18
+//   escuro_expediente.histerese = 30
+//   claro_noite.penalidade = 10
+
+#define REGRAS_ARQUIVO "/regras.cfg"
+#define SCORE_MAXIMO 100
+#define SCORE_MINIMO_REGULAR 60    // Abaixo disso o ambiente é CRÍTICO
+#define SCORE_MINIMO_IDEAL 85
+
+enum GrandezaAmbiente : uint8_t {
+  GRANDEZA_TEMPERATURA,
+  GRANDEZA_UMIDADE,
+  GRANDEZA_LUMINOSIDADE,
+  TOTAL_GRANDEZAS
+};
+
+enum SaidaAlerta : uint8_t {
+  SAIDA_LED_TEMPERATURA,   // 🔴
+  SAIDA_LED_UMIDADE,       // 🔵
+  SAIDA_LED_ESCURO,        // 🟡
+  SAIDA_LED_CLARO,         // 🟢
+  TOTAL_SAIDAS
+};
+
+struct RegraAmbiente {
+  const char* nome;          // Prefixo da chave no REGRAS_ARQUIVO
+  GrandezaAmbiente grandeza;
+  bool acimaDoLimite;        // true: viola com valor > limite; false: valor < limite
+  float limite;
+  float histerese;           // Violada, só sai depois de voltar isso além do limite
+  int8_t horaInicio;         // Faixa do dia em que vale (-1 = o dia todo);
+  int8_t horaFim;            // inclusiva, e início > fim passa da meia-noite
+  uint8_t penalidade;        // Pontos tirados do score
+  SaidaAlerta saida;
+  const char* mensagemLed;   // nullptr = LED sem log
+  const char* acaoRegular;   // Score entre SCORE_MINIMO_REGULAR e SCORE_MINIMO_IDEAL
+  const char* acaoCritica;   // Score abaixo de SCORE_MINIMO_REGULAR
+};
+
+constexpr RegraAmbiente REGRAS_PADRAO[] = {
+  { "temp_alta", GRANDEZA_TEMPERATURA, true, 28.0f, 0.0f, -1, -1, 30, SAIDA_LED_TEMPERATURA,
+    "🔴 Temperatura ALTA - Verificar ambiente",
+    "🎯 Ação: Ventilar ambiente ou ajustar Ar Condicionado",
+    "🔥 Ação Imediata: Resfriar ambiente" },
+  { "temp_baixa", GRANDEZA_TEMPERATURA, false, 18.0f, 0.0f, -1, -1, 30, SAIDA_LED_TEMPERATURA,
+    "🔴 Temperatura BAIXA - Verificar ambiente",
+    "🧥 Ação: Fechar janelas ou ajustar o aquecimento",
+    "❄️ Ação Imediata: Aquecer ambiente" },
+  { "umidade_alta", GRANDEZA_UMIDADE, true, 70.0f, 0.0f, -1, -1, 25, SAIDA_LED_UMIDADE,
+    "🔵 Umidade ALTA - Verificar ambiente",
+    "🌬️ Ação: Ventilar para reduzir umidade",
+    "💦 Ação Imediata: Reduzir umidade" },
+  { "umidade_baixa", GRANDEZA_UMIDADE, false, 30.0f, 0.0f, -1, -1, 25, SAIDA_LED_UMIDADE,
+    "🔵 Umidade BAIXA - Verificar ambiente",
+    "💧 Ação: Usar umidificador",
+    "🏜️ Ação Imediata: Aumentar umidade" },
+  { "escuro_expediente", GRANDEZA_LUMINOSIDADE, false, 100.0f, 30.0f, 8, 17, 20, SAIDA_LED_ESCURO,
+    nullptr,
+    "💡 Ação: Deixe o lugar mais iluminado, de preferência para luz natural do dia",
+    "💡 Ação Imediata: ILUMINAÇÃO INADEQUADA - Acender luzes!" },
+  { "claro_noite", GRANDEZA_LUMINOSIDADE, true, 2000.0f, 200.0f, 20, 5, 15, SAIDA_LED_CLARO,
+    nullptr,
+    "🌙 Ação: Reduzir iluminação para descanso",
+    "🌙 Ação Imediata: LUZ EXCESSIVA - Reduzir iluminação!" },
+};
+
+constexpr int TOTAL_REGRAS = sizeof(REGRAS_PADRAO) / sizeof(REGRAS_PADRAO[0]);
+static_assert(TOTAL_REGRAS <= 8, "a máscara de violações tem 8 bits");
+
+typedef uint8_t MascaraViolacoes;
+
+// Máscara das regras que leem uma grandeza (ex.: bits que dependem do DHT)
+constexpr MascaraViolacoes mascaraDaGrandeza(GrandezaAmbiente g, int i = 0) {
+  return i == TOTAL_REGRAS ? 0
+       : (MascaraViolacoes)((REGRAS_PADRAO[i].grandeza == g ? 1u << i : 0u) |
+                            mascaraDaGrandeza(g, i + 1));
+}
+
+void regrasIniciar();   // Tabela padrão + ajustes do REGRAS_ARQUIVO
+// "anteriores" = máscara da amostra anterior, para a histerese das regras
+MascaraViolacoes regrasAvaliar(float temperatura, float umidade, int luminosidade, int hora,
+                               MascaraViolacoes anteriores = 0);
+
+// O mesmo para várias amostras (uma por zona) em vetores paralelos: regra
+// por fora, amostra por dentro, sem desvio no laço interno
+void regrasAvaliarLote(const float* temperatura, const float* umidade, const float* luminosidade,
+                       int hora, const MascaraViolacoes* anteriores, MascaraViolacoes* violacoes,
+                       int total);
+
+int regrasScore(MascaraViolacoes violacoes);
+int regrasContarAlertas(MascaraViolacoes violacoes);   // Uma por saída acionada
+bool regrasSaidaAtiva(MascaraViolacoes violacoes, SaidaAlerta saida);
+const RegraAmbiente& regra(int indice);
@@ -0,0 +1,142 @@
+#include "saude.h"
+
+#include "log.h"
+
+static const uint32_t BALDE0[TOTAL_MEDIDAS_SAUDE] = {
+  SAUDE_TICK_BALDE0_US, SAUDE_LEITURA_BALDE0_US, SAUDE_ENVIO_BALDE0_MS
+};
+static const char* const NOMES[TOTAL_MEDIDAS_SAUDE] = { "tick", "leitura", "envio" };
+static const char* const UNIDADES[TOTAL_MEDIDAS_SAUDE] = { "us", "us", "ms" };
+
+static HAL_RETIDO HistogramaSaude histogramas[TOTAL_MEDIDAS_SAUDE];
+
+// O núcleo 0 abre um intervalo novo; cada escritor zera o próprio máximo
+// na próxima medida, então o máximo nunca tem dois escritores
+static HAL_RETIDO volatile uint32_t intervaloAtual = 0;
+static HAL_RETIDO uint32_t intervaloVisto[TOTAL_MEDIDAS_SAUDE];
+
+// Núcleo 0
+static HAL_RETIDO int rssiAtual = 0;
+static HAL_RETIDO int rssiMinimo = 0;
+
+void saudeIniciar() {
+  if (!halDespertouDoSonoProfundo()) {
+    memset(histogramas, 0, sizeof(histogramas));
+    memset(intervaloVisto, 0, sizeof(intervaloVisto));
+    intervaloAtual = 0;
+    rssiAtual = 0;
+    rssiMinimo = 0;
+    if (halReiniciouPeloWatchdog()) {
+      LOG_ERRO("SAUDE", "🐕 O boot anterior terminou no watchdog (tarefa travada)");
+    }
+  }
+  if (!halWatchdogIniciar(SAUDE_WATCHDOG_MS)) {
+    LOG_AVISO("SAUDE", "⚠️ Watchdog das tarefas indisponível");
+  }
+}
+
+// ==================== REGISTRO ====================
+uint32_t saudeMarca() {
+  return halCiclos();
+}
+
+void saudeRegistrarDesde(MedidaSaude medida, uint32_t marca) {
+  saudeRegistrar(medida, (halCiclos() - marca) / halCiclosPorUs());
+}
+
+void saudeRegistrar(MedidaSaude medida, uint32_t valor) {
+  HistogramaSaude& h = histogramas[medida];
+  uint32_t unidades = valor / BALDE0[medida];
+  int balde = unidades == 0 ? 0 : 32 - __builtin_clz(unidades);
+  if (balde >= SAUDE_BALDES) balde = SAUDE_BALDES - 1;
+  h.baldes[balde]++;
+  h.total++;
+  h.soma += valor;
+  if (valor > h.maximo) h.maximo = valor;
+
+  uint32_t intervalo = intervaloAtual;
+  if (intervaloVisto[medida] != intervalo) {
+    intervaloVisto[medida] = intervalo;
+    h.maximoIntervalo = 0;
+  }
+  if (valor > h.maximoIntervalo) h.maximoIntervalo = valor;
+}
+
+void saudeAmostrarRede() {
+  int rssi = halWiFiRssi();
+  if (rssi == 0) return;
+  rssiAtual = rssi;
+  if (rssiMinimo == 0 || rssi < rssiMinimo) rssiMinimo = rssi;
+}
+
+// ==================== RESUMO DO INTERVALO ====================
+// Medida que ainda não viu o intervalo novo não tem nada nele
+static uint32_t maximoDoIntervalo(MedidaSaude medida) {
+  return intervaloVisto[medida] == intervaloAtual ? histogramas[medida].maximoIntervalo : 0;
+}
+
+ResumoSaude saudeResumo() {
+  ResumoSaude resumo;
+  resumo.tickMaxUs = maximoDoIntervalo(SAUDE_TICK);
+  resumo.envioMaxMs = maximoDoIntervalo(SAUDE_ENVIO);
+  resumo.heapMinimo = halHeapMinimoLivre();
+  resumo.rssi = rssiAtual;
+  return resumo;
+}
+
+void saudeNovoIntervalo() {
+  intervaloAtual = intervaloAtual + 1;
+}
+
+// ==================== ESTATÍSTICAS ====================
+const HistogramaSaude& saudeHistograma(MedidaSaude medida) {
+  return histogramas[medida];
+}
+
+const char* saudeNomeMedida(MedidaSaude medida) {
+  return NOMES[medida];
+}
+
+const char* saudeUnidade(MedidaSaude medida) {
+  return UNIDADES[medida];
+}
+
+uint32_t saudeLimiteBalde(MedidaSaude medida, int balde) {
+  if (balde >= SAUDE_BALDES - 1) return 0;
+  return BALDE0[medida] << balde;
+}
+
+uint32_t saudePercentil(MedidaSaude medida, float fracao) {
+  const HistogramaSaude& h = histogramas[medida];
+  if (h.total == 0) return 0;
+  uint32_t alvo = (uint32_t)ceilf(fracao * h.total);
+  uint32_t acumulado = 0;
+  for (int b = 0; b < SAUDE_BALDES - 1; b++) {
+    acumulado += h.baldes[b];
+    if (acumulado >= alvo) return saudeLimiteBalde(medida, b);
+  }
+  return h.maximo;   // Balde aberto: o máximo é o limite conhecido
+}
+
+void saudeImprimir() {
+  LOG_INFO("SAUDE", "🩺 Saúde: heap livre=", halHeapLivre(), " minimo=", halHeapMinimoLivre(),
+           " maiorBloco=", halHeapMaiorBloco(), " | rssi=", rssiAtual, " dBm (pior ", rssiMinimo, ")");
+
+  for (int m = 0; m < TOTAL_MEDIDAS_SAUDE; m++) {
+    MedidaSaude medida = (MedidaSaude)m;
+    const HistogramaSaude& h = histogramas[m];
+    if (h.total == 0) continue;
+    LOG_INFO("SAUDE", "   ⏱️  ", NOMES[m], ": n=", (unsigned long)h.total,
+             " media=", (unsigned long)(h.soma / h.total), UNIDADES[m],
+             " p50<=", (unsigned long)saudePercentil(medida, 0.5f), UNIDADES[m],
+             " p99<=", (unsigned long)saudePercentil(medida, 0.99f), UNIDADES[m],
+             " max=", (unsigned long)h.maximo, UNIDADES[m]);
+  }
+
+  HalPilhaTarefa pilhas[SAUDE_MAX_PILHAS];
+  int total = halPilhasTarefas(pilhas, SAUDE_MAX_PILHAS);
+  for (int i = 0; i < total; i++) {
+    LOG_INFO("SAUDE", "   🧵 Pilha ", pilhas[i].nome, ": folga minima=", (unsigned long)pilhas[i].folgaMinima,
+             "/", (unsigned long)pilhas[i].tamanho, " bytes");
+  }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "hal.h"
+
+// ==================== SAÚDE DO SISTEMA ====================
+// Sempre ligada, também em produção: histogramas de baldes fixos da
+// duração do tick de sensoriamento, da leitura dos sensores e da rodada de
+// envio, mais heap (livre, mínimo, maior bloco), folga das pilhas e RSSI.
+// Registrar uma medida é uma divisão, uma busca de bit e três somas; heap,
+// pilhas e RSSI são lidos só no envio e no relatório. Também arma o
+// watchdog das tarefas: um loop() ou um envio travado reinicia o kit e o
+// próximo boot avisa, em vez de o kit ficar mudo.
+//
+// O resumo do intervalo (os piores valores desde o último lote aceito)
+// vai nos campos 5-8 do ThingSpeak, junto das médias da zona 0.
+
+// Baldes: o i vai até BALDE0 << i; o último é aberto
+#define SAUDE_BALDES 12
+#define SAUDE_TICK_BALDE0_US 32        // Tick: até ~65 ms
+#define SAUDE_LEITURA_BALDE0_US 8      // Leitura: até ~16 ms
+#define SAUDE_ENVIO_BALDE0_MS 50       // Rodada de envio: até ~100 s
+#ifndef SAUDE_WATCHDOG_MS
+#define SAUDE_WATCHDOG_MS 30000        // Acima do período adaptativo máximo e dos timeouts do HTTP
+#endif
+#define SAUDE_MAX_PILHAS 4             // loop() + tarefas de halCriarTarefa()
+
+enum MedidaSaude : uint8_t {
+  SAUDE_TICK,       // executarSistemaWellWork() inteiro (us, núcleo 1)
+  SAUDE_LEITURA,    // Filtro dos LDRs + caches do DHT (us, núcleo 1)
+  SAUDE_ENVIO,      // Rodada de lotes da tarefa de rede (ms, núcleo 0)
+  TOTAL_MEDIDAS_SAUDE
+};
+
+// Cada histograma tem um único escritor (o núcleo da medida)
+struct HistogramaSaude {
+  uint32_t baldes[SAUDE_BALDES];
+  uint32_t total;
+  uint32_t maximo;
+  uint32_t maximoIntervalo;   // Desde saudeNovoIntervalo()
+  uint64_t soma;
+};
+
+// Campos 5-8 do ThingSpeak
+struct ResumoSaude {
+  uint32_t tickMaxUs;         // Pior tick do intervalo
+  uint32_t envioMaxMs;        // Pior rodada de envio do intervalo
+  uint32_t heapMinimo;        // Marca d'água do heap livre desde o boot
+  int rssi;                   // dBm da última amostra (0 = sem WiFi ainda)
+};
+
+// No setup(): arma o watchdog e avisa se o boot anterior terminou nele.
+// Os histogramas só zeram no boot frio
+void saudeIniciar();
+
+// Medidas em ciclos de CPU (saudeMarca() no início), como o perfil dos
+// estágios; o envio vem direto em ms
+uint32_t saudeMarca();
+void saudeRegistrarDesde(MedidaSaude medida, uint32_t marca);
+void saudeRegistrar(MedidaSaude medida, uint32_t valor);
+
+// Núcleo 0, com o WiFi conectado
+void saudeAmostrarRede();
+
+ResumoSaude saudeResumo();
+void saudeNovoIntervalo();   // Núcleo 0, depois do lote aceito
+
+const HistogramaSaude& saudeHistograma(MedidaSaude medida);
+const char* saudeNomeMedida(MedidaSaude medida);
+const char* saudeUnidade(MedidaSaude medida);
+uint32_t saudeLimiteBalde(MedidaSaude medida, int balde);          // 0 = aberto (o último)
+uint32_t saudePercentil(MedidaSaude medida, float fracao);        // Limite do balde que contém o percentil
+void saudeImprimir();
@@ -0,0 +1,140 @@
+#include "sensor_dht.h"
+
+#include "log.h"
+#include "trilha_sensores.h"
+
+// Na RTC: os caches e os contadores continuam valendo depois do sono profundo
+static HAL_RETIDO LeituraDht leituras[DHT_MAX_SENSORES];
+static HAL_RETIDO EstatisticasDht estatisticas;
+static HAL_RETIDO unsigned long inicioUltimaMs = 0;   // Início do último ciclo
+static HAL_RETIDO bool jaLeu = false;
+static int pinos[DHT_MAX_SENSORES];
+static int totalSensores = 0;
+static int sensorAtual = 0;   // Sensor da transação em curso no ciclo
+static bool emCurso = false;
+
+static const LeituraDht leituraVazia = { NAN, NAN, 0, false };
+
+// Umidade e temperatura em décimos, big-endian; bit 15 da temperatura = sinal
+static void decodificar(LeituraDht& leitura, const uint8_t quadro[5], unsigned long agora) {
+  uint16_t umidade = (uint16_t)(quadro[0] << 8 | quadro[1]);
+  uint16_t temperatura = (uint16_t)((quadro[2] & 0x7F) << 8 | quadro[3]);
+  leitura.umidade = umidade * 0.1f;
+  leitura.temperatura = (quadro[2] & 0x80 ? -0.1f : 0.1f) * temperatura;
+  leitura.instanteMs = agora;
+  leitura.valida = true;
+}
+
+static unsigned long iniciarTransacao() {
+  if (!halDhtIniciarLeitura(pinos[sensorAtual])) {
+    sensorAtual = 0;
+    return 0;
+  }
+  emCurso = true;
+  estatisticas.transacoes++;
+  return DHT_DURACAO_TRANSACAO_MS;
+}
+
+// Fim de uma transação: o próximo sensor do ciclo começa na hora
+static unsigned long avancar() {
+  emCurso = false;
+  if (++sensorAtual < totalSensores) return iniciarTransacao();
+  sensorAtual = 0;
+  return 0;
+}
+
+void dhtIniciar(const int* pinosSensores, int total) {
+  totalSensores = min(total, DHT_MAX_SENSORES);
+  for (int i = 0; i < totalSensores; i++) {
+    pinos[i] = pinosSensores[i];
+    halDhtIniciar(pinos[i]);
+  }
+  sensorAtual = 0;
+  emCurso = false;
+  if (!halDespertouDoSonoProfundo()) {
+    for (LeituraDht& l : leituras) l = leituraVazia;
+    estatisticas = {};
+    jaLeu = false;
+  }
+}
+
+int dhtTotalSensores() {
+  return totalSensores;
+}
+
+unsigned long dhtDuracaoCicloMs() {
+  return (unsigned long)totalSensores * DHT_DURACAO_TRANSACAO_MS;
+}
+
+unsigned long dhtProcessar() {
+  if (totalSensores == 0) return 0;
+  unsigned long agora = halMillis();
+
+  if (!emCurso) {
+    if (jaLeu && agora - inicioUltimaMs < DHT_INTERVALO_MINIMO_MS) {
+      estatisticas.adiadas++;
+      return 0;
+    }
+    jaLeu = true;
+    inicioUltimaMs = agora;
+    sensorAtual = 0;
+    return iniciarTransacao();
+  }
+
+  uint8_t quadro[5];
+  switch (trilhaDht(sensorAtual, halDhtColetar(quadro), quadro)) {
+    case DHT_QUADRO_PENDENTE:
+      return 1;
+
+    case DHT_QUADRO_SEM_RESPOSTA:
+      estatisticas.semResposta++;
+      LOG_DEBUG("DHT", "❌ DHT22 ", sensorAtual, " sem resposta");
+      return avancar();
+
+    case DHT_QUADRO_PRONTO:
+      break;
+  }
+
+  uint8_t soma = (uint8_t)(quadro[0] + quadro[1] + quadro[2] + quadro[3]);
+  if (soma != quadro[4]) {
+    estatisticas.falhasChecksum++;
+    LOG_DEBUG("DHT", "❌ DHT22 ", sensorAtual, " checksum inválido");
+    return avancar();
+  }
+  estatisticas.sucessos++;
+  decodificar(leituras[sensorAtual], quadro, agora);
+  return avancar();
+}
+
+bool dhtLer(int sensor, float& temperatura, float& umidade, unsigned long idadeMaximaMs) {
+  estatisticas.consultas++;
+  const LeituraDht& leitura = dhtUltimaLeitura(sensor);
+  unsigned long idade = halMillis() - leitura.instanteMs;
+  if (!leitura.valida || idade > idadeMaximaMs) {
+    estatisticas.consultasVencidas++;
+    temperatura = NAN;
+    umidade = NAN;
+    return false;
+  }
+
+  if (idade > estatisticas.idadeMaximaMs) estatisticas.idadeMaximaMs = idade;
+  temperatura = leitura.temperatura;
+  umidade = leitura.umidade;
+  return true;
+}
+
+const LeituraDht& dhtUltimaLeitura(int sensor) {
+  return sensor >= 0 && sensor < totalSensores ? leituras[sensor] : leituraVazia;
+}
+
+const EstatisticasDht& dhtEstatisticas() {
+  return estatisticas;
+}
+
+void dhtImprimirEstatisticas() {
+  LOG_INFO("DHT", "🌡️ DHT22 (", totalSensores, " sensores): transacoes=", estatisticas.transacoes,
+           " ok=", estatisticas.sucessos, " checksum=", estatisticas.falhasChecksum,
+           " semResposta=", estatisticas.semResposta, " adiadas=", estatisticas.adiadas,
+           " consultas=", estatisticas.consultas, " vencidas=", estatisticas.consultasVencidas,
+           " idadeMax=", estatisticas.idadeMaximaMs, "ms");
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "hal.h"
+
+// ==================== SENSOR DHT22 ====================
+// No máximo uma transação por período, sem bloquear: a primeira chamada de
+// dhtProcessar() dá o start e a seguinte, DHT_DURACAO_TRANSACAO_MS depois,
+// confere o checksum do quadro e atualiza a leitura em cache. Quem consome
+// lê o cache (dhtLer), com carimbo de tempo e limite de idade, então todos
+// veem a mesma amostra sem falar com o sensor.
+//
+// Com vários sensores (um por zona) o ciclo lê um depois do outro, cada um
+// com seu cache; o ciclo inteiro dura dhtDuracaoCicloMs().
+
+#define DHT_INTERVALO_MINIMO_MS 2000    // O DHT22 não aceita leituras mais próximas
+#define DHT_DURACAO_TRANSACAO_MS 6      // Start (1,1 ms) + resposta + 40 bits, com folga
+#define DHT_MAX_SENSORES 4
+
+struct LeituraDht {
+  float temperatura;
+  float umidade;
+  unsigned long instanteMs;   // Fim da transação que produziu a leitura
+  bool valida;                // false até a primeira leitura com checksum bom
+};
+
+// Somadas de todos os sensores
+struct EstatisticasDht {
+  unsigned long transacoes;
+  unsigned long sucessos;
+  unsigned long falhasChecksum;
+  unsigned long semResposta;
+  unsigned long adiadas;            // Pedidas antes do intervalo mínimo
+  unsigned long consultas;
+  unsigned long consultasVencidas;  // Cache mais velho que o limite do consumidor
+  unsigned long idadeMaximaMs;      // Maior idade entregue a um consumidor
+};
+
+void dhtIniciar(const int* pinos, int totalSensores);
+int dhtTotalSensores();
+unsigned long dhtDuracaoCicloMs();
+
+// Avança o ciclo; retorna em quantos ms chamar de novo (0 = terminou)
+unsigned long dhtProcessar();
+
+// Última leitura válida do sensor, se tiver no máximo idadeMaximaMs;
+// senão NAN e false
+bool dhtLer(int sensor, float& temperatura, float& umidade, unsigned long idadeMaximaMs);
+
+const LeituraDht& dhtUltimaLeitura(int sensor);
+const EstatisticasDht& dhtEstatisticas();
+void dhtImprimirEstatisticas();
@@ -0,0 +1,155 @@
+#include "sensor_luz.h"
+
+#include "log.h"
+#include "trilha_sensores.h"
+
+// Na RTC: os IIRs e os contadores continuam depois do sono profundo
+static HAL_RETIDO int32_t acumulador[LUZ_MAX_CANAIS];     // Valor filtrado << LUZ_IIR_SHIFT
+static HAL_RETIDO bool filtroIniciado[LUZ_MAX_CANAIS];
+static HAL_RETIDO EstatisticasLuz estatisticas;
+static HAL_RETIDO float somaDesvioBruto = 0;
+static HAL_RETIDO float somaDesvioMedianas = 0;
+static HAL_RETIDO unsigned long amostrasComDados = 0;
+static int totalCanais = 0;
+
+static uint16_t conversoes[HAL_ADC_CONTINUO_MAX_CONVERSOES];
+static uint8_t canalDaConversao[HAL_ADC_CONTINUO_MAX_CONVERSOES];
+static uint16_t doCanal[HAL_ADC_CONTINUO_MAX_CONVERSOES];
+
+// Welford de uma passada só; desvio amostral (n - 1)
+struct Dispersao {
+  uint32_t n = 0;
+  float media = 0;
+  float m2 = 0;
+
+  void adicionar(float x) {
+    n++;
+    float delta = x - media;
+    media += delta / n;
+    m2 += delta * (x - media);
+  }
+  float desvio() const { return n > 1 ? sqrtf(m2 / (n - 1)) : 0.0f; }
+};
+
+// Blocos pequenos: inserção direta é mais barata que qualquer seleção
+static uint16_t mediana(uint16_t* bloco, size_t n) {
+  for (size_t i = 1; i < n; i++) {
+    uint16_t v = bloco[i];
+    size_t j = i;
+    while (j > 0 && bloco[j - 1] > v) {
+      bloco[j] = bloco[j - 1];
+      j--;
+    }
+    bloco[j] = v;
+  }
+  return bloco[n / 2];
+}
+
+static void filtrar(int canal, uint16_t valor) {
+  if (!filtroIniciado[canal]) {
+    acumulador[canal] = (int32_t)valor << LUZ_IIR_SHIFT;
+    filtroIniciado[canal] = true;
+    return;
+  }
+  acumulador[canal] += (int32_t)valor - (acumulador[canal] >> LUZ_IIR_SHIFT);
+}
+
+// Mediana por blocos + IIR das n conversões de um canal
+static void filtrarCanal(int canal, uint16_t* valores, size_t n) {
+  estatisticas.conversoes += n;
+
+  Dispersao bruto;
+  for (size_t i = 0; i < n; i++) bruto.adicionar(valores[i]);
+
+  // Resto menor que um bloco vira um bloco menor
+  Dispersao medianas;
+  for (size_t inicio = 0; inicio < n; inicio += LUZ_BLOCO_MEDIANA) {
+    size_t tamanho = min((size_t)LUZ_BLOCO_MEDIANA, n - inicio);
+    uint16_t* bloco = &valores[inicio];
+    uint16_t m = mediana(bloco, tamanho);
+    for (size_t i = 0; i < tamanho; i++) {
+      if (abs((int)bloco[i] - (int)m) > LUZ_LIMIAR_PICO) estatisticas.picos++;
+    }
+    medianas.adicionar(m);
+    filtrar(canal, m);
+  }
+
+  amostrasComDados++;
+  somaDesvioBruto += bruto.desvio();
+  somaDesvioMedianas += medianas.desvio();
+  estatisticas.desvioBruto = somaDesvioBruto / amostrasComDados;
+  estatisticas.desvioMedianas = somaDesvioMedianas / amostrasComDados;
+  estatisticas.desvioBrutoMax = max(estatisticas.desvioBrutoMax, bruto.desvio());
+}
+
+bool luzIniciar(const int* pinos, int total) {
+  totalCanais = min(total, LUZ_MAX_CANAIS);
+  if (!halDespertouDoSonoProfundo()) {
+    for (int c = 0; c < LUZ_MAX_CANAIS; c++) {
+      acumulador[c] = 0;
+      filtroIniciado[c] = false;
+    }
+    estatisticas = {};
+    somaDesvioBruto = 0;
+    somaDesvioMedianas = 0;
+    amostrasComDados = 0;
+  }
+  if (totalCanais == 0) return true;
+  bool ok = halAdcContinuoIniciar(pinos, totalCanais, LUZ_CONVERSOES_POR_SEGUNDO);
+  if (!ok) LOG_ERRO("LUZ", "❌ ADC contínuo indisponível nos pinos dos ", totalCanais, " LDRs");
+  return ok;
+}
+
+int luzTotalCanais() {
+  return totalCanais;
+}
+
+void luzAmostrar() {
+  if (totalCanais == 0) return;
+  estatisticas.amostras += totalCanais;
+
+  // Reproduzindo uma trilha o valor filtrado vem dela; o ADC nem é lido
+  if (trilhaModo() == TRILHA_REPRODUZINDO) {
+    for (int c = 0; c < totalCanais; c++) {
+      acumulador[c] = (int32_t)trilhaLuz(c, 0) << LUZ_IIR_SHIFT;
+      filtroIniciado[c] = true;
+    }
+    return;
+  }
+
+  size_t n = halAdcContinuoLer(conversoes, canalDaConversao, HAL_ADC_CONTINUO_MAX_CONVERSOES);
+
+  // Um canal de cada vez: separa as conversões dele, na ordem
+  for (int c = 0; c < totalCanais; c++) {
+    size_t quantidade = 0;
+    for (size_t i = 0; i < n; i++) {
+      if (canalDaConversao[i] == c) doCanal[quantidade++] = conversoes[i];
+    }
+    if (quantidade == 0) {
+      estatisticas.semConversoes++;
+      continue;
+    }
+    filtrarCanal(c, doCanal, quantidade);
+  }
+  if (trilhaModo() == TRILHA_GRAVANDO) {
+    for (int c = 0; c < totalCanais; c++) trilhaLuz(c, luzValor(c));
+  }
+}
+
+int luzValor(int canal) {
+  if (canal < 0 || canal >= totalCanais) return 0;
+  return (int)(acumulador[canal] >> LUZ_IIR_SHIFT);
+}
+
+const EstatisticasLuz& luzEstatisticas() {
+  return estatisticas;
+}
+
+void luzImprimirEstatisticas() {
+  LOG_INFO("LUZ", "💡 LDR (", totalCanais, " canais): valor=", luzValor(0), " amostras=", estatisticas.amostras,
+           " semConversoes=", estatisticas.semConversoes,
+           " conversoes=", (unsigned long)estatisticas.conversoes, " picos=", estatisticas.picos,
+           " desvio bruto=", Decimal(estatisticas.desvioBruto, 1),
+           " (max ", Decimal(estatisticas.desvioBrutoMax, 1), ")",
+           " medianas=", Decimal(estatisticas.desvioMedianas, 1));
+}
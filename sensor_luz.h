@@ -0,0 +1,42 @@
+#pragma once
+
+#include "hal.h"
+
+// ==================== SENSOR DE LUZ (LDR) ====================
+// O ADC converte o LDR em segundo plano e cada leitura dos sensores chama
+// luzAmostrar() uma vez: as conversões acumuladas são separadas em blocos
+// de LUZ_BLOCO_MEDIANA, a mediana de cada bloco derruba os picos (WiFi
+// transmitindo) e um IIR de 1/2^LUZ_IIR_SHIFT suaviza a sequência das
+// medianas. Sem conversões novas, repete o último valor filtrado. Com um
+// LDR por zona, os canais dividem a taxa do ADC e cada um tem seu filtro.
+//
+// Nos modos de sono o DMA para junto com a CPU; os 10 ms acordados da
+// transação do DHT antes de cada leitura renovam quase todo o anel.
+//
+// Reproduzindo uma trilha (trilha_sensores.h), o valor filtrado vem dela
+// e o ADC não é lido.
+
+#define LUZ_CONVERSOES_POR_SEGUNDO 20000   // Mínimo do modo contínuo do ESP32
+#define LUZ_BLOCO_MEDIANA 9
+#define LUZ_IIR_SHIFT 3                    // alfa = 1/8
+#define LUZ_LIMIAR_PICO 200                // Distância da mediana do bloco que conta como pico
+#define LUZ_MAX_CANAIS 4
+
+// Somadas de todos os canais
+struct EstatisticasLuz {
+  unsigned long amostras;          // Chamadas de luzAmostrar() x canais
+  unsigned long semConversoes;     // ...sem nada novo do ADC (valor repetido)
+  unsigned long long conversoes;
+  unsigned long picos;
+  float desvioBruto;               // Desvio das conversões em uma amostra (média)
+  float desvioBrutoMax;
+  float desvioMedianas;            // Desvio das medianas dos blocos (média)
+};
+
+bool luzIniciar(const int* pinos, int totalCanais);
+int luzTotalCanais();
+void luzAmostrar();          // Uma vez por leitura: filtra as conversões de todos os canais
+int luzValor(int canal);     // Último valor filtrado (0-4095)
+
+const EstatisticasLuz& luzEstatisticas();
+void luzImprimirEstatisticas();
@@ -0,0 +1,571 @@
+#include "servidor_metricas.h"
+
+#include "amostragem_adaptativa.h"
+#include "conexao_wifi.h"
+#include "fila_telemetria.h"
+#include "log.h"
+#include "perfil_estagios.h"
+
+struct ConexaoMetricas {
+  HalClienteTcp cliente;
+  bool aberta;
+  char requisicao[METRICAS_TAMANHO_REQUISICAO];
+  size_t tamanho;
+  unsigned long ultimaAtividadeMs;
+};
+
+// Três cópias: a do núcleo 1 (montada sem lock), a compartilhada (só
+// memcpy sob o lock) e a que as respostas do núcleo 0 mostram
+static InstantaneoMetricas capturado;
+static InstantaneoMetricas compartilhado;
+static InstantaneoMetricas foto;
+static HalMutex travaFoto;
+
+static HalServidorTcp servidor;
+static ConexaoMetricas conexoes[METRICAS_MAX_CONEXOES];
+static const EstatisticasHttp* estatisticasHttp = nullptr;
+static EstatisticasServidorMetricas stats;
+static uint16_t portaPedida = 0;
+static bool portaSelecionada = false;
+
+// Corpo da resposta: estático, uma resposta por vez
+static BufferTexto<METRICAS_TAMANHO_RESPOSTA> corpo;
+
+void metricasSelecionarPorta(uint16_t porta) {
+  portaPedida = porta;
+  portaSelecionada = true;
+}
+
+bool servidorMetricasIniciar(uint16_t porta, const EstatisticasHttp* http) {
+  servidorMetricasParar();
+  if (portaSelecionada) porta = portaPedida;
+  estatisticasHttp = http;
+  if (!servidor.iniciar(porta)) {
+    LOG_ERRO("METRICAS", "❌ Endpoint de métricas: porta ", (unsigned long)porta, " indisponível");
+    return false;
+  }
+  LOG_INFO("METRICAS", "📈 Endpoint de métricas na porta ", (unsigned long)servidor.porta(),
+           " (/metrics, /metrics.json)");
+  return true;
+}
+
+uint16_t servidorMetricasPorta() {
+  return servidor.porta();
+}
+
+static void fecharConexao(ConexaoMetricas& c) {
+  c.cliente.fechar();
+  c.aberta = false;
+  c.tamanho = 0;
+}
+
+void servidorMetricasParar() {
+  for (ConexaoMetricas& c : conexoes) {
+    if (c.aberta) fecharConexao(c);
+  }
+  servidor.parar();
+}
+
+// ==================== FOTO (NÚCLEO 1) ====================
+void metricasCapturar() {
+  PERFIL_INICIO(inicio);
+  InstantaneoMetricas& f = capturado;
+  const ArmazemZonas& zonas = zonasArmazem();
+
+  // Regras que passaram a violar desde a foto anterior
+  MascaraViolacoes novas = zonas.violacoes[0] & ~f.violacoes;
+  for (int r = 0; r < TOTAL_REGRAS; r++) {
+    if (novas & (1u << r)) f.ativacoesRegra[r]++;
+  }
+
+  f.instanteMs = halMillis();
+  f.leituras++;
+  f.temperatura = zonas.temperatura[0];
+  f.umidade = zonas.umidade[0];
+  f.luminosidade = zonas.luminosidade[0];
+  f.score = zonas.score[0];
+  f.alertas = zonas.alertas[0];
+  f.violacoes = zonas.violacoes[0];
+
+  f.statusPausa = agendaStatusPausa();
+  f.pausasHoje = agendaPausasHoje();
+  f.diaAgenda = agendaDiaAtual();
+
+  for (int m = 0; m < TOTAL_METRICAS; m++) {
+    for (int j = 0; j < TOTAL_JANELAS; j++) {
+      f.janelas[m][j] = estatisticasResumo((MetricaAmbiente)m, (JanelaEstatistica)j);
+    }
+    f.tendencia[m] = estatisticasTendencia((MetricaAmbiente)m);
+  }
+
+  const EstatisticasAdaptativo& adaptativo = adaptativoEstatisticas();
+  f.periodoAmostragemMs = adaptativo.periodoAtualMs;
+  f.amostrasEconomizadas = adaptativo.amostrasEconomizadas;
+  f.enviosEconomizados = adaptativo.enviosEconomizados;
+
+  f.dht = dhtEstatisticas();
+  f.luz = luzEstatisticas();
+
+  f.totalTarefas = min(agendadorTotalTarefas(), MAX_TAREFAS);
+  for (int i = 0; i < f.totalTarefas; i++) {
+    const Tarefa* t = agendadorTarefa(i);
+    f.tarefas[i] = { t->nome, t->execucoes, t->overruns, t->periodosPerdidos, t->duracaoMaxUs };
+  }
+
+  f.heapLivre = halHeapLivre();
+  f.heapMinimoLivre = halHeapMinimoLivre();
+
+  int n = zonas.total;
+  f.totalZonas = n;
+  memcpy(f.temperaturaZona, zonas.temperatura, n * sizeof(float));
+  memcpy(f.umidadeZona, zonas.umidade, n * sizeof(float));
+  memcpy(f.luminosidadeZona, zonas.luminosidade, n * sizeof(float));
+  memcpy(f.scoreZona, zonas.score, n);
+  memcpy(f.alertasZona, zonas.alertas, n);
+  memcpy(f.statusPausaZona, zonas.statusPausa, n * sizeof(TipoEventoAgenda));
+
+  halTravar(travaFoto);
+  memcpy(&compartilhado, &capturado, sizeof(InstantaneoMetricas));
+  halDestravar(travaFoto);
+  PERFIL_FIM(ESTAGIO_METRICAS, inicio);
+}
+
+static void copiarFoto() {
+  halTravar(travaFoto);
+  memcpy(&foto, &compartilhado, sizeof(InstantaneoMetricas));
+  halDestravar(travaFoto);
+}
+
+// ==================== FORMATO PROMETHEUS ====================
+// NAN (sensor sem leitura) vira NaN, como o formato de exposição pede
+static void valorTexto(EscritorTexto& s, float valor, int casas) {
+  if (isnan(valor)) s << "NaN";
+  else s << Decimal(valor, casas);
+}
+
+static void tipoTexto(EscritorTexto& s, const char* nome, const char* tipo) {
+  s << "# TYPE wellwork_" << nome << ' ' << tipo << '\n';
+}
+
+static void serieTexto(EscritorTexto& s, const char* nome, unsigned long valor) {
+  s << "wellwork_" << nome << ' ' << valor << '\n';
+}
+
+static void contadorTexto(EscritorTexto& s, const char* nome, unsigned long valor) {
+  tipoTexto(s, nome, "counter");
+  serieTexto(s, nome, valor);
+}
+
+static void medidorTexto(EscritorTexto& s, const char* nome, unsigned long valor) {
+  tipoTexto(s, nome, "gauge");
+  serieTexto(s, nome, valor);
+}
+
+// wellwork_<nome>{<rotulo>="<valor>"} - o valor da série vem em seguida
+static EscritorTexto& rotuloTexto(EscritorTexto& s, const char* nome, const char* rotulo,
+                                  const char* valorRotulo) {
+  return s << "wellwork_" << nome << '{' << rotulo << "=\"" << valorRotulo << "\"} ";
+}
+
+static EscritorTexto& rotulosJanelaTexto(EscritorTexto& s, const char* nome, int metrica, int janela) {
+  return s << "wellwork_" << nome << "{metrica=\"" << estatisticasNomeMetrica((MetricaAmbiente)metrica)
+           << "\",janela=\"" << estatisticasNomeJanela((JanelaEstatistica)janela) << "\"} ";
+}
+
+// Índice e nome: o nome da zona não precisa ser único
+static EscritorTexto& rotulosZonaTexto(EscritorTexto& s, const char* nome, int zona) {
+  return s << "wellwork_" << nome << "{zona=\"" << zona << "\",nome=\"" << zonasConfig(zona).nome << "\"} ";
+}
+
+static void escreverZonasTexto(EscritorTexto& s, const InstantaneoMetricas& f) {
+  struct {
+    const char* nome;
+    const float* valores;
+    int casas;
+  } const leituras[] = {
+    { "temperatura_celsius", f.temperaturaZona, 1 },
+    { "umidade_percentual", f.umidadeZona, 1 },
+    { "luminosidade_adc", f.luminosidadeZona, 0 },
+  };
+  for (const auto& l : leituras) {
+    tipoTexto(s, l.nome, "gauge");
+    for (int z = 0; z < f.totalZonas; z++) {
+      valorTexto(rotulosZonaTexto(s, l.nome, z), l.valores[z], l.casas);
+      s << '\n';
+    }
+  }
+
+  tipoTexto(s, "score", "gauge");
+  for (int z = 0; z < f.totalZonas; z++) {
+    rotulosZonaTexto(s, "score", z) << (int)f.scoreZona[z] << '\n';
+  }
+  tipoTexto(s, "alertas_ativos", "gauge");
+  for (int z = 0; z < f.totalZonas; z++) {
+    rotulosZonaTexto(s, "alertas_ativos", z) << (int)f.alertasZona[z] << '\n';
+  }
+  tipoTexto(s, "pausa_status", "gauge");
+  for (int z = 0; z < f.totalZonas; z++) {
+    rotulosZonaTexto(s, "pausa_status", z) << (int)f.statusPausaZona[z] << '\n';
+  }
+}
+
+static void escreverJanelasTexto(EscritorTexto& s, const InstantaneoMetricas& f) {
+  struct {
+    const char* nome;
+    float ResumoJanela::*campo;
+  } const campos[] = {
+    { "janela_media", &ResumoJanela::media },
+    { "janela_desvio", &ResumoJanela::desvio },
+    { "janela_minimo", &ResumoJanela::minimo },
+    { "janela_maximo", &ResumoJanela::maximo },
+  };
+
+  tipoTexto(s, "janela_amostras", "gauge");
+  for (int m = 0; m < TOTAL_METRICAS; m++) {
+    for (int j = 0; j < TOTAL_JANELAS; j++) {
+      rotulosJanelaTexto(s, "janela_amostras", m, j) << (unsigned long)f.janelas[m][j].amostras << '\n';
+    }
+  }
+  for (const auto& c : campos) {
+    tipoTexto(s, c.nome, "gauge");
+    for (int m = 0; m < TOTAL_METRICAS; m++) {
+      for (int j = 0; j < TOTAL_JANELAS; j++) {
+        const ResumoJanela& r = f.janelas[m][j];
+        valorTexto(rotulosJanelaTexto(s, c.nome, m, j), r.amostras > 0 ? r.*c.campo : NAN, 2);
+        s << '\n';
+      }
+    }
+  }
+  tipoTexto(s, "tendencia", "gauge");
+  for (int m = 0; m < TOTAL_METRICAS; m++) {
+    valorTexto(rotuloTexto(s, "tendencia", "metrica", estatisticasNomeMetrica((MetricaAmbiente)m)),
+               f.tendencia[m], 2);
+    s << '\n';
+  }
+}
+
+static void escreverTarefasTexto(EscritorTexto& s, const InstantaneoMetricas& f) {
+  struct {
+    const char* nome;
+    const char* tipo;
+    unsigned long ContadoresTarefa::*campo;
+  } const campos[] = {
+    { "tarefa_execucoes_total", "counter", &ContadoresTarefa::execucoes },
+    { "tarefa_overruns_total", "counter", &ContadoresTarefa::overruns },
+    { "tarefa_periodos_perdidos_total", "counter", &ContadoresTarefa::periodosPerdidos },
+    { "tarefa_duracao_max_us", "gauge", &ContadoresTarefa::duracaoMaxUs },
+  };
+  for (const auto& c : campos) {
+    tipoTexto(s, c.nome, c.tipo);
+    for (int i = 0; i < f.totalTarefas; i++) {
+      rotuloTexto(s, c.nome, "tarefa", f.tarefas[i].nome) << f.tarefas[i].*c.campo << '\n';
+    }
+  }
+}
+
+void metricasEscreverTexto(EscritorTexto& s) {
+  const InstantaneoMetricas& f = foto;
+
+  medidorTexto(s, "foto_idade_ms", halMillis() - f.instanteMs);
+  contadorTexto(s, "leituras_total", f.leituras);
+  escreverZonasTexto(s, f);
+
+  tipoTexto(s, "regra_violada", "gauge");
+  for (int r = 0; r < TOTAL_REGRAS; r++) {
+    rotuloTexto(s, "regra_violada", "regra", regra(r).nome) << ((f.violacoes >> r) & 1) << '\n';
+  }
+  tipoTexto(s, "regra_ativacoes_total", "counter");
+  for (int r = 0; r < TOTAL_REGRAS; r++) {
+    rotuloTexto(s, "regra_ativacoes_total", "regra", regra(r).nome) << f.ativacoesRegra[r] << '\n';
+  }
+
+  medidorTexto(s, "pausas_hoje", (unsigned long)f.pausasHoje);
+  medidorTexto(s, "agenda_dia", f.diaAgenda);
+  escreverJanelasTexto(s, f);
+
+  medidorTexto(s, "amostragem_periodo_ms", f.periodoAmostragemMs);
+  contadorTexto(s, "amostras_economizadas_total", f.amostrasEconomizadas);
+  contadorTexto(s, "envios_economizados_total", f.enviosEconomizados);
+
+  contadorTexto(s, "dht_transacoes_total", f.dht.transacoes);
+  contadorTexto(s, "dht_falhas_checksum_total", f.dht.falhasChecksum);
+  contadorTexto(s, "dht_sem_resposta_total", f.dht.semResposta);
+  contadorTexto(s, "dht_consultas_vencidas_total", f.dht.consultasVencidas);
+  contadorTexto(s, "ldr_conversoes_total", (unsigned long)f.luz.conversoes);
+  contadorTexto(s, "ldr_picos_total", f.luz.picos);
+  escreverTarefasTexto(s, f);
+  medidorTexto(s, "heap_livre_bytes", f.heapLivre);
+  medidorTexto(s, "heap_minimo_livre_bytes", f.heapMinimoLivre);
+
+  // Contadores do próprio núcleo 0: lidos na hora
+  const EstatisticasFila& fila = filaEstatisticas();
+  medidorTexto(s, "fila_tamanho", (unsigned long)filaTamanho());
+  contadorTexto(s, "fila_enfileiradas_total", fila.enfileiradas);
+  contadorTexto(s, "fila_enviadas_total", fila.enviadas);
+  contadorTexto(s, "fila_descartadas_total", fila.descartadasOverflow);
+
+  const EstatisticasWiFi& wifi = wifiEstatisticas();
+  medidorTexto(s, "wifi_conectado", wifiEstaConectado() ? 1 : 0);
+  tipoTexto(s, "wifi_rssi_dbm", "gauge");
+  s << "wellwork_wifi_rssi_dbm " << halWiFiRssi() << '\n';
+  contadorTexto(s, "wifi_quedas_total", wifi.quedas);
+  contadorTexto(s, "wifi_offline_ms_total", wifiTempoOfflineMs());
+
+  if (estatisticasHttp != nullptr) {
+    contadorTexto(s, "http_requisicoes_total", estatisticasHttp->requisicoes);
+    contadorTexto(s, "http_reaproveitadas_total", estatisticasHttp->reaproveitadas);
+    contadorTexto(s, "http_falhas_total", estatisticasHttp->falhas);
+  }
+  contadorTexto(s, "log_descartadas_total", logEstatisticas().descartadasBufferCheio);
+
+  contadorTexto(s, "metricas_requisicoes_total", stats.requisicoes);
+  contadorTexto(s, "metricas_bytes_enviados_total", (unsigned long)stats.bytesEnviados);
+  medidorTexto(s, "metricas_resposta_duracao_max_us", stats.duracaoMaxUs);
+}
+
+// ==================== JSON ====================
+static void valorJson(EscritorTexto& s, float valor, int casas) {
+  if (isnan(valor)) s << "null";
+  else s << Decimal(valor, casas);
+}
+
+void metricasEscreverJson(EscritorTexto& s) {
+  const InstantaneoMetricas& f = foto;
+
+  s << "{\"foto_idade_ms\":" << (halMillis() - f.instanteMs) << ",\"leituras\":" << f.leituras;
+
+  s << ",\"zonas\":[";
+  for (int z = 0; z < f.totalZonas; z++) {
+    s << (z ? ",{" : "{") << "\"nome\":\"" << zonasConfig(z).nome << "\",\"temperatura\":";
+    valorJson(s, f.temperaturaZona[z], 1);
+    s << ",\"umidade\":";
+    valorJson(s, f.umidadeZona[z], 1);
+    s << ",\"luminosidade\":";
+    valorJson(s, f.luminosidadeZona[z], 0);
+    s << ",\"score\":" << (int)f.scoreZona[z] << ",\"alertas\":" << (int)f.alertasZona[z]
+      << ",\"pausa\":" << (int)f.statusPausaZona[z] << '}';
+  }
+
+  s << "],\"regras\":{";
+  for (int r = 0; r < TOTAL_REGRAS; r++) {
+    s << (r ? ",\"" : "\"") << regra(r).nome << "\":{\"violada\":" << ((f.violacoes >> r) & 1)
+      << ",\"ativacoes\":" << f.ativacoesRegra[r] << '}';
+  }
+
+  s << "},\"pausas\":{\"status\":" << (int)f.statusPausa << ",\"hoje\":" << f.pausasHoje
+    << ",\"dia\":" << f.diaAgenda << '}';
+
+  s << ",\"janelas\":{";
+  for (int m = 0; m < TOTAL_METRICAS; m++) {
+    s << (m ? ",\"" : "\"") << estatisticasNomeMetrica((MetricaAmbiente)m) << "\":{";
+    for (int j = 0; j < TOTAL_JANELAS; j++) {
+      const ResumoJanela& r = f.janelas[m][j];
+      s << (j ? ",\"" : "\"") << estatisticasNomeJanela((JanelaEstatistica)j)
+        << "\":{\"n\":" << (unsigned long)r.amostras;
+      if (r.amostras > 0) {
+        s << ",\"media\":" << Decimal(r.media, 2) << ",\"desvio\":" << Decimal(r.desvio, 2)
+          << ",\"min\":" << Decimal(r.minimo, 2) << ",\"max\":" << Decimal(r.maximo, 2);
+      }
+      s << '}';
+    }
+    s << ",\"tendencia\":";
+    valorJson(s, f.tendencia[m], 2);
+    s << '}';
+  }
+
+  s << "},\"amostragem\":{\"periodo_ms\":" << f.periodoAmostragemMs
+    << ",\"amostras_economizadas\":" << f.amostrasEconomizadas
+    << ",\"envios_economizados\":" << f.enviosEconomizados << '}';
+  s << ",\"dht\":{\"transacoes\":" << f.dht.transacoes << ",\"falhas_checksum\":" << f.dht.falhasChecksum
+    << ",\"sem_resposta\":" << f.dht.semResposta << ",\"consultas_vencidas\":" << f.dht.consultasVencidas << '}';
+  s << ",\"ldr\":{\"conversoes\":" << (unsigned long)f.luz.conversoes << ",\"picos\":" << f.luz.picos << '}';
+
+  s << ",\"tarefas\":{";
+  for (int i = 0; i < f.totalTarefas; i++) {
+    const ContadoresTarefa& t = f.tarefas[i];
+    s << (i ? ",\"" : "\"") << t.nome << "\":{\"execucoes\":" << t.execucoes << ",\"overruns\":" << t.overruns
+      << ",\"perdidos\":" << t.periodosPerdidos << ",\"duracao_max_us\":" << t.duracaoMaxUs << '}';
+  }
+  s << "},\"heap\":{\"livre\":" << (unsigned long)f.heapLivre
+    << ",\"minimo_livre\":" << (unsigned long)f.heapMinimoLivre << '}';
+
+  // Contadores do próprio núcleo 0: lidos na hora
+  const EstatisticasFila& fila = filaEstatisticas();
+  s << ",\"fila\":{\"tamanho\":" << filaTamanho() << ",\"enfileiradas\":" << fila.enfileiradas
+    << ",\"enviadas\":" << fila.enviadas << ",\"descartadas\":" << fila.descartadasOverflow << '}';
+  const EstatisticasWiFi& wifi = wifiEstatisticas();
+  s << ",\"wifi\":{\"conectado\":" << (wifiEstaConectado() ? "true" : "false") << ",\"rssi\":" << halWiFiRssi()
+    << ",\"quedas\":" << wifi.quedas << ",\"offline_ms\":" << wifiTempoOfflineMs() << '}';
+  if (estatisticasHttp != nullptr) {
+    s << ",\"http\":{\"requisicoes\":" << estatisticasHttp->requisicoes
+      << ",\"reaproveitadas\":" << estatisticasHttp->reaproveitadas
+      << ",\"falhas\":" << estatisticasHttp->falhas << '}';
+  }
+  s << ",\"log_descartadas\":" << logEstatisticas().descartadasBufferCheio;
+  s << ",\"metricas\":{\"requisicoes\":" << stats.requisicoes
+    << ",\"bytes_enviados\":" << (unsigned long)stats.bytesEnviados
+    << ",\"resposta_duracao_max_us\":" << stats.duracaoMaxUs << "}}";
+}
+
+// ==================== SERVIDOR (NÚCLEO 0) ====================
+static bool comecaComSemCaixa(const char* texto, const char* prefixo) {
+  for (; *prefixo; texto++, prefixo++) {
+    if (tolower((unsigned char)*texto) != tolower((unsigned char)*prefixo)) return false;
+  }
+  return true;
+}
+
+static bool contemSemCaixa(const char* texto, const char* trecho) {
+  for (; *texto; texto++) {
+    if (comecaComSemCaixa(texto, trecho)) return true;
+  }
+  return false;
+}
+
+static const char* motivoStatus(int status) {
+  switch (status) {
+    case 200: return "OK";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 431: return "Request Header Fields Too Large";
+    default: return "Internal Server Error";
+  }
+}
+
+// Cabeçalho e corpo em duas escritas; o Content-Length mantém a conexão
+static void responder(ConexaoMetricas& c, int status, const char* tipo, const EscritorTexto& conteudo,
+                      bool manter) {
+  BufferTexto<192> cabecalho;
+  cabecalho << "HTTP/1.1 " << status << ' ' << motivoStatus(status) << "\r\nContent-Type: " << tipo
+            << "\r\nContent-Length: " << (unsigned long)conteudo.tamanho()
+            << "\r\nConnection: " << (manter ? "keep-alive" : "close") << "\r\n\r\n";
+  size_t enviados = c.cliente.escrever((const uint8_t*)cabecalho.c_str(), cabecalho.tamanho());
+  enviados += c.cliente.escrever((const uint8_t*)conteudo.c_str(), conteudo.tamanho());
+  stats.bytesEnviados += enviados;
+}
+
+static void responderErro(ConexaoMetricas& c, int status, bool manter) {
+  BufferTexto<48> mensagem;
+  mensagem << motivoStatus(status) << '\n';
+  responder(c, status, "text/plain; charset=utf-8", mensagem, manter);
+}
+
+// Requisição completa em c.requisicao (terminada pela linha vazia).
+// Retorna false se a conexão deve ser fechada
+static bool atender(ConexaoMetricas& c, char* fimCabecalhos) {
+  PERFIL_INICIO(inicio);
+  unsigned long inicioUs = halMicros();
+  *fimCabecalhos = '\0';
+  stats.requisicoes++;
+
+  // "GET /metrics HTTP/1.1"; a query string é ignorada
+  char* metodo = c.requisicao;
+  char* caminho = strchr(metodo, ' ');
+  char* versao = caminho ? strchr(caminho + 1, ' ') : nullptr;
+  if (caminho == nullptr || versao == nullptr) {
+    responderErro(c, 404, false);
+    stats.naoEncontradas++;
+    return false;
+  }
+  *caminho++ = '\0';
+  *versao++ = '\0';
+  char* consulta = strchr(caminho, '?');
+  if (consulta) *consulta = '\0';
+
+  // HTTP/1.0 fecha por padrão; 1.1 só com "Connection: close" (a versão
+  // segue com os cabeçalhos até a linha vazia)
+  bool manter = comecaComSemCaixa(versao, "HTTP/1.1") && !contemSemCaixa(versao, "connection: close");
+
+  bool texto = !strcmp(caminho, "/metrics");
+  bool json = !strcmp(caminho, "/metrics.json");
+  if (strcmp(metodo, "GET") != 0) {
+    responderErro(c, 405, manter);
+    stats.naoEncontradas++;
+  } else if (!texto && !json) {
+    responderErro(c, 404, manter);
+    stats.naoEncontradas++;
+  } else {
+    copiarFoto();
+    corpo.limpar();
+    if (texto) metricasEscreverTexto(corpo);
+    else metricasEscreverJson(corpo);
+
+    if (corpo.foiTruncado()) {
+      LOG_AVISO("METRICAS", "⚠️ Resposta maior que METRICAS_TAMANHO_RESPOSTA (",
+                (unsigned long)METRICAS_TAMANHO_RESPOSTA, " bytes)");
+      responderErro(c, 500, manter);
+      stats.recusadas++;
+    } else {
+      responder(c, 200, texto ? "text/plain; version=0.0.4; charset=utf-8" : "application/json",
+                corpo, manter);
+      if (texto) stats.respostasTexto++;
+      else stats.respostasJson++;
+      stats.maiorResposta = max(stats.maiorResposta, corpo.tamanho());
+    }
+  }
+
+  stats.duracaoMaxUs = max(stats.duracaoMaxUs, halMicros() - inicioUs);
+  PERFIL_FIM(ESTAGIO_RASPAGEM, inicio);
+  return manter;
+}
+
+void servidorMetricasProcessar() {
+  if (servidor.porta() == 0) return;
+  unsigned long agora = halMillis();
+
+  for (ConexaoMetricas& c : conexoes) {
+    if (c.aberta || !servidor.aceitar(c.cliente)) continue;
+    c.aberta = true;
+    c.tamanho = 0;
+    c.ultimaAtividadeMs = agora;
+    stats.conexoes++;
+  }
+
+  for (ConexaoMetricas& c : conexoes) {
+    if (!c.aberta) continue;
+    size_t livre = sizeof(c.requisicao) - 1 - c.tamanho;
+    size_t lidos = c.cliente.lerDisponivel((uint8_t*)c.requisicao + c.tamanho, livre);
+    if (lidos == 0 && !c.cliente.conectado()) {
+      fecharConexao(c);
+      continue;
+    }
+    if (lidos > 0) {
+      c.tamanho += lidos;
+      c.requisicao[c.tamanho] = '\0';
+      c.ultimaAtividadeMs = agora;
+    }
+
+    // Requisições em sequência (pipelining) saem na ordem
+    char* fim;
+    bool manter = true;
+    while (manter && (fim = strstr(c.requisicao, "\r\n\r\n")) != nullptr) {
+      size_t consumidos = fim + 4 - c.requisicao;
+      manter = atender(c, fim);
+      c.tamanho -= consumidos;
+      memmove(c.requisicao, c.requisicao + consumidos, c.tamanho + 1);
+    }
+
+    if (!manter) {
+      fecharConexao(c);
+    } else if (c.tamanho == sizeof(c.requisicao) - 1) {
+      responderErro(c, 431, false);
+      stats.recusadas++;
+      fecharConexao(c);
+    } else if (agora - c.ultimaAtividadeMs >= METRICAS_TIMEOUT_OCIOSO_MS) {
+      stats.fechadasOciosas++;
+      fecharConexao(c);
+    }
+  }
+}
+
+const EstatisticasServidorMetricas& servidorMetricasEstatisticas() {
+  return stats;
+}
+
+void servidorMetricasImprimirEstatisticas() {
+  if (servidor.porta() == 0) return;
+  LOG_INFO("METRICAS", "📈 Métricas: conexoes=", stats.conexoes, " requisicoes=", stats.requisicoes,
+           " texto=", stats.respostasTexto, " json=", stats.respostasJson,
+           " 404=", stats.naoEncontradas, " recusadas=", stats.recusadas,
+           " maior=", (unsigned long)stats.maiorResposta, " bytes duracaoMax=", stats.duracaoMaxUs, " us");
+}
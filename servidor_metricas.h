@@ -0,0 +1,126 @@
+#pragma once
+
+#include "hal.h"
+
+#include "agenda_pausas.h"
+#include "agendador.h"
+#include "cliente_http.h"
+#include "estatisticas_janela.h"
+#include "formatador.h"
+#include "regras_ambiente.h"
+#include "sensor_dht.h"
+#include "sensor_luz.h"
+#include "zonas.h"
+
+// ==================== ENDPOINT LOCAL DE MÉTRICAS ====================
+// Servidor HTTP mínimo no dispositivo, para raspagem frequente na rede
+// local (Prometheus, scripts):
+//
+//   GET /metrics       - texto no formato de exposição do Prometheus
+//   GET /metrics.json  - o mesmo conteúdo em JSON compacto
+//
+// O núcleo 1 só tira uma foto do estado no fim de cada leitura
+// (metricasCapturar(): cópias de memória sob um lock curto). Aceitar,
+// ler a requisição, montar e escrever a resposta é trabalho da tarefa de
+// métricas no núcleo 0, sem bloquear: cada passo lê o que já chegou nas
+// conexões abertas e responde às requisições completas. Keep-alive,
+// como nas raspagens do Prometheus.
+//
+// Só atende com o rádio ligado, então serve para o modo ENERGIA_ACORDADO.
+
+#ifndef METRICAS_PORTA
+#define METRICAS_PORTA 8080                // 0 = qualquer livre (build nativo)
+#endif
+#ifndef METRICAS_TAMANHO_RESPOSTA
+#define METRICAS_TAMANHO_RESPOSTA 16384    // Corpo da maior resposta (estático; ~9 KB com 1 zona)
+#endif
+#define METRICAS_MAX_CONEXOES 2
+#define METRICAS_TAMANHO_REQUISICAO 1024   // Linha de requisição + cabeçalhos
+#define METRICAS_TIMEOUT_OCIOSO_MS 10000   // Conexão sem requisição é fechada
+#define METRICAS_PERIODO_TAREFA_MS 10
+
+struct ContadoresTarefa {
+  const char* nome;
+  unsigned long execucoes;
+  unsigned long overruns;
+  unsigned long periodosPerdidos;
+  unsigned long duracaoMaxUs;
+};
+
+// Foto do estado do núcleo 1; o núcleo 0 lê a cópia compartilhada
+struct InstantaneoMetricas {
+  unsigned long instanteMs;
+  unsigned long leituras;
+
+  // Zona 0 (a do kit)
+  float temperatura;
+  float umidade;
+  float luminosidade;
+  uint8_t score;
+  uint8_t alertas;
+  MascaraViolacoes violacoes;
+  unsigned long ativacoesRegra[TOTAL_REGRAS];   // Regra passou a violar
+
+  TipoEventoAgenda statusPausa;
+  int pausasHoje;
+  unsigned long diaAgenda;
+
+  ResumoJanela janelas[TOTAL_METRICAS][TOTAL_JANELAS];
+  float tendencia[TOTAL_METRICAS];
+
+  unsigned long periodoAmostragemMs;
+  unsigned long amostrasEconomizadas;
+  unsigned long enviosEconomizados;
+
+  EstatisticasDht dht;
+  EstatisticasLuz luz;
+
+  ContadoresTarefa tarefas[MAX_TAREFAS];
+  int totalTarefas;
+
+  uint32_t heapLivre;
+  uint32_t heapMinimoLivre;
+
+  int totalZonas;
+  float temperaturaZona[MAX_ZONAS];
+  float umidadeZona[MAX_ZONAS];
+  float luminosidadeZona[MAX_ZONAS];
+  uint8_t scoreZona[MAX_ZONAS];
+  uint8_t alertasZona[MAX_ZONAS];
+  TipoEventoAgenda statusPausaZona[MAX_ZONAS];
+};
+
+struct EstatisticasServidorMetricas {
+  unsigned long conexoes;
+  unsigned long requisicoes;
+  unsigned long respostasTexto;
+  unsigned long respostasJson;
+  unsigned long naoEncontradas;     // 404 e métodos que não são GET
+  unsigned long recusadas;          // Requisição maior que o buffer ou resposta truncada
+  unsigned long fechadasOciosas;
+  unsigned long long bytesEnviados;
+  size_t maiorResposta;             // Bytes do corpo
+  unsigned long duracaoMaxUs;       // Montar + escrever uma resposta
+};
+
+// Antes do setup() (ex.: opção do build nativo): troca a porta pedida pelo
+// sketch. 0 = a do sketch
+void metricasSelecionarPorta(uint16_t porta);
+
+// "http" = contadores do cliente do ThingSpeak (do núcleo 0), lidos na hora
+bool servidorMetricasIniciar(uint16_t porta, const EstatisticasHttp* http);
+uint16_t servidorMetricasPorta();
+void servidorMetricasParar();
+
+// Núcleo 1, no fim de cada leitura
+void metricasCapturar();
+
+// Núcleo 0: um passo não bloqueante (aceitar, ler, responder, expirar)
+void servidorMetricasProcessar();
+
+// Monta o corpo das respostas a partir da última foto (também usado na bancada)
+void metricasEscreverTexto(EscritorTexto& saida);
+void metricasEscreverJson(EscritorTexto& saida);
+
+const EstatisticasServidorMetricas& servidorMetricasEstatisticas();
+void servidorMetricasImprimirEstatisticas();
@@ -0,0 +1,201 @@
+#include "telemetria_mqtt.h"
+
+#include "fila_telemetria.h"
+#include "formatador.h"
+#include "log.h"
+#include "zonas.h"
+
+static ClienteMqtt cliente;
+static BufferTexto<32> dispositivo;
+static BufferTexto<48> idCliente;
+
+// Amostras de cada zona publicadas e ainda sem PUBACK: são sempre as mais
+// antigas da zona na fila (o broker confirma na ordem da publicação)
+static uint16_t amostrasEmVoo[MAX_ZONAS];
+static int alertasEmVoo = 0;
+static bool reconexaoAdiada = false;       // Espera armada depois de uma recusa
+static uint32_t proximaConexaoMs = 0;     // 32 bits, comparado em int32_t
+static EstatisticasTelemetriaMqtt stats = {};
+
+// contexto = zona << 16 | quantidade, ou CONTEXTO_ALERTA | sequência
+#define CONTEXTO_ALERTA 0x80000000UL
+
+static void aoConfirmar(uint32_t contexto) {
+  if (contexto & CONTEXTO_ALERTA) {
+    if (alertasEmVoo > 0) alertasEmVoo--;
+    alertasConfirmar((uint16_t)(contexto & 0xFFFF));
+    return;
+  }
+  uint8_t zona = (uint8_t)(contexto >> 16);
+  uint16_t quantidade = (uint16_t)(contexto & 0xFFFF);
+  filaConfirmarEnvioDaZona(zona, quantidade);
+  amostrasEmVoo[zona] -= min(amostrasEmVoo[zona], quantidade);
+  stats.amostrasConfirmadas += quantidade;
+}
+
+void mqttConfigurar(const char* host, uint16_t porta, const char* idDispositivo) {
+  dispositivo.limpar();
+  dispositivo << idDispositivo;
+  idCliente.limpar();
+  idCliente << "wellwork-" << idDispositivo;
+  cliente.configurar(host, porta, idCliente.c_str(), aoConfirmar);
+  memset(amostrasEmVoo, 0, sizeof(amostrasEmVoo));
+}
+
+static uint8_t* escrever16(uint8_t* p, uint16_t valor) {
+  p[0] = (uint8_t)(valor & 0xFF);
+  p[1] = (uint8_t)(valor >> 8);
+  return p + 2;
+}
+
+// Satura no tipo do campo do registro
+static long limitar(long valor, long minimo, long maximo) {
+  return valor < minimo ? minimo : (valor > maximo ? maximo : valor);
+}
+
+// Publica as próximas amostras fora de voo de uma zona. Retorna quantas
+static int publicarLote() {
+  uint8_t carga[3 + MQTT_AMOSTRAS_POR_MENSAGEM * MQTT_TAMANHO_REGISTRO];
+  uint16_t vistas[MAX_ZONAS] = {};
+  int pendentes = filaTamanho();
+  int zona = -1;
+  int quantidade = 0;
+  unsigned long agora = halMillis();
+
+  for (int i = 0; i < pendentes && quantidade < MQTT_AMOSTRAS_POR_MENSAGEM; i++) {
+    AmostraAgregada a;
+    filaEspiar(i, a);
+    if (a.zona >= zonasTotal()) {
+      // Sobra de uma configuração anterior (fila restaurada da flash)
+      LOG_AVISO("MQTT", "⚠️ Zona ", (int)a.zona, " inexistente - amostras descartadas");
+      filaConfirmarEnvioDaZona(a.zona, pendentes);
+      return 0;
+    }
+    if (vistas[a.zona]++ < amostrasEmVoo[a.zona]) continue;   // Já publicada
+    if (zona < 0) zona = a.zona;
+    if (a.zona != zona) continue;
+
+    uint8_t* p = carga + 3 + quantidade * MQTT_TAMANHO_REGISTRO;
+    p = escrever16(p, (uint16_t)min((agora - a.timestampMs) / 1000, 65535UL));
+    p = escrever16(p, (uint16_t)(int16_t)limitar(lroundf(a.temperatura * 10.0f), -32768, 32767));
+    p = escrever16(p, (uint16_t)limitar(lroundf(a.umidade * 10.0f), 0, 65535));
+    p = escrever16(p, (uint16_t)limitar(a.luminosidade, 0, 65535));
+    *p = (uint8_t)limitar(a.score, 0, 255);
+    quantidade++;
+  }
+  if (quantidade == 0) return 0;
+
+  carga[0] = MQTT_VERSAO_CARGA;
+  carga[1] = (uint8_t)zona;
+  carga[2] = (uint8_t)quantidade;
+
+  BufferTexto<64> topico;
+  topico << MQTT_TOPICO_BASE << "/" << dispositivo.c_str() << "/" << zona;
+  uint32_t contexto = (uint32_t)zona << 16 | (uint32_t)quantidade;
+  if (!cliente.publicar(topico.c_str(), carga, 3 + quantidade * MQTT_TAMANHO_REGISTRO, contexto)) {
+    return 0;
+  }
+
+  amostrasEmVoo[zona] += quantidade;
+  stats.amostrasPublicadas += quantidade;
+  stats.lotes++;
+  LOG_INFO("MQTT", "📨 Lote de ", quantidade, " amostras (", zonasConfig(zona).nome,
+           ") publicado - ", cliente.emVoo(), " em voo");
+  return quantidade;
+}
+
+// Conecta se preciso, respeitando a espera depois de uma recusa
+static bool garantirConexao() {
+  if (cliente.conectado()) return true;
+  if (reconexaoAdiada) {
+    if ((int32_t)((uint32_t)halMillis() - proximaConexaoMs) < 0) return false;
+    reconexaoAdiada = false;
+  }
+  if (!cliente.conectar()) {
+    proximaConexaoMs = (uint32_t)(halMillis() + MQTT_ESPERA_RECONEXAO_MS);
+    reconexaoAdiada = true;
+    LOG_ERRO("MQTT", "❌ Broker indisponível - ", filaTamanho(), " amostras aguardando na fila");
+    return false;
+  }
+  LOG_INFO("MQTT", "🔌 Conectado ao broker");
+  return true;
+}
+
+int mqttDrenarFila() {
+  if (filaTamanho() == 0) return 0;
+  if (!garantirConexao()) return 0;
+
+  // Nada em voo (ou a conexão caiu e esqueceu a janela): tudo na fila
+  // volta a ser publicável
+  if (cliente.emVoo() == 0) memset(amostrasEmVoo, 0, sizeof(amostrasEmVoo));
+
+  int publicadas = 0;
+  while (cliente.janelaLivre() > MQTT_JANELA_ALERTAS) {
+    int n = publicarLote();
+    if (n == 0) break;
+    publicadas += n;
+  }
+  return publicadas;
+}
+
+void mqttProcessar() {
+  cliente.processar(alertasEmVoo > 0);
+  if (cliente.emVoo() == 0) {
+    memset(amostrasEmVoo, 0, sizeof(amostrasEmVoo));
+    alertasEmVoo = 0;
+  }
+}
+
+void mqttFechar() {
+  cliente.fechar();
+  memset(amostrasEmVoo, 0, sizeof(amostrasEmVoo));
+  alertasEmVoo = 0;
+}
+
+bool mqttAceitaZona(int zona) {
+  (void)zona;
+  return true;
+}
+
+bool mqttAlertar(const EventoAlerta& evento) {
+  if (!garantirConexao()) return false;
+
+  uint8_t carga[MQTT_TAMANHO_ALERTA];
+  uint8_t* p = carga;
+  *p++ = MQTT_VERSAO_ALERTA;
+  *p++ = evento.zona;
+  *p++ = evento.causas;
+  *p++ = evento.causasAnteriores;
+  p = escrever16(p, evento.sequencia);
+  p = escrever16(p, (uint16_t)min((uint32_t)((uint32_t)halMicros() - evento.amostraUs) / 1000U, 65535U));
+  p = escrever16(p, (uint16_t)(int16_t)(isnan(evento.temperatura) ? -32768
+                                        : limitar(lroundf(evento.temperatura * 10.0f), -32767, 32767)));
+  *p = evento.score;
+
+  BufferTexto<64> topico;
+  topico << MQTT_TOPICO_BASE << "/" << dispositivo.c_str() << "/" << (int)evento.zona << "/alerta";
+  if (!cliente.publicar(topico.c_str(), carga, sizeof(carga), CONTEXTO_ALERTA | evento.sequencia)) {
+    return false;
+  }
+  alertasEmVoo++;
+  LOG_INFO("MQTT", "🚨 Alerta ", (unsigned int)evento.sequencia, " publicado - ", cliente.emVoo(), " em voo");
+  return true;
+}
+
+const EstatisticasMqtt& mqttEstatisticasConexao() {
+  return cliente.estatisticas();
+}
+
+const EstatisticasTelemetriaMqtt& mqttEstatisticas() {
+  return stats;
+}
+
+void mqttImprimirEstatisticas() {
+  const EstatisticasMqtt& conexao = cliente.estatisticas();
+  if (conexao.conexoes == 0 && conexao.falhas == 0) return;
+  LOG_INFO("MQTT", "📡 MQTT: conexoes=", conexao.conexoes, " publicacoes=", conexao.publicacoes,
+           " confirmadas=", conexao.confirmadas, " reenvios=", conexao.reenvios,
+           " pings=", conexao.pings, " falhas=", conexao.falhas,
+           " amostras=", stats.amostrasConfirmadas, "/", stats.amostrasPublicadas,
+           " bytes=", (unsigned long)conexao.bytesEnviados);
+}
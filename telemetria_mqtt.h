@@ -0,0 +1,55 @@
+#pragma once
+
+#include "hal.h"
+
+#include "alertas_criticos.h"
+#include "cliente_mqtt.h"
+
+// ==================== TELEMETRIA POR MQTT ====================
+// Destino da fila para frotas com broker próprio: uma conexão persistente,
+// várias amostras de uma zona por PUBLISH (QoS 1) numa carga binária
+// compacta e até MQTT_JANELA mensagens em voo. A amostra só sai da fila
+// com o PUBACK; se a conexão cair, o que estava em voo é publicado de novo.
+//
+// Tópico: MQTT_TOPICO_BASE/<dispositivo>/<índice da zona>
+// Carga (little-endian): versão (1 B), zona (1 B), N (1 B) e N registros de
+// MQTT_TAMANHO_REGISTRO bytes:
+//   idade (uint16, s antes da publicação), temperatura (int16, 0,1 °C),
+//   umidade (uint16, 0,1 %), luminosidade (uint16), score (uint8)
+//
+// Alertas críticos (alertas_criticos.h) vão para .../<zona>/alerta, uma
+// mensagem por evento, e têm MQTT_JANELA_ALERTAS lugares da janela só
+// para eles: os lotes nunca atrasam um alerta. Carga (little-endian):
+//   versão (1 B), zona (1 B), causas (1 B), causas anteriores (1 B),
+//   sequência (uint16), idade (uint16, ms desde a amostra),
+//   temperatura (int16, 0,1 °C; -32768 = sem leitura), score (uint8)
+
+#define MQTT_TOPICO_BASE "wellwork"
+#define MQTT_VERSAO_CARGA 1
+#define MQTT_TAMANHO_REGISTRO 9
+#define MQTT_AMOSTRAS_POR_MENSAGEM 24     // 3 + 24 x 9 = 219 bytes de carga
+#define MQTT_ESPERA_RECONEXAO_MS 5000     // Depois de uma conexão recusada
+#define MQTT_VERSAO_ALERTA 1
+#define MQTT_TAMANHO_ALERTA 11
+#define MQTT_JANELA_ALERTAS 1             // Lugares da janela que os lotes não usam
+static_assert(MQTT_JANELA_ALERTAS < MQTT_JANELA, "sobra janela para os lotes");
+
+struct EstatisticasTelemetriaMqtt {
+  unsigned long amostrasPublicadas;   // Inclui as publicadas de novo após uma queda
+  unsigned long amostrasConfirmadas;
+  unsigned long lotes;
+};
+
+// No setup(); o id do dispositivo também vira o client id ("wellwork-<id>")
+void mqttConfigurar(const char* host, uint16_t porta, const char* idDispositivo);
+
+// Funções da tabela de destinos (destino_telemetria.h)
+int mqttDrenarFila();
+void mqttProcessar();
+void mqttFechar();
+bool mqttAceitaZona(int zona);   // Todas: o tópico é por índice
+bool mqttAlertar(const EventoAlerta& evento);
+
+const EstatisticasMqtt& mqttEstatisticasConexao();
+const EstatisticasTelemetriaMqtt& mqttEstatisticas();
+void mqttImprimirEstatisticas();   // Só se o destino foi usado
@@ -0,0 +1,415 @@
+#include "trilha_sensores.h"
+
+#include "fila_spsc.h"
+#include "log.h"
+
+#define TRILHA_MAX_SENSORES 16     // Índice em 4 bits
+#define TRILHA_MAX_REGISTRO 16     // Tipo + instante + a maior carga
+
+enum TipoRegistro : uint8_t {
+  REGISTRO_DHT = 1,                // Umidade e temperatura (checksum bateu)
+  REGISTRO_DHT_CHECKSUM = 2,       // Os 5 bytes crus do quadro
+  REGISTRO_DHT_SEM_RESPOSTA = 3,
+  REGISTRO_LUZ = 4,
+  REGISTRO_FIM = 15                // Fim da gravação: só o instante
+};
+
+static const uint8_t magica[4] = { 'W', 'W', 'T', 'R' };
+
+// Na RTC: a gravação continua depois do sono profundo
+static HAL_RETIDO ModoTrilha modo = TRILHA_DESLIGADA;
+static HAL_RETIDO uint8_t buffer[TRILHA_TAMANHO_BUFFER];
+static HAL_RETIDO size_t ocupados = 0;          // Gravação: bytes no buffer; reprodução: próximo a ler
+static HAL_RETIDO size_t disponiveis = 0;       // Reprodução: bytes lidos para o buffer
+static HAL_RETIDO unsigned long registrosNoBuffer = 0;
+static HAL_RETIDO bool destinoCheio = false;
+static HAL_RETIDO unsigned long instanteMs = 0; // Último registro (na reprodução, desde o início)
+static HAL_RETIDO unsigned long inicioMs = 0;
+static HAL_RETIDO uint8_t proximoCabecalho = 0;  // Reprodução: tipo << 4 | índice do seguinte (0 = nenhum)
+static HAL_RETIDO uint32_t proximoDeltaMs = 0;
+static HAL_RETIDO unsigned long fimMs = 0;
+static HAL_RETIDO bool temFim = false;
+static HAL_RETIDO uint16_t ultimaUmidade[TRILHA_MAX_SENSORES];
+static HAL_RETIDO uint16_t ultimaTemperatura[TRILHA_MAX_SENSORES];
+static HAL_RETIDO int ultimaLuz[TRILHA_MAX_SENSORES];
+static HAL_RETIDO EstatisticasTrilha stats;
+static EscritaTrilha escrita = nullptr;
+static LeituraTrilha leitura = nullptr;
+static SaidaTrilha saida = nullptr;
+static const char* caminhoArquivo = nullptr;   // Gravando na flash pela tarefa de rede
+
+// Núcleo 1 -> tarefa de rede. Em RAM: o loop() não entra no sono profundo
+// com blocos pendentes
+struct BlocoTrilha {
+  uint16_t tamanho;
+  uint8_t dados[TRILHA_TAMANHO_BUFFER];
+};
+static FilaSPSC<BlocoTrilha, TRILHA_BLOCOS_EM_VOO> blocos;
+static std::atomic<bool> falhaFlash(false);     // A tarefa de rede não conseguiu gravar
+
+static void zerar() {
+  ocupados = 0;
+  disponiveis = 0;
+  registrosNoBuffer = 0;
+  destinoCheio = false;
+  proximoCabecalho = 0;
+  temFim = false;
+  memset(ultimaUmidade, 0, sizeof(ultimaUmidade));
+  memset(ultimaTemperatura, 0, sizeof(ultimaTemperatura));
+  memset(ultimaLuz, 0, sizeof(ultimaLuz));
+  stats = {};
+}
+
+// ==================== GRAVAÇÃO ====================
+static void escreverByte(uint8_t b) {
+  buffer[ocupados++] = b;
+}
+
+static void escreverVarint(uint32_t valor) {
+  while (valor >= 0x80) {
+    escreverByte((uint8_t)(valor | 0x80));
+    valor >>= 7;
+  }
+  escreverByte((uint8_t)valor);
+}
+
+// Zigue-zague: deltas pequenos, positivos ou negativos, em poucos bytes
+static void escreverDelta(int32_t delta) {
+  escreverVarint((uint32_t)delta << 1 ^ (uint32_t)(delta >> 31));
+}
+
+static void descarregar();
+
+// Retorna false se o destino encheu: daqui em diante os registros são perdidos
+static bool iniciarRegistro(TipoRegistro tipo, int indice) {
+  if (destinoCheio) {
+    stats.perdidos++;
+    return false;
+  }
+  if (ocupados + TRILHA_MAX_REGISTRO > sizeof(buffer)) descarregar();
+  if (destinoCheio) {
+    stats.perdidos++;
+    return false;
+  }
+  unsigned long agora = halMillis();
+  escreverByte((uint8_t)(tipo << 4 | indice));
+  escreverVarint((uint32_t)(agora - instanteMs));
+  instanteMs = agora;
+  registrosNoBuffer++;
+  stats.registros++;
+  return true;
+}
+
+static void gravarDht(int sensor, EstadoQuadroDht estado, const uint8_t quadro[5]) {
+  if (estado == DHT_QUADRO_SEM_RESPOSTA) {
+    iniciarRegistro(REGISTRO_DHT_SEM_RESPOSTA, sensor);
+    return;
+  }
+  if ((uint8_t)(quadro[0] + quadro[1] + quadro[2] + quadro[3]) != quadro[4]) {
+    if (!iniciarRegistro(REGISTRO_DHT_CHECKSUM, sensor)) return;
+    for (int i = 0; i < 5; i++) escreverByte(quadro[i]);
+    return;
+  }
+  if (!iniciarRegistro(REGISTRO_DHT, sensor)) return;
+  uint16_t umidade = (uint16_t)(quadro[0] << 8 | quadro[1]);
+  uint16_t temperatura = (uint16_t)(quadro[2] << 8 | quadro[3]);
+  escreverDelta((int16_t)(umidade - ultimaUmidade[sensor]));
+  escreverDelta((int16_t)(temperatura - ultimaTemperatura[sensor]));
+  ultimaUmidade[sensor] = umidade;
+  ultimaTemperatura[sensor] = temperatura;
+}
+
+static void iniciarGravacao() {
+  leitura = nullptr;
+  if (halDespertouDoSonoProfundo() && modo == TRILHA_GRAVANDO) return;
+
+  modo = TRILHA_GRAVANDO;
+  zerar();
+  instanteMs = halMillis();
+  for (uint8_t b : magica) escreverByte(b);
+  escreverByte(TRILHA_VERSAO);
+  LOG_INFO("TRILHA", "🎞️ Gravando a trilha dos sensores");
+}
+
+void trilhaGravar(EscritaTrilha escrever) {
+  escrita = escrever;
+  caminhoArquivo = nullptr;
+  iniciarGravacao();
+}
+
+bool trilhaGravarArquivo(const char* caminho) {
+  bool continuando = halDespertouDoSonoProfundo() && modo == TRILHA_GRAVANDO;
+  if (!continuando) halArquivoRemover(caminho);
+  int arquivo = halArquivoAnexar(caminho);
+  if (arquivo < 0) {
+    LOG_ERRO("TRILHA", "❌ Não foi possível criar ", caminho);
+    return false;
+  }
+  halArquivoFechar(arquivo);
+  escrita = nullptr;
+  caminhoArquivo = caminho;
+  iniciarGravacao();
+  return true;
+}
+
+// Núcleo 1: copia o buffer para a fila da tarefa de rede. O limite do
+// arquivo conta o que já foi entregue
+static size_t entregarParaFlash(const uint8_t* dados, size_t tamanho) {
+  static BlocoTrilha bloco;   // Fora da pilha do loop()
+  if (falhaFlash.load(std::memory_order_acquire)) return 0;
+  if (stats.bytes + tamanho > TRILHA_TAMANHO_MAXIMO_ARQUIVO) return 0;
+  bloco.tamanho = (uint16_t)tamanho;
+  memcpy(bloco.dados, dados, tamanho);
+  return blocos.inserir(bloco) ? tamanho : 0;
+}
+
+static void descarregar() {
+  if (modo != TRILHA_GRAVANDO || ocupados == 0 || destinoCheio) return;
+  size_t escritos = 0;
+  if (caminhoArquivo != nullptr) escritos = entregarParaFlash(buffer, ocupados);
+  else if (escrita != nullptr) escritos = escrita(buffer, ocupados);
+  if (escritos < ocupados) {
+    // Só buffers inteiros: a trilha termina num registro completo
+    destinoCheio = true;
+    stats.perdidos += registrosNoBuffer;
+    LOG_AVISO("TRILHA", "⚠️ Destino da trilha cheio - gravação interrompida em ",
+              (unsigned long)stats.bytes, " bytes");
+  } else {
+    stats.bytes += escritos;
+  }
+  ocupados = 0;
+  registrosNoBuffer = 0;
+}
+
+void trilhaEncerrar() {
+  if (modo != TRILHA_GRAVANDO) return;
+  if (ocupados + TRILHA_MAX_REGISTRO > sizeof(buffer)) descarregar();
+  if (!destinoCheio) {
+    unsigned long agora = halMillis();
+    escreverByte(REGISTRO_FIM << 4);
+    escreverVarint((uint32_t)(agora - instanteMs));
+    instanteMs = agora;
+  }
+  descarregar();
+}
+
+// Tarefa de rede. Depois de uma falha os blocos seguintes são descartados:
+// o núcleo 1 vê a falha no próximo buffer e para a gravação
+void trilhaEscoar() {
+  static BlocoTrilha bloco;
+  while (blocos.retirar(bloco)) {
+    if (falhaFlash.load(std::memory_order_relaxed)) continue;
+    int arquivo = halArquivoAnexar(caminhoArquivo);
+    size_t escritos = arquivo >= 0 ? halArquivoEscrever(arquivo, bloco.dados, bloco.tamanho) : 0;
+    if (arquivo >= 0) halArquivoFechar(arquivo);
+    if (escritos < bloco.tamanho) {
+      falhaFlash.store(true, std::memory_order_release);
+      LOG_ERRO("TRILHA", "❌ Falha gravando a trilha em ", caminhoArquivo);
+    }
+  }
+}
+
+size_t trilhaBlocosPendentes() {
+  return blocos.profundidade();
+}
+
+// ==================== REPRODUÇÃO ====================
+static bool lerByte(uint8_t& b) {
+  if (ocupados == disponiveis) {
+    disponiveis = leitura != nullptr ? leitura(buffer, sizeof(buffer)) : 0;
+    ocupados = 0;
+    if (disponiveis == 0) return false;
+    stats.bytes += disponiveis;
+  }
+  b = buffer[ocupados++];
+  return true;
+}
+
+static bool lerVarint(uint32_t& valor) {
+  valor = 0;
+  for (int deslocamento = 0; deslocamento < 35; deslocamento += 7) {
+    uint8_t b;
+    if (!lerByte(b)) return false;
+    valor |= (uint32_t)(b & 0x7F) << deslocamento;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+static bool lerDelta(int32_t& delta) {
+  uint32_t valor;
+  if (!lerVarint(valor)) return false;
+  delta = (int32_t)(valor >> 1) ^ -(int32_t)(valor & 1);
+  return true;
+}
+
+static void terminar() {
+  if (stats.terminou) return;
+  stats.terminou = true;
+  LOG_INFO("TRILHA", "🏁 Fim da trilha: ", stats.registros, " registros em ", instanteMs, " ms");
+}
+
+// O cabeçalho do registro seguinte é lido assim que o atual termina: o
+// de fim encerra a reprodução no instante em que a gravação parou, sem
+// esperar mais uma leitura do sketch
+static void anteciparCabecalho() {
+  uint32_t delta;
+  if (!lerByte(proximoCabecalho) || !lerVarint(delta)) {
+    proximoCabecalho = 0;
+    return;
+  }
+  proximoDeltaMs = delta;
+  if (proximoCabecalho >> 4 == REGISTRO_FIM) {
+    fimMs = instanteMs + delta;
+    temFim = true;
+  }
+}
+
+// Confere se o registro seguinte é o que o sketch pediu
+static bool lerRegistro(bool dht, int indice, TipoRegistro& tipo) {
+  if (stats.terminou) return false;
+  if (proximoCabecalho == 0 || proximoCabecalho >> 4 == REGISTRO_FIM) {
+    terminar();
+    return false;
+  }
+  tipo = (TipoRegistro)(proximoCabecalho >> 4);
+  int gravado = proximoCabecalho & 0x0F;
+  bool esperado = dht ? tipo >= REGISTRO_DHT && tipo <= REGISTRO_DHT_SEM_RESPOSTA : tipo == REGISTRO_LUZ;
+  if (!esperado || gravado != indice) {
+    stats.divergiu = true;
+    LOG_ERRO("TRILHA", "❌ Trilha divergiu no registro ", stats.registros, ": gravado ",
+             (int)tipo, "/", gravado, ", pedido ", dht ? "dht/" : "luz/", indice);
+    terminar();
+    return false;
+  }
+
+  instanteMs += proximoDeltaMs;
+  unsigned long decorrido = halMillis() - inicioMs;
+  unsigned long desvio = decorrido > instanteMs ? decorrido - instanteMs : instanteMs - decorrido;
+  if (desvio > TRILHA_TOLERANCIA_MS) stats.desalinhados++;
+  if (desvio > stats.desvioMaxMs) stats.desvioMaxMs = desvio;
+  stats.registros++;
+  return true;
+}
+
+static EstadoQuadroDht reproduzirDht(int sensor, uint8_t quadro[5]) {
+  TipoRegistro tipo;
+  if (!lerRegistro(true, sensor, tipo)) return DHT_QUADRO_SEM_RESPOSTA;
+
+  EstadoQuadroDht estado = DHT_QUADRO_SEM_RESPOSTA;
+  bool completo = true;
+  if (tipo == REGISTRO_DHT) {
+    int32_t deltaUmidade, deltaTemperatura;
+    completo = lerDelta(deltaUmidade) && lerDelta(deltaTemperatura);
+    if (completo) {
+      ultimaUmidade[sensor] = (uint16_t)(ultimaUmidade[sensor] + deltaUmidade);
+      ultimaTemperatura[sensor] = (uint16_t)(ultimaTemperatura[sensor] + deltaTemperatura);
+      quadro[0] = (uint8_t)(ultimaUmidade[sensor] >> 8);
+      quadro[1] = (uint8_t)(ultimaUmidade[sensor] & 0xFF);
+      quadro[2] = (uint8_t)(ultimaTemperatura[sensor] >> 8);
+      quadro[3] = (uint8_t)(ultimaTemperatura[sensor] & 0xFF);
+      quadro[4] = (uint8_t)(quadro[0] + quadro[1] + quadro[2] + quadro[3]);
+      estado = DHT_QUADRO_PRONTO;
+    }
+  } else if (tipo == REGISTRO_DHT_CHECKSUM) {
+    for (int i = 0; i < 5 && completo; i++) completo = lerByte(quadro[i]);
+    if (completo) estado = DHT_QUADRO_PRONTO;
+  }
+
+  if (!completo) {
+    terminar();   // Registro cortado no fim do arquivo
+    return DHT_QUADRO_SEM_RESPOSTA;
+  }
+  anteciparCabecalho();
+  return estado;
+}
+
+bool trilhaReproduzir(LeituraTrilha ler) {
+  leitura = ler;
+  escrita = nullptr;
+  modo = TRILHA_REPRODUZINDO;
+  zerar();
+  inicioMs = halMillis();
+  instanteMs = 0;
+
+  uint8_t cabecalho[sizeof(magica) + 1];
+  size_t lidos = 0;
+  while (lidos < sizeof(cabecalho) && lerByte(cabecalho[lidos])) lidos++;
+  if (lidos < sizeof(cabecalho) || memcmp(cabecalho, magica, sizeof(magica)) != 0 ||
+      cabecalho[sizeof(magica)] != TRILHA_VERSAO) {
+    LOG_ERRO("TRILHA", "❌ Trilha inválida (cabeçalho ou versão)");
+    modo = TRILHA_DESLIGADA;
+    return false;
+  }
+  anteciparCabecalho();
+  LOG_INFO("TRILHA", "🎞️ Reproduzindo a trilha dos sensores");
+  return true;
+}
+
+// ==================== PONTOS DE ENTRADA ====================
+ModoTrilha trilhaModo() {
+  return modo;
+}
+
+bool trilhaTerminou() {
+  if (modo != TRILHA_REPRODUZINDO) return false;
+  if (temFim && halMillis() - inicioMs >= fimMs) terminar();
+  return stats.terminou;
+}
+
+EstadoQuadroDht trilhaDht(int sensor, EstadoQuadroDht estado, uint8_t quadro[5]) {
+  if (modo == TRILHA_DESLIGADA || estado == DHT_QUADRO_PENDENTE) return estado;
+  if (sensor < 0 || sensor >= TRILHA_MAX_SENSORES) return estado;
+  if (modo == TRILHA_GRAVANDO) {
+    gravarDht(sensor, estado, quadro);
+    return estado;
+  }
+  return reproduzirDht(sensor, quadro);
+}
+
+int trilhaLuz(int canal, int valor) {
+  if (modo == TRILHA_DESLIGADA || canal < 0 || canal >= TRILHA_MAX_SENSORES) return valor;
+  if (modo == TRILHA_GRAVANDO) {
+    if (iniciarRegistro(REGISTRO_LUZ, canal)) escreverDelta(valor - ultimaLuz[canal]);
+    ultimaLuz[canal] = valor;
+    return valor;
+  }
+
+  // Reproduzindo: depois do fim, o último valor fica
+  TipoRegistro tipo;
+  int32_t delta;
+  if (!lerRegistro(false, canal, tipo)) return ultimaLuz[canal];
+  if (!lerDelta(delta)) {
+    terminar();
+    return ultimaLuz[canal];
+  }
+  ultimaLuz[canal] += delta;
+  anteciparCabecalho();
+  return ultimaLuz[canal];
+}
+
+// ==================== LOG DE SAÍDAS ====================
+void trilhaRegistrarSaidas(SaidaTrilha novaSaida) {
+  saida = novaSaida;
+}
+
+bool trilhaRegistrandoSaidas() {
+  return saida != nullptr;
+}
+
+void trilhaPublicarSaida(EscritorTexto& linha) {
+  stats.saidas++;
+  saida(linha.c_str(), linha.tamanho());
+}
+
+const EstatisticasTrilha& trilhaEstatisticas() {
+  return stats;
+}
+
+void trilhaImprimirEstatisticas() {
+  if (modo == TRILHA_DESLIGADA) return;
+  LOG_INFO("TRILHA", "🎞️ Trilha (", modo == TRILHA_GRAVANDO ? "gravando" : "reproduzindo",
+           "): registros=", stats.registros, " bytes=", (unsigned long)stats.bytes,
+           " perdidos=", stats.perdidos, " desalinhados=", stats.desalinhados,
+           " desvioMax=", stats.desvioMaxMs, "ms saidas=", stats.saidas);
+}
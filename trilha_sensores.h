@@ -0,0 +1,105 @@
+#pragma once
+
+#include "hal.h"
+
+#include "formatador.h"
+
+// ==================== TRILHA DOS SENSORES ====================
+// Gravação e reprodução determinística das entradas do sketch. Gravando,
+// cada quadro do DHT e cada valor do LDR que os módulos dos sensores
+// entregam vira um registro com o instante (halMillis()); reproduzindo,
+// os mesmos pontos devolvem os valores da trilha, na ordem, e o resto do
+// sketch (regras, zonas, pausas, alertas, médias) roda sem saber. A
+// reprodução no build nativo vai tão rápido quanto a CPU deixa.
+//
+// Formato (little-endian, tamanho variável):
+//   cabeçalho: "WWTR", versão
+//   registro:  tipo << 4 | índice do sensor, delta do instante (varint),
+//              carga do tipo
+//   fim:       o instante em que a gravação parou (trilhaEncerrar())
+// Os valores vão como delta em zigue-zague do último do mesmo sensor:
+// um registro típico tem 3 a 5 bytes.
+//
+// O LDR entra já filtrado (um valor por canal e por leitura, como o
+// antigo analogRead()): as conversões cruas do ADC contínuo (20 kS/s) não
+// caberiam na flash.
+//
+// Na flash (trilhaGravarArquivo()) o núcleo 1 não grava: cada buffer
+// cheio vai por uma FilaSPSC para a tarefa de rede, dona dos arquivos
+// (a fila e o histórico gravam lá), que o escreve em trilhaEscoar(). O
+// tick não espera o LittleFS. Fila de blocos cheia ou falha na escrita
+// encerram a gravação, como o arquivo cheio: um bloco pulado quebraria
+// os deltas do resto da trilha.
+//
+// O log de saídas ("<ms> <evento>", uma linha por evento) é o lado das
+// saídas: o que o sketch decidiu, para comparar duas execuções com diff.
+
+#define TRILHA_VERSAO 1
+#define TRILHA_TAMANHO_BUFFER 256        // Bytes acumulados antes de cada escrita
+#define TRILHA_BLOCOS_EM_VOO 4           // Buffers cheios esperando a tarefa de rede (potência de 2)
+#define TRILHA_TOLERANCIA_MS 50          // Reprodução: desvio do instante que conta como desalinhado
+#define TRILHA_TAMANHO_LINHA 128         // Linha do log de saídas
+#ifndef TRILHA_TAMANHO_MAXIMO_ARQUIVO
+#define TRILHA_TAMANHO_MAXIMO_ARQUIVO (256UL * 1024)   // Depois disso a gravação na flash para
+#endif
+
+enum ModoTrilha : uint8_t {
+  TRILHA_DESLIGADA,
+  TRILHA_GRAVANDO,
+  TRILHA_REPRODUZINDO
+};
+
+// Destino e origem dos bytes: retornam quantos foram escritos/lidos
+// (a leitura retorna 0 no fim)
+typedef size_t (*EscritaTrilha)(const uint8_t* dados, size_t tamanho);
+typedef size_t (*LeituraTrilha)(uint8_t* destino, size_t tamanho);
+typedef void (*SaidaTrilha)(const char* linha, size_t tamanho);
+
+struct EstatisticasTrilha {
+  unsigned long registros;        // Gravados ou reproduzidos
+  unsigned long long bytes;
+  unsigned long perdidos;         // Gravação: o destino não aceitou (cheio)
+  unsigned long desalinhados;     // Reprodução: instante além da tolerância
+  unsigned long desvioMaxMs;
+  unsigned long saidas;           // Linhas do log de saídas
+  bool terminou;                  // Reprodução: fim da trilha
+  bool divergiu;                  // Reprodução: o sketch pediu outro sensor que o gravado
+};
+
+// Antes do setup(). Gravar escreve o cabeçalho no boot frio; no despertar
+// do sono profundo continua a trilha (buffer e deltas ficam na RTC)
+void trilhaGravar(EscritaTrilha escrever);
+bool trilhaGravarArquivo(const char* caminho);   // Acréscimos na flash, até o tamanho máximo
+bool trilhaReproduzir(LeituraTrilha ler);        // false = cabeçalho inválido
+void trilhaRegistrarSaidas(SaidaTrilha saida);
+
+ModoTrilha trilhaModo();
+bool trilhaTerminou();          // Fim da trilha ou divergência
+void trilhaEncerrar();          // Gravando: registra o fim e grava (ou entrega) o buffer
+
+// Tarefa de rede: grava na flash os buffers que o núcleo 1 entregou.
+// Pendentes se perdem no sono profundo: o loop() só dorme com zero
+void trilhaEscoar();
+size_t trilhaBlocosPendentes();
+
+// Pontos de entrada, nos módulos dos sensores. Gravando: registra e
+// devolve o valor lido; reproduzindo: devolve o da trilha; desligada:
+// devolve o lido. Quadro pendente não é registro
+EstadoQuadroDht trilhaDht(int sensor, EstadoQuadroDht estado, uint8_t quadro[5]);
+int trilhaLuz(int canal, int valor);
+
+// Log de saídas: "<ms> " + partes, se houver saída registrada
+bool trilhaRegistrandoSaidas();
+void trilhaPublicarSaida(EscritorTexto& linha);
+
+template <typename... Partes>
+void trilhaSaida(const Partes&... partes) {
+  if (!trilhaRegistrandoSaidas()) return;
+  BufferTexto<TRILHA_TAMANHO_LINHA> linha;
+  linha << halMillis() << " ";
+  (void)std::initializer_list<int>{ ((void)(linha << partes), 0)... };
+  trilhaPublicarSaida(linha);
+}
+
+const EstatisticasTrilha& trilhaEstatisticas();
+void trilhaImprimirEstatisticas();
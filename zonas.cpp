@@ -0,0 +1,189 @@
+#include "zonas.h"
+
+#include "log.h"
+#include "sensor_dht.h"
+#include "sensor_luz.h"
+
+constexpr MascaraViolacoes BITS_DHT =
+    mascaraDaGrandeza(GRANDEZA_TEMPERATURA) | mascaraDaGrandeza(GRANDEZA_UMIDADE);
+
+// Na RTC: histerese, status das pausas e janelas continuam depois do sono
+// profundo. A tabela de configuração é do sketch e volta a cada boot
+static HAL_RETIDO ArmazemZonas armazem;
+static const ConfigZona* configuracao = nullptr;
+static int quantidadePedida = 0;
+
+static void zerarZona(int z) {
+  armazem.temperatura[z] = NAN;
+  armazem.umidade[z] = NAN;
+  armazem.luminosidade[z] = NAN;
+  armazem.amostraNova[z] = false;
+  armazem.violacoes[z] = 0;
+  armazem.score[z] = SCORE_MAXIMO;
+  armazem.alertas[z] = 0;
+  armazem.statusPausa[z] = SEM_PAUSA;
+  armazem.somaTemperatura[z] = 0;
+  armazem.somaUmidade[z] = 0;
+  armazem.somaLuminosidade[z] = 0;
+  armazem.somaScore[z] = 0;
+  armazem.amostrasJanela[z] = 0;
+}
+
+void zonasSelecionarQuantidade(int ativas) {
+  quantidadePedida = ativas;
+}
+
+void zonasIniciar(const ConfigZona* config, int tamanhoTabela, int ativas) {
+  if (quantidadePedida > 0) ativas = quantidadePedida;
+  int total = max(1, min(min(ativas, tamanhoTabela), MAX_ZONAS));
+  configuracao = config;
+
+  if (!halDespertouDoSonoProfundo() || armazem.total != total) {
+    for (int z = 0; z < MAX_ZONAS; z++) zerarZona(z);
+  }
+  armazem.total = total;
+
+  // Sensores locais numerados na ordem das zonas; o que passa dos limites
+  // dos drivers fica sem sensor
+  int dht = 0;
+  int ldr = 0;
+  for (int z = 0; z < total; z++) {
+    armazem.sensorDht[z] = config[z].pinoDht >= 0 && dht < DHT_MAX_SENSORES ? (int8_t)dht++ : -1;
+    armazem.canalLuz[z] = config[z].pinoLdr >= 0 && ldr < LUZ_MAX_CANAIS ? (int8_t)ldr++ : -1;
+    armazem.defasagemPausaMin[z] = config[z].defasagemPausaMin % MINUTOS_POR_DIA;
+  }
+}
+
+int zonasTotal() {
+  return armazem.total;
+}
+
+const ConfigZona& zonasConfig(int zona) {
+  return configuracao[zona];
+}
+
+int zonasPinosDht(int* pinos, int capacidade) {
+  int total = 0;
+  for (int z = 0; z < armazem.total && total < capacidade; z++) {
+    if (armazem.sensorDht[z] >= 0) pinos[total++] = configuracao[z].pinoDht;
+  }
+  return total;
+}
+
+int zonasPinosLdr(int* pinos, int capacidade) {
+  int total = 0;
+  for (int z = 0; z < armazem.total && total < capacidade; z++) {
+    if (armazem.canalLuz[z] >= 0) pinos[total++] = configuracao[z].pinoLdr;
+  }
+  return total;
+}
+
+void zonasLerSensores(unsigned long idadeMaximaDhtMs) {
+  for (int z = 0; z < armazem.total; z++) {
+    if (armazem.sensorDht[z] >= 0) {
+      dhtLer(armazem.sensorDht[z], armazem.temperatura[z], armazem.umidade[z], idadeMaximaDhtMs);
+      armazem.amostraNova[z] = true;
+    }
+    if (armazem.canalLuz[z] >= 0) {
+      armazem.luminosidade[z] = (float)luzValor(armazem.canalLuz[z]);
+      armazem.amostraNova[z] = true;
+    }
+  }
+}
+
+void zonasRegistrarAmostra(int zona, float temperatura, float umidade, float luminosidade) {
+  if (zona < 0 || zona >= armazem.total) return;
+  armazem.temperatura[zona] = temperatura;
+  armazem.umidade[zona] = umidade;
+  armazem.luminosidade[zona] = luminosidade;
+  armazem.amostraNova[zona] = true;
+}
+
+void zonasAvaliar(int hora, uint16_t minutoDoDia) {
+  ArmazemZonas& a = armazem;
+  const int n = a.total;
+  MascaraViolacoes violacoes[MAX_ZONAS];
+  TipoEventoAgenda status[MAX_ZONAS];
+
+  // Regras: uma passada por regra sobre os vetores de todas as zonas
+  regrasAvaliarLote(a.temperatura, a.umidade, a.luminosidade, hora, a.violacoes, violacoes, n);
+
+  // DHT sem leitura: os bits dele ficam como estavam
+  for (int z = 0; z < n; z++) {
+    bool semDht = isnan(a.temperatura[z]) || isnan(a.umidade[z]);
+    violacoes[z] |= a.violacoes[z] & (semDht ? BITS_DHT : 0);
+  }
+
+  for (int z = 0; z < n; z++) {
+    uint16_t minuto = (uint16_t)((minutoDoDia + MINUTOS_POR_DIA - a.defasagemPausaMin[z]) % MINUTOS_POR_DIA);
+    status[z] = agendaStatusNoMinuto(minuto);
+  }
+
+  // A zona 0 tem LEDs, buzzer e log próprios no sketch
+  for (int z = 1; z < n; z++) {
+    const char* nome = configuracao[z].nome;
+    if (status[z] != a.statusPausa[z]) {
+      if (agendaEhPausa(status[z])) LOG_INFO("ZONA", "☕ ", nome, ": pausa ", (int)status[z], " começou");
+      else LOG_INFO("ZONA", "💼 ", nome, ": pausa encerrada");
+    }
+    if (violacoes[z] != a.violacoes[z]) {
+      LOG_INFO("ZONA", violacoes[z] ? "⚠️ " : "✅ ", nome, ": alertas=",
+               regrasContarAlertas(violacoes[z]), " score=", regrasScore(violacoes[z]));
+    }
+  }
+
+  for (int z = 0; z < n; z++) {
+    a.violacoes[z] = violacoes[z];
+    a.statusPausa[z] = status[z];
+    a.score[z] = (uint8_t)regrasScore(violacoes[z]);
+    a.alertas[z] = (uint8_t)regrasContarAlertas(violacoes[z]);
+  }
+
+  // Janela de envio: só amostras novas com o DHT válido, como na zona 0
+  for (int z = 0; z < n; z++) {
+    if (a.amostraNova[z] && !isnan(a.temperatura[z]) && !isnan(a.umidade[z])) {
+      a.somaTemperatura[z] += a.temperatura[z];
+      a.somaUmidade[z] += a.umidade[z];
+      a.somaLuminosidade[z] += a.luminosidade[z];
+      a.somaScore[z] += a.score[z];
+      a.amostrasJanela[z]++;
+    }
+    a.amostraNova[z] = false;
+  }
+}
+
+bool zonasFecharJanela(int zona, AmostraAgregada& media) {
+  if (zona < 0 || zona >= armazem.total) return false;
+  uint16_t n = armazem.amostrasJanela[zona];
+  if (n > 0) {
+    media.timestampMs = halMillis();
+    media.temperatura = armazem.somaTemperatura[zona] / n;
+    media.umidade = armazem.somaUmidade[zona] / n;
+    media.luminosidade = (int)(armazem.somaLuminosidade[zona] / n + 0.5f);
+    media.score = (int)((armazem.somaScore[zona] + n / 2) / n);
+    media.zona = (uint8_t)zona;
+  }
+
+  armazem.somaTemperatura[zona] = 0;
+  armazem.somaUmidade[zona] = 0;
+  armazem.somaLuminosidade[zona] = 0;
+  armazem.somaScore[zona] = 0;
+  armazem.amostrasJanela[zona] = 0;
+  return n > 0;
+}
+
+const ArmazemZonas& zonasArmazem() {
+  return armazem;
+}
+
+void zonasImprimir() {
+  const ArmazemZonas& a = armazem;
+  for (int z = 0; z < a.total; z++) {
+    const ConfigZona& c = configuracao[z];
+    LOG_INFO("ZONA", "🏢 Zona ", z, " ", c.nome, ": score=", (int)a.score[z],
+             " alertas=", (int)a.alertas[z], " pausa=", (int)a.statusPausa[z],
+             " T=", Decimal(a.temperatura[z], 1), " U=", Decimal(a.umidade[z], 1),
+             " L=", Decimal(a.luminosidade[z], 0),
+             " canal=", c.canalThingSpeak != nullptr ? c.canalThingSpeak : "-");
+  }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "hal.h"
+
+#include "agenda_pausas.h"
+#include "fila_telemetria.h"
+#include "regras_ambiente.h"
+
+// ==================== ZONAS ====================
+// Várias zonas de sensores (salas, mesas), cada uma com seu score, alertas
+// e status de pausa (a agenda do kit, defasada por zona). As amostras
+// ficam num armazém em estrutura de vetores - um vetor contíguo por campo,
+// indexado pela zona - e a avaliação é uma sequência de laços curtos sobre
+// todas as zonas: regras, score, alertas, pausas e acúmulo da janela.
+//
+// A zona 0 é a do kit: LEDs, buzzer, estatísticas em janelas e amostragem
+// adaptativa continuam sendo dela. As outras só têm sensores (DHT22 e LDR
+// próprios, ou amostras registradas de fora) e um canal próprio no
+// ThingSpeak, com os mesmos campos 1-4 da zona 0.
+
+#ifndef MAX_ZONAS
+#define MAX_ZONAS 8     // O armazém fica na RTC; o build nativo usa 64
+#endif
+static_assert(MAX_ZONAS <= 255, "a zona da amostra tem 8 bits");
+
+struct ConfigZona {
+  const char* nome;
+  int pinoDht;                   // -1 = sem DHT22 local
+  int pinoLdr;                   // -1 = sem LDR local (só pinos do ADC1)
+  const char* canalThingSpeak;   // nullptr = zona não é enviada
+  const char* chaveEscrita;
+  uint16_t defasagemPausaMin;    // Pausas da zona = as do kit, atrasadas disso
+};
+
+// Um vetor por campo: os laços da avaliação andam em memória contígua
+struct ArmazemZonas {
+  int total;
+
+  // Última amostra (NAN = sem leitura)
+  float temperatura[MAX_ZONAS];
+  float umidade[MAX_ZONAS];
+  float luminosidade[MAX_ZONAS];
+  bool amostraNova[MAX_ZONAS];       // Registrada desde a última avaliação
+
+  // Resultado da avaliação
+  MascaraViolacoes violacoes[MAX_ZONAS];
+  uint8_t score[MAX_ZONAS];
+  uint8_t alertas[MAX_ZONAS];
+  TipoEventoAgenda statusPausa[MAX_ZONAS];
+  uint16_t defasagemPausaMin[MAX_ZONAS];
+
+  // Janela de envio: somas das amostras novas com o DHT válido
+  float somaTemperatura[MAX_ZONAS];
+  float somaUmidade[MAX_ZONAS];
+  float somaLuminosidade[MAX_ZONAS];
+  uint32_t somaScore[MAX_ZONAS];
+  uint16_t amostrasJanela[MAX_ZONAS];
+
+  // Sensores locais: índice no sensor_dht / canal no sensor_luz (-1 = nenhum)
+  int8_t sensorDht[MAX_ZONAS];
+  int8_t canalLuz[MAX_ZONAS];
+};
+
+// Antes do setup() (ex.: opção do build nativo): troca o número de zonas
+// ativas pedido pelo sketch. 0 = o do sketch
+void zonasSelecionarQuantidade(int ativas);
+
+// A cada boot, antes dos sensores: as "ativas" primeiras linhas da tabela
+// viram zonas. O armazém só zera no boot frio
+void zonasIniciar(const ConfigZona* tabela, int tamanhoTabela, int ativas);
+int zonasTotal();
+const ConfigZona& zonasConfig(int zona);
+
+// Pinos dos sensores locais, na ordem dos índices do armazém. Retornam quantos
+int zonasPinosDht(int* pinos, int capacidade);
+int zonasPinosLdr(int* pinos, int capacidade);
+
+// Copia os caches do DHT e os filtros do LDR das zonas com sensor local
+void zonasLerSensores(unsigned long idadeMaximaDhtMs);
+
+// Amostra de uma zona sem sensor local (ex.: outro nó)
+void zonasRegistrarAmostra(int zona, float temperatura, float umidade, float luminosidade);
+
+// Uma vez por leitura, para todas as zonas. Com o DHT em falha os alertas
+// de temperatura/umidade da zona ficam como estavam
+void zonasAvaliar(int hora, uint16_t minutoDoDia);
+
+// Médias da janela de envio da zona e zera a janela. false = sem amostras
+bool zonasFecharJanela(int zona, AmostraAgregada& media);
+
+const ArmazemZonas& zonasArmazem();
+void zonasImprimir();